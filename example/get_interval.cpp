@@ -9,6 +9,7 @@
 
 #define BOOST_RESULT_OF_USE_DECLTYPE
 #include <boost/expected/expected_monad.hpp>
+#include <boost/expected/coroutine.hpp>
 #include <iostream>
 #include <streambuf>
 #include <locale>
@@ -138,6 +139,19 @@ boost::expected<std::pair<Num,Num>, std::ios_base::iostate> get_interval3(ios_ra
 
 #endif
 
+#if defined BOOST_EXPECTED_HAS_COROUTINES
+
+template <class Num, class CharT=char, class InputIterator = std::istreambuf_iterator<CharT> >
+boost::expected<std::pair<Num,Num>, std::ios_base::iostate> get_interval_co(ios_range<CharT, InputIterator>& r)
+{
+  auto f = co_await get_num<Num>(r);
+           co_await matchedString("..", r);
+  auto l = co_await get_num<Num>(r);
+  co_return std::make_pair(f, l);
+}
+
+#endif
+
 template <class T>
 struct identity_t {
   T value;
@@ -309,6 +323,28 @@ int main()
     std::cout << x.value().first << ".." << x.value().second << std::endl;
   }
 
+#if defined BOOST_EXPECTED_HAS_COROUTINES
+  {
+    std::stringstream is("1..3");
+    ios_range<> r(is);
+    auto x = get_interval_co<long>(r);
+    if (!x.valid()) {
+      std::cout << x.error() << std::endl;
+      return 6;
+    }
+
+    std::cout << x.value().first << ".." << x.value().second << std::endl;
+  }
+  {
+    std::stringstream is("1.3");
+    ios_range<> r(is);
+    auto x = get_interval_co<long>(r);
+    if (x.valid()) {
+      return 6;
+    }
+  }
+#endif
+
   return 0;
 }
 
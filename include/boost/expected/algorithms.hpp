@@ -7,8 +7,12 @@
 #define BOOST_EXPECTED_ALGORITHMS_HPP
 
 #include <boost/expected/algorithms/catch_unexpected.hpp>
+#include <boost/expected/algorithms/fold.hpp>
 #include <boost/expected/algorithms/has_unexpected.hpp>
 #include <boost/expected/algorithms/if_then_else.hpp>
+#include <boost/expected/algorithms/masked_arithmetic.hpp>
+#include <boost/expected/algorithms/partition_results.hpp>
+#include <boost/expected/algorithms/retry.hpp>
 #include <boost/expected/algorithms/unwrap.hpp>
 #include <boost/expected/algorithms/value.hpp>
 #include <boost/expected/algorithms/value_or.hpp>
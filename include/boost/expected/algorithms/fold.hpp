@@ -0,0 +1,175 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_ALGORITHMS_FOLD_HPP
+#define BOOST_EXPECTED_ALGORITHMS_FOLD_HPP
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/detail/latch.hpp>
+#include <boost/config.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace boost
+{
+namespace expected_alg
+{
+namespace fold_detail
+{
+  template <class Range, class Acc, class Op>
+  struct result
+  {
+    typedef decltype(std::declval<Op&>()(std::declval<Acc>(),
+        *std::begin(std::declval<Range&>()))) type;
+  };
+
+  template <class It, class Result, class Op>
+  Result fold(It first, It last, Result acc, Op& op)
+  {
+    // The loop only exits early on error, so the branch is always predicted
+    // as not taken while the results are valid.
+    for (; first != last; ++first)
+    {
+      acc = op(std::move(*acc), *first);
+      if (BOOST_UNLIKELY(! acc.valid()))
+        break;
+    }
+    return acc;
+  }
+} // namespace fold_detail
+
+  // Left fold of range with op, where op(acc, x) returns expected<Acc, E>.
+  // This is init.bind(op(_, x0)).bind(op(_, x1))... without building the
+  // intermediate results: the fold stops on the first error and returns it.
+  template <class Range, class Acc, class Op>
+  typename fold_detail::result<Range, Acc, Op>::type
+  fold(Range&& range, Acc init, Op op)
+  {
+    typedef typename fold_detail::result<Range, Acc, Op>::type result_type;
+    using std::begin;
+    using std::end;
+    return fold_detail::fold(begin(range), end(range), result_type(std::move(init)), op);
+  }
+
+  // Parallel fold of a random access range on executor, which must provide
+  // execute(f) to run f() asynchronously.
+  // The range is split in chunks; each chunk is folded starting from its
+  // first element and the partial results are combined in order with op,
+  // so op must be associative and accept both (Acc, element) and (Acc, Acc).
+  // When a chunk fails, the chunks after it are cancelled as their result
+  // can not be used; the result is the first error in range order.
+  // Exceptions thrown by op are rethrown in the calling thread.
+  // A concurrency of 0 uses std::thread::hardware_concurrency() chunks.
+  template <class Range, class Acc, class Op, class Executor>
+  typename fold_detail::result<Range, Acc, Op>::type
+  par_reduce(Range&& range, Acc init, Op op, Executor& executor, std::size_t concurrency = 0)
+  {
+    typedef typename fold_detail::result<Range, Acc, Op>::type result_type;
+    using std::begin;
+    using std::end;
+    typedef decltype(begin(range)) iterator;
+    // below this size per chunk, scheduling is more expensive than folding
+    BOOST_CONSTEXPR_OR_CONST std::size_t min_chunk = 1024;
+    BOOST_CONSTEXPR_OR_CONST std::size_t none = (std::numeric_limits<std::size_t>::max)();
+
+    iterator first = begin(range);
+    std::size_t const n = static_cast<std::size_t>(end(range) - first);
+    if (concurrency == 0)
+      concurrency = (std::max)(std::thread::hardware_concurrency(), 1u);
+    std::size_t const chunks = (std::max)(std::size_t(1),
+        (std::min)(concurrency, n / min_chunk));
+    if (chunks == 1)
+      return fold_detail::fold(first, end(range), result_type(std::move(init)), op);
+
+    std::size_t const chunk = (n + chunks - 1) / chunks;
+    std::vector<std::unique_ptr<result_type>> partials(chunks);
+    std::vector<std::exception_ptr> failures(chunks);
+    std::atomic<std::size_t> first_failed(none);
+
+    auto fail = [&](std::size_t c)
+    {
+      std::size_t f = first_failed.load(std::memory_order_relaxed);
+      while (c < f && ! first_failed.compare_exchange_weak(f, c, std::memory_order_relaxed))
+      {
+      }
+    };
+
+    auto work = [&](std::size_t c)
+    {
+      try
+      {
+        iterator it = first + c * chunk;
+        iterator const e = first + (std::min)(n, (c + 1) * chunk);
+        result_type acc = Acc(*it);
+        for (++it; it != e; ++it)
+        {
+          if (BOOST_UNLIKELY(first_failed.load(std::memory_order_relaxed) < c))
+            return;
+          acc = op(std::move(*acc), *it);
+          if (BOOST_UNLIKELY(! acc.valid()))
+          {
+            fail(c);
+            break;
+          }
+        }
+        partials[c].reset(new result_type(std::move(acc)));
+      }
+      catch (...)
+      {
+        failures[c] = std::current_exception();
+        fail(c);
+      }
+    };
+
+    expected_detail::latch done(chunks - 1);
+    for (std::size_t c = 1; c < chunks; ++c)
+    {
+      auto task = [&work, &done, c]
+      {
+        work(c);
+        done.count_down();
+      };
+      try
+      {
+        executor.execute(task);
+      }
+      catch (...)
+      {
+        // the executor could not take it, do it here
+        task();
+      }
+    }
+    work(0);
+    done.wait();
+
+    // A chunk has no partial result only if it was cancelled because an
+    // earlier one failed, so the loop returns before reaching it.
+    result_type acc(std::move(init));
+    for (std::size_t c = 0; c < chunks; ++c)
+    {
+      if (failures[c])
+        std::rethrow_exception(failures[c]);
+      if (! partials[c]->valid())
+        return std::move(*partials[c]);
+      acc = op(std::move(*acc), std::move(**partials[c]));
+      if (! acc.valid())
+        break;
+    }
+    return acc;
+  }
+
+} // namespace expected_alg
+} // namespace boost
+
+#endif // BOOST_EXPECTED_ALGORITHMS_FOLD_HPP
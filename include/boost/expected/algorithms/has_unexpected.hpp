@@ -7,6 +7,7 @@
 #define BOOST_EXPECTED_ALGORITHMS_HAS_UNEXPECTED_HPP
 
 #include <boost/expected/expected.hpp>
+#include <boost/exception_ptr.hpp>
 
 namespace boost
 {
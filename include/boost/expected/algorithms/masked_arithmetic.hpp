@@ -0,0 +1,187 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_ALGORITHMS_MASKED_ARITHMETIC_HPP
+#define BOOST_EXPECTED_ALGORITHMS_MASKED_ARITHMETIC_HPP
+
+#include <boost/expected/expected_buffer.hpp>
+#include <boost/assert.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace boost
+{
+namespace expected_alg
+{
+namespace masked_detail
+{
+  // The kernels below are written so that the compiler can vectorize them:
+  // every lane computes the operation and the error it would get, and the
+  // validity mask only selects between them. There is no branch on the
+  // validity, so rare errors cost nothing.
+  template <class T, class E, class Op>
+  void apply(expected_buffer<T, E> const& a, expected_buffer<T, E> const& b,
+      expected_buffer<T, E>& out, Op op, E const& failure)
+  {
+    BOOST_ASSERT(a.size() == b.size());
+    std::size_t const n = a.size();
+    out.resize(n);
+
+    unsigned char const* va = a.mask_data();
+    unsigned char const* vb = b.mask_data();
+    T const* xa = a.value_data();
+    T const* xb = b.value_data();
+    E const* ea = a.error_data();
+    E const* eb = b.error_data();
+    unsigned char* vo = out.mask_data();
+    T* xo = out.value_data();
+    E* eo = out.error_data();
+
+    // Values and errors are done in separate loops, as a single loop over
+    // all the arrays has too many streams for the vectorizer.
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      unsigned char ok = 1;
+      T const r = op(xa[i], xb[i], ok);
+      vo[i] = va[i] & vb[i] & ok;
+      xo[i] = r;
+    }
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      // load everything first so the selects are not branches
+      unsigned char const a_valid = va[i];
+      unsigned char const b_valid = vb[i];
+      E const a_error = ea[i];
+      E const b_error = eb[i];
+      eo[i] = a_valid ? (b_valid ? failure : b_error) : a_error;
+    }
+  }
+
+  struct plus
+  {
+    template <class T>
+    T operator()(T x, T y, unsigned char&) const { return x + y; }
+  };
+
+  struct multiplies
+  {
+    template <class T>
+    T operator()(T x, T y, unsigned char&) const { return x * y; }
+  };
+
+  struct divides
+  {
+    template <class T>
+    typename std::enable_if<std::is_floating_point<T>::value, T>::type
+    operator()(T x, T y, unsigned char& ok) const
+    {
+      ok = y != T(0);
+      return x / y;
+    }
+
+    template <class T>
+    typename std::enable_if<std::is_integral<T>::value, T>::type
+    operator()(T x, T y, unsigned char& ok) const
+    {
+      // min / -1 overflows, and both would trap, so divide by 1 instead.
+      ok = (y != T(0)) & ! (std::is_signed<T>::value &&
+          x == (std::numeric_limits<T>::min)() && y == T(-1));
+      return x / (ok ? y : T(1));
+    }
+  };
+
+  template <std::size_t Size, bool Signed>
+  struct wider_int {};
+  template <> struct wider_int<1, true> { typedef std::int16_t type; };
+  template <> struct wider_int<1, false> { typedef std::uint16_t type; };
+  template <> struct wider_int<2, true> { typedef std::int32_t type; };
+  template <> struct wider_int<2, false> { typedef std::uint32_t type; };
+  template <> struct wider_int<4, true> { typedef std::int64_t type; };
+  template <> struct wider_int<4, false> { typedef std::uint64_t type; };
+
+  template <class T>
+  struct wider : wider_int<sizeof(T), std::is_signed<T>::value> {};
+
+  // Same check as safe_multiplies: the product computed on a twice as wide
+  // integer must be the same as the truncated one.
+  struct checked_multiplies
+  {
+    template <class T>
+    T operator()(T x, T y, unsigned char& ok) const
+    {
+      return multiply(x, y, ok, std::integral_constant<bool, (sizeof(T) < 8)>());
+    }
+
+    template <class T>
+    static T multiply(T x, T y, unsigned char& ok, std::true_type)
+    {
+      typedef typename wider<T>::type W;
+      W const r = W(x) * W(y);
+      ok = r == W(T(r));
+      return T(r);
+    }
+
+    template <class T>
+    static T multiply(T x, T y, unsigned char& ok, std::false_type)
+    {
+#if defined __GNUC__ || defined __clang__
+      T r;
+      ok = ! __builtin_mul_overflow(x, y, &r);
+      return r;
+#else
+      typedef typename std::make_unsigned<T>::type U;
+      T const r = T(U(x) * U(y));
+      ok = x == 0 || (r / x == y && ! (std::is_signed<T>::value && x == T(-1) &&
+          y == (std::numeric_limits<T>::min)()));
+      return r;
+#endif
+    }
+  };
+
+} // namespace masked_detail
+
+  // Lane-wise a + b. A lane is invalid if any operand is, its error is the
+  // one of the first invalid operand.
+  template <class T, class E>
+  void masked_plus(expected_buffer<T, E> const& a, expected_buffer<T, E> const& b,
+      expected_buffer<T, E>& out)
+  {
+    masked_detail::apply(a, b, out, masked_detail::plus(), E());
+  }
+
+  // Lane-wise a * b, errors propagate as for masked_plus.
+  template <class T, class E>
+  void masked_multiplies(expected_buffer<T, E> const& a, expected_buffer<T, E> const& b,
+      expected_buffer<T, E>& out)
+  {
+    masked_detail::apply(a, b, out, masked_detail::multiplies(), E());
+  }
+
+  // Lane-wise a / b. Lanes with valid operands and a zero divisor (or an
+  // integer division overflow) get division_by_zero as error.
+  template <class T, class E>
+  void masked_divides(expected_buffer<T, E> const& a, expected_buffer<T, E> const& b,
+      expected_buffer<T, E>& out, E const& division_by_zero)
+  {
+    masked_detail::apply(a, b, out, masked_detail::divides(), division_by_zero);
+  }
+
+  // Lane-wise a * b on integers. Lanes with valid operands whose product
+  // overflows T get overflow as error.
+  template <class T, class E>
+  void masked_checked_multiplies(expected_buffer<T, E> const& a, expected_buffer<T, E> const& b,
+      expected_buffer<T, E>& out, E const& overflow)
+  {
+    static_assert(std::is_integral<T>::value, "masked_checked_multiplies requires an integer type");
+    masked_detail::apply(a, b, out, masked_detail::checked_multiplies(), overflow);
+  }
+
+} // namespace expected_alg
+} // namespace boost
+
+#endif // BOOST_EXPECTED_ALGORITHMS_MASKED_ARITHMETIC_HPP
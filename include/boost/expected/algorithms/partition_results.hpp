@@ -0,0 +1,231 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_ALGORITHMS_PARTITION_RESULTS_HPP
+#define BOOST_EXPECTED_ALGORITHMS_PARTITION_RESULTS_HPP
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/detail/is_trivially_copyable.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace boost
+{
+namespace expected_alg
+{
+namespace partition_results_detail
+{
+  template <class X>
+  struct is_kernel_result : std::false_type {};
+
+  // The compaction kernel buffers one block of values and errors on the stack,
+  // so it is restricted to small trivially copyable payloads.
+  template <class T, class E>
+  struct is_kernel_result<expected<T, E>> : std::integral_constant<bool,
+      expected_detail::is_trivially_copyable<T>::value &&
+      expected_detail::is_trivially_copyable<E>::value &&
+      sizeof(T) <= 64 && sizeof(E) <= 64
+  > {};
+
+  template <class It>
+  struct use_kernel : std::integral_constant<bool,
+      std::is_base_of<std::random_access_iterator_tag,
+          typename std::iterator_traits<It>::iterator_category>::value &&
+      is_kernel_result<typename std::iterator_traits<It>::value_type>::value
+  > {};
+
+  // Branchy, but works for any input iterator and any payload.
+  template <class It, class VOut, class EOut>
+  std::pair<VOut, EOut> partition(It first, It last, VOut vout, EOut eout, std::false_type)
+  {
+    for (; first != last; ++first)
+    {
+      if (first->valid())
+      {
+        *vout = std::move(**first);
+        ++vout;
+      }
+      else
+      {
+        *eout = std::move(first->error());
+        ++eout;
+      }
+    }
+    return std::make_pair(vout, eout);
+  }
+
+  // Branch free compaction. Both payloads of a result are copied to the
+  // current slot of their partition, but only the cursor of the partition
+  // matching the validity is advanced, so the next copy overwrites the slot
+  // of the other one. Copying the inactive member of the union is harmless
+  // as the payloads are trivially copyable.
+  template <class It, class T, class E>
+  void compact(It first, std::size_t n, T* values, std::size_t& nv, E* errors, std::size_t& ne)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      std::size_t const valid = first[i].valid();
+      std::memcpy(values + nv, std::addressof(*first[i]), sizeof(T));
+      std::memcpy(errors + ne, std::addressof(first[i].error()), sizeof(E));
+      nv += valid;
+      ne += valid ^ 1;
+    }
+  }
+
+  // Any output iterator: compact a block in buffers and copy them out.
+  template <class It, class VOut, class EOut>
+  std::pair<VOut, EOut> partition_kernel(It first, It last, VOut vout, EOut eout)
+  {
+    typedef typename std::iterator_traits<It>::value_type result_type;
+    typedef typename result_type::value_type value_type;
+    typedef typename result_type::error_type error_type;
+    BOOST_CONSTEXPR_OR_CONST std::size_t block = 64;
+
+    typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type vbuf[block];
+    typename std::aligned_storage<sizeof(error_type), alignof(error_type)>::type ebuf[block];
+    value_type* values = reinterpret_cast<value_type*>(vbuf);
+    error_type* errors = reinterpret_cast<error_type*>(ebuf);
+
+    std::size_t n = static_cast<std::size_t>(last - first);
+    while (n != 0)
+    {
+      std::size_t const len = (std::min)(n, block);
+      std::size_t nv = 0, ne = 0;
+      compact(first, len, values, nv, errors, ne);
+      vout = std::copy(values, values + nv, vout);
+      eout = std::copy(errors, errors + ne, eout);
+      first += len;
+      n -= len;
+    }
+    return std::make_pair(vout, eout);
+  }
+
+  // Pointer outputs: compact in place. A slot one past the current end of a
+  // partition is only written if another result of this partition follows,
+  // so the prefix before the last value and the last error can be compacted
+  // without writing past the end of the outputs. The tail is done branchy.
+  template <class It, class T, class E>
+  std::pair<T*, E*> partition_kernel(It first, It last, T* vout, E* eout)
+  {
+    It last_value = last;
+    while (last_value != first && ! (last_value - 1)->valid()) --last_value;
+    It last_error = last;
+    while (last_error != first && (last_error - 1)->valid()) --last_error;
+    It safe = (std::min)(last_value, last_error);
+    if (safe != first) --safe;
+
+    std::size_t nv = 0, ne = 0;
+    compact(first, static_cast<std::size_t>(safe - first), vout, nv, eout, ne);
+    return partition(safe, last, vout + nv, eout + ne, std::false_type());
+  }
+
+  template <class It, class VOut, class EOut>
+  std::pair<VOut, EOut> partition(It first, It last, VOut vout, EOut eout, std::true_type)
+  {
+    return partition_kernel(first, last, vout, eout);
+  }
+
+  template <class It, class VOut, class EOut>
+  std::pair<VOut, EOut> partition(It first, It last, VOut vout, EOut eout)
+  {
+    return partition(first, last, vout, eout, use_kernel<It>());
+  }
+
+} // namespace partition_results_detail
+
+  // Moves the values of the valid results of range to values_out and the
+  // errors of the invalid ones to errors_out. Both partitions keep the
+  // relative order of range. The results of range are left moved-from.
+  // Returns the end of both output ranges.
+  template <class Range, class ValueOut, class ErrorOut>
+  std::pair<ValueOut, ErrorOut>
+  partition_results(Range&& range, ValueOut values_out, ErrorOut errors_out)
+  {
+    using std::begin;
+    using std::end;
+    return partition_results_detail::partition(begin(range), end(range), values_out, errors_out);
+  }
+
+  // Parallel version of partition_results for random access ranges.
+  // The range is split in one chunk per thread, each thread partitions its
+  // chunk in its own buffers and the buffers are then moved in chunk order
+  // to the outputs, so the result is the same as the sequential one.
+  // A concurrency of 0 uses std::thread::hardware_concurrency().
+  template <class Range, class ValueOut, class ErrorOut>
+  std::pair<ValueOut, ErrorOut>
+  par_partition_results(Range&& range, ValueOut values_out, ErrorOut errors_out,
+      std::size_t concurrency = 0)
+  {
+    using std::begin;
+    using std::end;
+    typedef decltype(begin(range)) iterator;
+    typedef typename std::iterator_traits<iterator>::value_type result_type;
+    typedef typename result_type::value_type value_type;
+    typedef typename result_type::error_type error_type;
+    // below this size per thread, spawning is more expensive than partitioning
+    BOOST_CONSTEXPR_OR_CONST std::size_t min_chunk = 4096;
+
+    iterator first = begin(range);
+    std::size_t const n = static_cast<std::size_t>(end(range) - first);
+    if (concurrency == 0)
+      concurrency = (std::max)(std::thread::hardware_concurrency(), 1u);
+    std::size_t const chunks = (std::max)(std::size_t(1),
+        (std::min)(concurrency, n / min_chunk));
+    if (chunks == 1)
+      return partition_results_detail::partition(first, end(range), values_out, errors_out);
+
+    std::size_t const chunk = (n + chunks - 1) / chunks;
+    std::vector<std::vector<value_type>> values(chunks);
+    std::vector<std::vector<error_type>> errors(chunks);
+    std::vector<std::exception_ptr> failures(chunks);
+
+    auto work = [&](std::size_t c)
+    {
+      try
+      {
+        std::size_t const b = c * chunk;
+        std::size_t const e = (std::min)(n, b + chunk);
+        values[c].reserve(e - b);
+        partition_results_detail::partition(first + b, first + e,
+            std::back_inserter(values[c]), std::back_inserter(errors[c]));
+      }
+      catch (...)
+      {
+        failures[c] = std::current_exception();
+      }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(chunks - 1);
+    for (std::size_t c = 1; c < chunks; ++c)
+      threads.emplace_back(work, c);
+    work(0);
+    for (std::thread& t : threads)
+      t.join();
+
+    for (std::exception_ptr const& f : failures)
+      if (f) std::rethrow_exception(f);
+
+    for (std::size_t c = 0; c < chunks; ++c)
+    {
+      values_out = std::move(values[c].begin(), values[c].end(), values_out);
+      errors_out = std::move(errors[c].begin(), errors[c].end(), errors_out);
+    }
+    return std::make_pair(values_out, errors_out);
+  }
+
+} // namespace expected_alg
+} // namespace boost
+
+#endif // BOOST_EXPECTED_ALGORITHMS_PARTITION_RESULTS_HPP
@@ -0,0 +1,219 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_ALGORITHMS_RETRY_HPP
+#define BOOST_EXPECTED_ALGORITHMS_RETRY_HPP
+
+#include <boost/expected/expected.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace boost
+{
+namespace expected_alg
+{
+  // Why retry returned.
+  enum class retry_outcome
+  {
+    succeeded,
+    not_retryable,
+    attempts_exhausted,
+    deadline_exceeded
+  };
+
+  struct retry_stats
+  {
+    retry_stats() : attempts(0), slept(0), outcome(retry_outcome::succeeded) {}
+
+    std::size_t attempts;
+    std::chrono::nanoseconds slept;
+    retry_outcome outcome;
+  };
+
+  // The default sleeper.
+  struct sleep_for
+  {
+    template <class Rep, class Period>
+    void operator()(std::chrono::duration<Rep, Period> const& d) const
+    {
+      std::this_thread::sleep_for(d);
+    }
+  };
+
+  // When and how long retry waits before calling again: retryable(e) tells
+  // the errors worth another attempt, the n-th wait is
+  // min(initial * multiplier^(n-1), max) less a random part of up to
+  // jitter times that, and no attempt is started that would end its wait
+  // after the deadline, counted from the first call. The sleeper and the
+  // clock can be replaced so that tests do not sleep.
+  template <class Retryable, class Sleeper = sleep_for, class Clock = std::chrono::steady_clock>
+  class retry_policy
+  {
+  public:
+    typedef Clock clock;
+    typedef typename Clock::duration duration;
+
+    explicit retry_policy(Retryable r, Sleeper s = Sleeper())
+      : retryable_(std::move(r)), sleeper_(std::move(s)),
+        max_attempts_(3),
+        initial_(std::chrono::duration_cast<duration>(std::chrono::milliseconds(10))),
+        max_backoff_(std::chrono::duration_cast<duration>(std::chrono::seconds(1))),
+        multiplier_(2), jitter_(0.5), deadline_(duration::max())
+    {}
+
+    retry_policy& max_attempts(std::size_t n) { max_attempts_ = n; return *this; }
+    retry_policy& backoff(duration initial, duration max, double multiplier = 2)
+    {
+      initial_ = initial;
+      max_backoff_ = max;
+      multiplier_ = multiplier;
+      return *this;
+    }
+    // In [0, 1]: 0 waits the full backoff, 1 anything from 0 to it.
+    retry_policy& jitter(double fraction) { jitter_ = fraction; return *this; }
+    retry_policy& deadline(duration d) { deadline_ = d; return *this; }
+
+    std::size_t max_attempts() const { return max_attempts_; }
+    duration deadline() const { return deadline_; }
+
+    template <class E>
+    bool is_retryable(E const& e) const { return retryable_(e); }
+
+    // The wait after attempt n, n >= 1, with u in [0, 1).
+    duration wait_after(std::size_t n, double u) const
+    {
+      double d = double(initial_.count());
+      for (std::size_t i = 1; i < n && d < double(max_backoff_.count()); ++i)
+        d *= multiplier_;
+      if (d > double(max_backoff_.count()))
+        d = double(max_backoff_.count());
+      return duration(typename duration::rep(d * (1 - jitter_ * u)));
+    }
+
+    void sleep(duration d) { sleeper_(d); }
+
+  private:
+    Retryable retryable_;
+    Sleeper sleeper_;
+    std::size_t max_attempts_;
+    duration initial_;
+    duration max_backoff_;
+    double multiplier_;
+    double jitter_;
+    duration deadline_;
+  };
+
+  template <class Retryable>
+  retry_policy<typename std::decay<Retryable>::type>
+  make_retry_policy(Retryable&& r)
+  {
+    return retry_policy<typename std::decay<Retryable>::type>(std::forward<Retryable>(r));
+  }
+
+  template <class Clock, class Retryable, class Sleeper>
+  retry_policy<typename std::decay<Retryable>::type, typename std::decay<Sleeper>::type, Clock>
+  make_retry_policy(Retryable&& r, Sleeper&& s)
+  {
+    return retry_policy<typename std::decay<Retryable>::type, typename std::decay<Sleeper>::type, Clock>(
+        std::forward<Retryable>(r), std::forward<Sleeper>(s));
+  }
+
+namespace retry_detail
+{
+  // In [0, 1), from a per thread xorshift generator: no state to share
+  // between threads retrying at once.
+  inline double uniform()
+  {
+    static thread_local std::uint64_t x = 0;
+    if (x == 0)
+      x = std::uint64_t(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return double(x >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  // The error handler given to catch_error: either the result of one more
+  // attempt, or the error again once retrying is over.
+  template <class F, class Policy, class Result>
+  struct attempt
+  {
+    typedef typename Policy::clock clock;
+    typedef typename Result::error_type error_type;
+
+    Result operator()(error_type const& e)
+    {
+      if (! policy.is_retryable(e))
+        return done(e, retry_outcome::not_retryable);
+      if (stats.attempts >= policy.max_attempts())
+        return done(e, retry_outcome::attempts_exhausted);
+      typename clock::duration const wait = policy.wait_after(stats.attempts, uniform());
+      if (policy.deadline() != clock::duration::max()
+          && clock::now() + wait - start >= policy.deadline())
+        return done(e, retry_outcome::deadline_exceeded);
+      policy.sleep(wait);
+      stats.slept += std::chrono::duration_cast<std::chrono::nanoseconds>(wait);
+      ++stats.attempts;
+      return f();
+    }
+
+    Result done(error_type const& e, retry_outcome o)
+    {
+      over = true;
+      stats.outcome = o;
+      return Result(make_unexpected(e));
+    }
+
+    F& f;
+    Policy& policy;
+    retry_stats& stats;
+    typename clock::time_point start;
+    bool over;
+  };
+} // namespace retry_detail
+
+  // Calls f, which returns an expected, until it returns a value or an error
+  // that policy does not retry, as r = r.catch_error(one more attempt) does
+  // while attempts and time remain. Returns the last result and records the
+  // attempts made in stats. Exceptions thrown by f are propagated.
+  template <class F, class Retryable, class Sleeper, class Clock>
+  typename std::result_of<F()>::type
+  retry(F&& f, retry_policy<Retryable, Sleeper, Clock> policy, retry_stats& stats)
+  {
+    typedef typename std::result_of<F()>::type result_type;
+    static_assert(is_expected<result_type>::value, "retry needs a function returning an expected");
+    typedef retry_detail::attempt<F, retry_policy<Retryable, Sleeper, Clock>, result_type> attempt;
+
+    stats = retry_stats();
+    // the clock is only read when there is a deadline to meet
+    bool const timed = policy.deadline() != Clock::duration::max();
+    attempt next = { f, policy, stats, timed ? Clock::now() : typename Clock::time_point(), false };
+    stats.attempts = 1;
+    result_type r = f();
+    while (! r.valid() && ! next.over)
+      r = r.catch_error(next);
+    if (r.valid())
+      stats.outcome = retry_outcome::succeeded;
+    return r;
+  }
+
+  template <class F, class Retryable, class Sleeper, class Clock>
+  typename std::result_of<F()>::type
+  retry(F&& f, retry_policy<Retryable, Sleeper, Clock> const& policy)
+  {
+    retry_stats stats;
+    return retry(std::forward<F>(f), policy, stats);
+  }
+
+} // namespace expected_alg
+} // namespace boost
+
+#endif // BOOST_EXPECTED_ALGORITHMS_RETRY_HPP
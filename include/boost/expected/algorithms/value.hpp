@@ -7,6 +7,7 @@
 #define BOOST_EXPECTED_ALGORITHMS_VALUE_HPP
 
 #include <boost/expected/expected.hpp>
+#include <boost/exception_ptr.hpp>
 
 //decay_t
 
@@ -0,0 +1,187 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_ATOMIC_EXPECTED_HPP
+#define BOOST_EXPECTED_ATOMIC_EXPECTED_HPP
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/detail/atomic_wait.hpp>
+#include <boost/expected/detail/cache_line.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace boost
+{
+  // Write-once cell publishing an expected<T, E> to other threads. The
+  // state word goes empty -> writing -> value or error; the final store is
+  // a release, so a reader seeing value or error also sees the result.
+  // Cells are aligned on a cache line, so the cells of an array written by
+  // different threads do not share one.
+  template <class T, class E = std::exception_ptr>
+  class alignas(expected_detail::cache_line_size) atomic_expected
+  {
+  public:
+    typedef expected<T, E> result_type;
+    typedef T value_type;
+    typedef E error_type;
+
+    atomic_expected() BOOST_NOEXCEPT : state_(empty) {}
+    atomic_expected(atomic_expected const&) = delete;
+    atomic_expected& operator=(atomic_expected const&) = delete;
+
+    ~atomic_expected()
+    {
+      if (state_.load(std::memory_order_relaxed) >= has_value)
+        result().~result_type();
+    }
+
+    // The setters return false, leaving the cell unchanged, when it was
+    // already set or is being set by another thread. If building the
+    // result throws the cell stays empty.
+    template <class ...Args>
+    bool set_value(Args&&... args)
+    {
+      return publish(has_value, in_place_t{}, std::forward<Args>(args)...);
+    }
+
+    template <class G>
+    bool set_error(G&& e)
+    {
+      return publish(has_error, make_unexpected(error_type(std::forward<G>(e))));
+    }
+
+    bool set(result_type r)
+    {
+      unsigned const to = r.valid() ? has_value : has_error;
+      return publish(to, std::move(r));
+    }
+
+    bool is_ready() const BOOST_NOEXCEPT
+    {
+      return state_.load(std::memory_order_acquire) >= has_value;
+    }
+
+    // The result, or null while the cell is not set.
+    result_type const* try_get() const BOOST_NOEXCEPT
+    {
+      return is_ready() ? &result() : 0;
+    }
+
+    result_type const& wait() const
+    {
+      unsigned state;
+      while ((state = state_.load(std::memory_order_acquire)) < has_value)
+        expected_detail::atomic_wait(state_, state);
+      return result();
+    }
+
+  private:
+    enum : unsigned { empty, writing, has_value, has_error };
+
+    template <class ...Args>
+    bool publish(unsigned to, Args&&... args)
+    {
+      unsigned state = empty;
+      if (! state_.compare_exchange_strong(state, writing, std::memory_order_acquire, std::memory_order_relaxed))
+        return false;
+      try
+      {
+        ::new (static_cast<void*>(&storage_)) result_type(std::forward<Args>(args)...);
+      }
+      catch (...)
+      {
+        state_.store(empty, std::memory_order_release);
+        throw;
+      }
+      state_.store(to, std::memory_order_release);
+      expected_detail::atomic_notify_all(state_);
+      return true;
+    }
+
+    result_type& result() BOOST_NOEXCEPT
+    {
+      return *reinterpret_cast<result_type*>(&storage_);
+    }
+    result_type const& result() const BOOST_NOEXCEPT
+    {
+      return *reinterpret_cast<result_type const*>(&storage_);
+    }
+
+    std::atomic<unsigned> state_;
+    typename std::aligned_storage<sizeof(result_type), alignof(result_type)>::type storage_;
+  };
+
+  // Fixed size table of atomic_expected, one cell per task of a fork/join
+  // batch: each task sets its own cell and the joining thread waits for all
+  // of them. The storage is aligned by hand, as operator new does not
+  // honour over-aligned types before C++17.
+  template <class T, class E = std::exception_ptr>
+  class atomic_expected_array
+  {
+  public:
+    typedef atomic_expected<T, E> cell_type;
+    typedef expected<T, E> result_type;
+    typedef std::size_t size_type;
+
+    explicit atomic_expected_array(size_type n)
+      : raw_(::operator new(n * sizeof(cell_type) + alignof(cell_type))), cells_(0), size_(n)
+    {
+      void* p = raw_;
+      std::size_t space = n * sizeof(cell_type) + alignof(cell_type);
+      cells_ = static_cast<cell_type*>(std::align(alignof(cell_type), n * sizeof(cell_type), p, space));
+      for (size_type i = 0; i < n; ++i)
+        ::new (static_cast<void*>(cells_ + i)) cell_type();
+    }
+
+    atomic_expected_array(atomic_expected_array const&) = delete;
+    atomic_expected_array& operator=(atomic_expected_array const&) = delete;
+
+    ~atomic_expected_array()
+    {
+      for (size_type i = 0; i < size_; ++i)
+        cells_[i].~cell_type();
+      ::operator delete(raw_);
+    }
+
+    size_type size() const BOOST_NOEXCEPT { return size_; }
+
+    cell_type& operator[](size_type i) BOOST_NOEXCEPT { return cells_[i]; }
+    cell_type const& operator[](size_type i) const BOOST_NOEXCEPT { return cells_[i]; }
+
+    cell_type* begin() BOOST_NOEXCEPT { return cells_; }
+    cell_type* end() BOOST_NOEXCEPT { return cells_ + size_; }
+    cell_type const* begin() const BOOST_NOEXCEPT { return cells_; }
+    cell_type const* end() const BOOST_NOEXCEPT { return cells_ + size_; }
+
+    // Number of cells set so far.
+    size_type ready_count() const BOOST_NOEXCEPT
+    {
+      size_type n = 0;
+      for (size_type i = 0; i < size_; ++i)
+        n += cells_[i].is_ready();
+      return n;
+    }
+
+    void wait_all() const
+    {
+      for (size_type i = 0; i < size_; ++i)
+        cells_[i].wait();
+    }
+
+  private:
+    void* raw_;
+    cell_type* cells_;
+    size_type size_;
+  };
+
+} // namespace boost
+
+#endif // BOOST_EXPECTED_ATOMIC_EXPECTED_HPP
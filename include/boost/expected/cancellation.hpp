@@ -0,0 +1,271 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_CANCELLATION_HPP
+#define BOOST_EXPECTED_CANCELLATION_HPP
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/error_traits.hpp>
+#include <boost/functional/inplace_function.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace boost
+{
+  // Error of an operation stopped by a cancellation request. It is a
+  // std::system_error with std::errc::operation_canceled, so that
+  // error_traits turns it into an exception_ptr or an error_code alike.
+  class operation_cancelled : public std::system_error
+  {
+  public:
+    operation_cancelled()
+      : std::system_error(std::make_error_code(std::errc::operation_canceled), "operation cancelled")
+    {}
+  };
+
+  // The cancellation error as an E, through error_traits<E>.
+  template <class E>
+  unexpected_type<E> make_unexpected_cancelled()
+  {
+    return make_unexpected(error_traits<E>::make_error(operation_cancelled()));
+  }
+
+  class cancellation_source;
+  class cancellation_token;
+  class cancellation_callback;
+
+namespace expected_detail
+{
+  struct cancellation_callback_base
+  {
+    cancellation_callback_base() : prev(0), next(0), removed(0) {}
+    virtual void invoke() = 0;
+    cancellation_callback_base* prev;
+    cancellation_callback_base* next;
+    bool* removed;
+  protected:
+    ~cancellation_callback_base() {}
+  };
+
+  // The flag read by the tokens, apart from the list of callbacks run by
+  // the first cancellation request.
+  class cancellation_state
+  {
+  public:
+    cancellation_state() : requested_(false), head_(0), running_(0) {}
+
+    bool is_requested() const BOOST_NOEXCEPT
+    {
+      return requested_.load(std::memory_order_relaxed);
+    }
+
+    bool request()
+    {
+      if (requested_.exchange(true, std::memory_order_acq_rel))
+        return false;
+      std::unique_lock<std::mutex> lock(mutex_);
+      requester_ = std::this_thread::get_id();
+      while (cancellation_callback_base* cb = head_)
+      {
+        unlink(cb);
+        bool removed = false;
+        cb->removed = &removed;
+        running_ = cb;
+        lock.unlock();
+        cb->invoke();
+        lock.lock();
+        // a callback destroying itself must not be touched any more
+        if (! removed)
+          cb->removed = 0;
+        running_ = 0;
+        done_.notify_all();
+      }
+      return true;
+    }
+
+    // Returns false, without registering cb, when cancellation was already
+    // requested.
+    bool add(cancellation_callback_base* cb)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (requested_.load(std::memory_order_acquire))
+        return false;
+      cb->prev = 0;
+      cb->next = head_;
+      cb->removed = 0;
+      if (head_)
+        head_->prev = cb;
+      head_ = cb;
+      return true;
+    }
+
+    // Once remove returns cb is not running, unless it is the callback
+    // removing itself.
+    void remove(cancellation_callback_base* cb)
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (cb->prev || head_ == cb)
+      {
+        unlink(cb);
+        return;
+      }
+      if (running_ != cb)
+        return;
+      if (requester_ == std::this_thread::get_id())
+      {
+        *cb->removed = true;
+        return;
+      }
+      while (running_ == cb)
+        done_.wait(lock);
+    }
+
+  private:
+    void unlink(cancellation_callback_base* cb)
+    {
+      if (cb->prev)
+        cb->prev->next = cb->next;
+      else
+        head_ = cb->next;
+      if (cb->next)
+        cb->next->prev = cb->prev;
+      cb->prev = cb->next = 0;
+    }
+
+    std::atomic<bool> requested_;
+    std::mutex mutex_;
+    std::condition_variable done_;
+    cancellation_callback_base* head_;
+    cancellation_callback_base* running_;
+    std::thread::id requester_;
+  };
+} // namespace expected_detail
+
+  // Read side of a cancellation_source. Checking it is a single relaxed
+  // load: the request is a hint to stop, and what was done before it is
+  // published by the means returning the results, not by the token.
+  class cancellation_token
+  {
+  public:
+    // A token that is never cancelled.
+    cancellation_token() BOOST_NOEXCEPT {}
+
+    bool is_cancellation_requested() const BOOST_NOEXCEPT
+    {
+      return state_ && state_->is_requested();
+    }
+
+    bool can_be_cancelled() const BOOST_NOEXCEPT
+    {
+      return state_ != 0;
+    }
+
+  private:
+    friend class cancellation_source;
+    friend class cancellation_callback;
+
+    explicit cancellation_token(std::shared_ptr<expected_detail::cancellation_state> const& s) BOOST_NOEXCEPT
+      : state_(s)
+    {}
+
+    std::shared_ptr<expected_detail::cancellation_state> state_;
+  };
+
+  class cancellation_source
+  {
+  public:
+    cancellation_source() : state_(std::make_shared<expected_detail::cancellation_state>()) {}
+
+    cancellation_token token() const BOOST_NOEXCEPT
+    {
+      return cancellation_token(state_);
+    }
+
+    // Runs the registered callbacks on the calling thread. Returns false if
+    // cancellation was already requested.
+    bool request_cancellation()
+    {
+      return state_->request();
+    }
+
+    bool is_cancellation_requested() const BOOST_NOEXCEPT
+    {
+      return state_->is_requested();
+    }
+
+  private:
+    std::shared_ptr<expected_detail::cancellation_state> state_;
+  };
+
+  // Calls f once cancellation is requested on the token, on the requesting
+  // thread, or at once on this one if it already was; lets blocking work be
+  // woken up. The destructor deregisters f, waiting for it to return if it
+  // is running on another thread. f is kept in the callback itself when it
+  // fits in four pointers, as lambdas capturing a few references do.
+  class cancellation_callback : private expected_detail::cancellation_callback_base
+  {
+  public:
+    template <class F>
+    cancellation_callback(cancellation_token const& t, F&& f)
+      : state_(t.state_), f_(make_function(std::forward<F>(f)))
+    {
+      if (state_ && ! state_->add(this))
+        f_();
+    }
+
+    cancellation_callback(cancellation_callback const&) = delete;
+    cancellation_callback& operator=(cancellation_callback const&) = delete;
+
+    ~cancellation_callback()
+    {
+      if (state_)
+        state_->remove(this);
+    }
+
+  private:
+    typedef functional::inplace_function<void()> function_type;
+
+    // The ones that do not fit are allocated.
+    template <class F>
+    struct boxed
+    {
+      std::unique_ptr<F> f;
+      void operator()() { (*f)(); }
+    };
+
+    template <class F>
+    static function_type make_function(F&& f,
+      BOOST_EXPECTED_REQUIRES(function_type::template fits<typename std::decay<F>::type>::value))
+    {
+      return function_type(std::forward<F>(f));
+    }
+    template <class F>
+    static function_type make_function(F&& f,
+      BOOST_EXPECTED_REQUIRES(! function_type::template fits<typename std::decay<F>::type>::value))
+    {
+      typedef typename std::decay<F>::type G;
+      boxed<G> b = { std::unique_ptr<G>(new G(std::forward<F>(f))) };
+      return function_type(std::move(b));
+    }
+
+    void invoke()
+    {
+      f_();
+    }
+
+    std::shared_ptr<expected_detail::cancellation_state> state_;
+    function_type f_;
+  };
+
+} // namespace boost
+
+#endif // BOOST_EXPECTED_CANCELLATION_HPP
@@ -0,0 +1,391 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_CIRCUIT_BREAKER_HPP
+#define BOOST_EXPECTED_CIRCUIT_BREAKER_HPP
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/error_traits.hpp>
+#include <boost/expected/detail/cache_line.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace boost
+{
+  enum class circuit_errc
+  {
+    open = 1
+  };
+
+  inline std::error_category const& circuit_category() BOOST_NOEXCEPT
+  {
+    struct category : std::error_category
+    {
+      char const* name() const BOOST_NOEXCEPT { return "circuit_breaker"; }
+      std::string message(int) const { return "circuit open"; }
+    };
+    static category const c;
+    return c;
+  }
+
+  inline std::error_code make_error_code(circuit_errc e) BOOST_NOEXCEPT
+  {
+    return std::error_code(int(e), circuit_category());
+  }
+} // namespace boost
+
+namespace std
+{
+  template <>
+  struct is_error_code_enum<boost::circuit_errc> : true_type {};
+}
+
+namespace boost
+{
+  // Error of a call rejected by an open circuit_breaker. As a system_error
+  // error_traits turns it into an exception_ptr or an error_code alike.
+  class circuit_open : public std::system_error
+  {
+  public:
+    circuit_open() : std::system_error(make_error_code(circuit_errc::open)) {}
+  };
+
+  // Made once per error type: an open breaker rejects calls in bulk.
+  template <class E>
+  unexpected_type<E> make_unexpected_circuit_open()
+  {
+    static E const error = error_traits<E>::make_error(circuit_open());
+    return make_unexpected(error);
+  }
+
+  enum class circuit_state
+  {
+    closed,
+    open,
+    half_open
+  };
+
+  struct circuit_breaker_options
+  {
+    circuit_breaker_options()
+      : failure_ratio(0.5), minimum_calls(20),
+        window(std::chrono::seconds(10)), buckets(10),
+        open_duration(std::chrono::seconds(5)), probes(3)
+    {}
+
+    // Opens once errors / calls >= failure_ratio over the window, with at
+    // least minimum_calls calls in it.
+    double failure_ratio;
+    std::size_t minimum_calls;
+    // Split in buckets, the oldest dropped as time goes.
+    std::chrono::nanoseconds window;
+    std::size_t buckets;
+    // How long it stays open before letting probes through.
+    std::chrono::nanoseconds open_duration;
+    // Calls let through when half open, all of which must succeed to close.
+    std::size_t probes;
+  };
+
+  struct circuit_counts
+  {
+    std::size_t calls;
+    std::size_t errors;
+  };
+
+namespace expected_detail
+{
+  struct alignas(cache_line_size) circuit_cell
+  {
+    std::atomic<std::uint64_t> count;
+  };
+
+  // Spreads the threads over the stripes of a bucket. Initialised by hand,
+  // as a thread_local with a dynamic initialiser is checked on each access.
+  inline std::size_t circuit_stripe() BOOST_NOEXCEPT
+  {
+    static std::atomic<std::size_t> next(0);
+    static thread_local std::size_t stripe = std::size_t(-1);
+    if (BOOST_UNLIKELY(stripe == std::size_t(-1)))
+      stripe = next.fetch_add(1, std::memory_order_relaxed);
+    return stripe;
+  }
+} // namespace expected_detail
+
+  // Wraps calls to an expected-returning function, failing fast with
+  // circuit_open once the dependency behind it errs too often.
+  //
+  // Closed, a call adds 1 to the calls, or to both calls and errors, of
+  // the cell of its thread in the current time bucket: one relaxed
+  // fetch_add, in one word. The clock is read on errors, to drop the
+  // buckets that fell out of the window and check the ratio, and on one
+  // success out of 64, so that buckets go on turning without errors.
+  // Open, calls are rejected until open_duration has passed, then it is
+  // half open and lets probes through: it closes when they all succeed
+  // and opens again on the first error. An exception from the function
+  // counts as an error and is propagated.
+  template <class Clock = std::chrono::steady_clock>
+  class circuit_breaker
+  {
+  public:
+    explicit circuit_breaker(circuit_breaker_options const& o = circuit_breaker_options())
+      : opts_(o), state_(word(circuit_state::closed)), open_until_(0), rejected_(0)
+    {
+      if (opts_.buckets == 0)
+        opts_.buckets = 1;
+      if (opts_.probes == 0)
+        opts_.probes = 1;
+      width_ = (std::max)(typename Clock::rep(1),
+          std::chrono::duration_cast<typename Clock::duration>(opts_.window).count()
+          / typename Clock::rep(opts_.buckets));
+      stripes_ = 1;
+      while (stripes_ < std::thread::hardware_concurrency() && stripes_ < 64)
+        stripes_ *= 2;
+
+      // aligned by hand, as operator new does not honour over-aligned types
+      // before C++17
+      std::size_t const n = opts_.buckets * stripes_;
+      std::size_t space = n * sizeof(cell) + alignof(cell);
+      raw_ = ::operator new(space);
+      void* p = raw_;
+      cells_ = static_cast<cell*>(std::align(alignof(cell), n * sizeof(cell), p, space));
+      for (std::size_t i = 0; i < n; ++i)
+        new (&cells_[i]) cell();
+      clear();
+    }
+
+    circuit_breaker(circuit_breaker const&) = delete;
+    circuit_breaker& operator=(circuit_breaker const&) = delete;
+
+    ~circuit_breaker()
+    {
+      ::operator delete(raw_);
+    }
+
+    template <class F>
+    typename std::result_of<F()>::type call(F&& f)
+    {
+      typedef typename std::result_of<F()>::type result_type;
+      static_assert(is_expected<result_type>::value, "circuit_breaker needs a function returning an expected");
+
+      if (BOOST_LIKELY(state_.load(std::memory_order_relaxed) == word(circuit_state::closed)))
+      {
+        try
+        {
+          result_type r = f();
+          if (BOOST_LIKELY(r.valid()))
+            on_success();
+          else
+            on_error();
+          return r;
+        }
+        catch (...)
+        {
+          on_error();
+          throw;
+        }
+      }
+      return call_not_closed<result_type>(f);
+    }
+
+    circuit_state state() const BOOST_NOEXCEPT
+    {
+      return circuit_state(state_.load(std::memory_order_relaxed) & state_mask);
+    }
+
+    // Calls and errors in the window, as last seen.
+    circuit_counts counts() const BOOST_NOEXCEPT
+    {
+      circuit_counts c = { 0, 0 };
+      std::size_t const n = opts_.buckets * stripes_;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        std::uint64_t const x = cells_[i].count.load(std::memory_order_relaxed);
+        c.calls += std::size_t(x & low_mask);
+        c.errors += std::size_t(x >> 32);
+      }
+      return c;
+    }
+
+    // Calls rejected without calling the function.
+    std::size_t rejected() const BOOST_NOEXCEPT
+    {
+      return rejected_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    typedef expected_detail::circuit_cell cell;
+
+    // The state word: the state in the low bits, then, when half open, the
+    // probes let through and the probes that succeeded.
+    static BOOST_CONSTEXPR_OR_CONST std::uint64_t state_mask = 3;
+    static BOOST_CONSTEXPR_OR_CONST std::uint64_t probe_admitted = 1 << 2;
+    static BOOST_CONSTEXPR_OR_CONST std::uint64_t probe_succeeded = std::uint64_t(1) << 32;
+    static BOOST_CONSTEXPR_OR_CONST std::uint64_t low_mask = 0xffffffffu;
+    // a call and an error in a cell
+    static BOOST_CONSTEXPR_OR_CONST std::uint64_t one_error = (std::uint64_t(1) << 32) + 1;
+
+    static std::uint64_t word(circuit_state s) BOOST_NOEXCEPT { return std::uint64_t(s); }
+
+    static typename Clock::rep now() { return Clock::now().time_since_epoch().count(); }
+
+    cell& current() BOOST_NOEXCEPT
+    {
+      return cells_[bucket_.load(std::memory_order_relaxed) + (expected_detail::circuit_stripe() & (stripes_ - 1))];
+    }
+
+    void on_success()
+    {
+      if (BOOST_UNLIKELY((current().count.fetch_add(1, std::memory_order_relaxed) & 63) == 63))
+        rotate();
+    }
+
+    void on_error()
+    {
+      rotate();
+      current().count.fetch_add(one_error, std::memory_order_relaxed);
+      circuit_counts const c = counts();
+      if (c.calls >= opts_.minimum_calls && double(c.errors) >= opts_.failure_ratio * double(c.calls))
+        trip(word(circuit_state::closed));
+    }
+
+    // Moves the current bucket to the time slot of now, emptying the buckets
+    // of the slots skipped. Counts added meanwhile to a bucket being emptied
+    // may be lost; the window is a statistic.
+    void rotate()
+    {
+      typename Clock::rep const slot = now() / width_;
+      typename Clock::rep cur = epoch_.load(std::memory_order_relaxed);
+      while (slot > cur)
+      {
+        if (epoch_.compare_exchange_weak(cur, slot, std::memory_order_relaxed))
+        {
+          typename Clock::rep const last = (std::min)(slot, cur + typename Clock::rep(opts_.buckets));
+          for (typename Clock::rep s = cur + 1; s <= last; ++s)
+            clear_bucket(std::size_t(std::uint64_t(s) % opts_.buckets));
+          bucket_.store(std::size_t(std::uint64_t(slot) % opts_.buckets) * stripes_, std::memory_order_relaxed);
+          return;
+        }
+      }
+    }
+
+    void clear_bucket(std::size_t b) BOOST_NOEXCEPT
+    {
+      for (std::size_t i = 0; i < stripes_; ++i)
+        cells_[b * stripes_ + i].count.store(0, std::memory_order_relaxed);
+    }
+
+    void clear()
+    {
+      for (std::size_t b = 0; b < opts_.buckets; ++b)
+        clear_bucket(b);
+      typename Clock::rep const slot = now() / width_;
+      epoch_.store(slot, std::memory_order_relaxed);
+      bucket_.store(std::size_t(std::uint64_t(slot) % opts_.buckets) * stripes_, std::memory_order_relaxed);
+    }
+
+    // Opens from the state word from, unless another thread changed it.
+    void trip(std::uint64_t from)
+    {
+      if (state_.load(std::memory_order_relaxed) != from)
+        return;
+      open_until_.store(now() + std::chrono::duration_cast<typename Clock::duration>(opts_.open_duration).count(),
+          std::memory_order_relaxed);
+      state_.compare_exchange_strong(from, word(circuit_state::open), std::memory_order_release,
+          std::memory_order_relaxed);
+    }
+
+    template <class R, class F>
+    BOOST_NOINLINE R call_not_closed(F& f)
+    {
+      typedef typename R::error_type error_type;
+      std::uint64_t w = state_.load(std::memory_order_acquire);
+      for (;;)
+      {
+        circuit_state const s = circuit_state(w & state_mask);
+        if (s == circuit_state::closed)
+          return call(f);
+        if (s == circuit_state::open)
+        {
+          if (now() < open_until_.load(std::memory_order_relaxed))
+            break;
+          state_.compare_exchange_weak(w, word(circuit_state::half_open), std::memory_order_acq_rel);
+          w = state_.load(std::memory_order_acquire);
+          continue;
+        }
+        if ((w & low_mask) / probe_admitted >= opts_.probes)
+          break;
+        if (state_.compare_exchange_weak(w, w + probe_admitted, std::memory_order_acq_rel))
+          return probe<R>(f);
+      }
+      rejected_.fetch_add(1, std::memory_order_relaxed);
+      return R(make_unexpected_circuit_open<error_type>());
+    }
+
+    template <class R, class F>
+    R probe(F& f)
+    {
+      try
+      {
+        R r = f();
+        probe_done(r.valid());
+        return r;
+      }
+      catch (...)
+      {
+        probe_done(false);
+        throw;
+      }
+    }
+
+    void probe_done(bool ok)
+    {
+      std::uint64_t w = state_.load(std::memory_order_acquire);
+      while ((w & state_mask) == word(circuit_state::half_open))
+      {
+        if (! ok)
+        {
+          trip(w);
+          return;
+        }
+        if ((w >> 32) + 1 < opts_.probes)
+        {
+          if (state_.compare_exchange_weak(w, w + probe_succeeded, std::memory_order_acq_rel))
+            return;
+          continue;
+        }
+        // the window starts afresh, the old errors being the reason it opened
+        clear();
+        if (state_.compare_exchange_weak(w, word(circuit_state::closed), std::memory_order_acq_rel))
+          return;
+      }
+    }
+
+    circuit_breaker_options opts_;
+    std::atomic<std::uint64_t> state_;
+    std::atomic<typename Clock::rep> open_until_;
+    // the time slot of the current bucket, and the index of its first cell
+    std::atomic<typename Clock::rep> epoch_;
+    std::atomic<std::size_t> bucket_;
+    std::atomic<std::size_t> rejected_;
+    typename Clock::rep width_;
+    std::size_t stripes_;
+    void* raw_;
+    cell* cells_;
+  };
+
+} // namespace boost
+
+#endif // BOOST_EXPECTED_CIRCUIT_BREAKER_HPP
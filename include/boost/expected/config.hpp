@@ -78,5 +78,41 @@
 #  define BOOST_EXPECTED_USE_STD_ADDRESSOF
 # endif
 
+# if defined __GLIBCXX__ && defined __GNUC__ && ! defined __clang__
+#  if (__GNUC__ < 5)
+#   define BOOST_EXPECTED_NO_CXX11_IS_TRIVIALLY_COPYABLE
+#  endif
+# endif
+
+# if defined BOOST_NO_CXX14_CONSTEXPR
+#  define BOOST_EXPECTED_CXX14_CONSTEXPR
+# else
+#  define BOOST_EXPECTED_CXX14_CONSTEXPR constexpr
+# endif
+
+// The catch_all_ functions of expected have a try block under
+// BOOST_EXPECTED_CATCH_EXCEPTIONS, which a constexpr function can have
+// since C++20 only.
+# if defined BOOST_EXPECTED_CATCH_EXCEPTIONS && ! (defined __cpp_constexpr && __cpp_constexpr >= 201907L)
+#  define BOOST_EXPECTED_CATCH_ALL_CONSTEXPR
+# else
+#  define BOOST_EXPECTED_CATCH_ALL_CONSTEXPR BOOST_EXPECTED_CXX14_CONSTEXPR
+# endif
+
+# if defined __cpp_impl_coroutine && defined __has_include
+#  if __cpp_impl_coroutine >= 201902L && __has_include(<coroutine>)
+#   define BOOST_EXPECTED_HAS_COROUTINES
+#  endif
+# endif
+
+# if defined __has_include
+#  if __cplusplus >= 201703L && __has_include(<optional>) && __has_include(<variant>)
+#   define BOOST_EXPECTED_HAS_STD_OPTIONAL
+#   define BOOST_EXPECTED_HAS_STD_VARIANT
+#  endif
+#  if __cplusplus > 202002L && __has_include(<expected>)
+#   define BOOST_EXPECTED_HAS_STD_EXPECTED
+#  endif
+# endif
 
 #endif // BOOST_EXPECTED_CONFIG_HPP
@@ -0,0 +1,16 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_CONVERSION_FROM_NULLOPT_HPP
+#define BOOST_EXPECTED_CONVERSION_FROM_NULLOPT_HPP
+
+namespace boost
+{
+  // The error of an expected made from an empty optional.
+  struct conversion_from_nullopt {};
+
+} // namespace boost
+
+#endif // BOOST_EXPECTED_CONVERSION_FROM_NULLOPT_HPP
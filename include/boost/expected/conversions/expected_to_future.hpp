@@ -31,10 +31,15 @@ namespace boost
     return std::move(f);
   }
 
+  // For results already known, prefer make_ready_expected_future from
+  // expected_future.hpp, which does not allocate a shared state.
   template <class T>
   std::future<T> make_ready_future(expected<T> e) {
-    if (e.valid()) return make_ready_future(*e);
-    else return make_unexpected_future<T>(e.error());
+    std::promise<T> p;
+    std::future<T> f = p.get_future();
+    if (e.valid()) p.set_value(std::move(*e));
+    else p.set_exception(e.error());
+    return f;
   }
 
 
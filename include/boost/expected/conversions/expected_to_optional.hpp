@@ -7,25 +7,49 @@
 #define BOOST_EXPECTED_EXPECTED_TO_OPTIONAL_HPP
 
 #include <boost/expected/expected.hpp>
+#include <boost/expected/conversions/conversion_from_nullopt.hpp>
 #include <boost/optional.hpp>
-//#include <optional>
+#include <utility>
 
 namespace boost
 {
-  struct conversion_from_nullopt {};
+  // The non-const lvalue overloads are there so that the generic
+  // make_expected(T&&) and make_optional(T&&) are not preferred.
 
   template <class T>
-  expected<T> make_expected(optional<T> v) {
-    if (v) return make_expected(*v);
-    else make_unexpected(conversion_from_nullopt());
+  expected<T> make_expected(optional<T>&& v) {
+    if (v) return expected<T>(std::move(*v));
+    return make_unexpected(conversion_from_nullopt());
   }
 
   template <class T>
-  optional<T> make_optional(expected<T> e) {
+  expected<T> make_expected(optional<T> const& v) {
+    if (v) return expected<T>(*v);
+    return make_unexpected(conversion_from_nullopt());
+  }
+
+  template <class T>
+  expected<T> make_expected(optional<T>& v) {
+    return make_expected(static_cast<optional<T> const&>(v));
+  }
+
+  template <class T, class E>
+  optional<T> make_optional(expected<T, E>&& e) {
+    if (e.valid()) return optional<T>(std::move(*e));
+    return none;
+  }
+
+  template <class T, class E>
+  optional<T> make_optional(expected<T, E> const& e) {
     if (e.valid()) return optional<T>(*e);
-    else return none;
+    return none;
+  }
+
+  template <class T, class E>
+  optional<T> make_optional(expected<T, E>& e) {
+    return make_optional(static_cast<expected<T, E> const&>(e));
   }
 
 } // namespace boost
 
-#endif // BOOST_EXPECTED_UNEXPECTED_HPP
+#endif // BOOST_EXPECTED_EXPECTED_TO_OPTIONAL_HPP
@@ -0,0 +1,179 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_EXPECTED_TO_STD_HPP
+#define BOOST_EXPECTED_EXPECTED_TO_STD_HPP
+
+// Conversions between expected and std::optional, std::variant<T, E> and
+// std::expected. The payload is moved from an rvalue and copied from an
+// lvalue, never both. Each part is there when the standard library has the
+// type.
+
+#include <boost/expected/config.hpp>
+#include <boost/expected/expected.hpp>
+#include <boost/expected/conversions/conversion_from_nullopt.hpp>
+#include <utility>
+
+#if defined BOOST_EXPECTED_HAS_STD_OPTIONAL
+#include <optional>
+#endif
+#if defined BOOST_EXPECTED_HAS_STD_VARIANT
+#include <variant>
+#endif
+#if defined BOOST_EXPECTED_HAS_STD_EXPECTED
+#include <expected>
+#endif
+
+namespace boost
+{
+  // The non-const lvalue overloads of make_expected are there so that the
+  // generic make_expected(T&&) is not preferred.
+
+#if defined BOOST_EXPECTED_HAS_STD_OPTIONAL
+  template <class T>
+  expected<T> make_expected(std::optional<T>&& v)
+  {
+    if (v) return expected<T>(std::move(*v));
+    return make_unexpected(conversion_from_nullopt());
+  }
+
+  template <class T>
+  expected<T> make_expected(std::optional<T> const& v)
+  {
+    if (v) return expected<T>(*v);
+    return make_unexpected(conversion_from_nullopt());
+  }
+
+  template <class T>
+  expected<T> make_expected(std::optional<T>& v)
+  {
+    return make_expected(static_cast<std::optional<T> const&>(v));
+  }
+
+  template <class T, class E>
+  std::optional<T> make_std_optional(expected<T, E>&& e)
+  {
+    if (e.valid()) return std::optional<T>(std::in_place, std::move(*e));
+    return std::nullopt;
+  }
+
+  template <class T, class E>
+  std::optional<T> make_std_optional(expected<T, E> const& e)
+  {
+    if (e.valid()) return std::optional<T>(std::in_place, *e);
+    return std::nullopt;
+  }
+#endif
+
+#if defined BOOST_EXPECTED_HAS_STD_VARIANT
+  // A variant valueless by exception throws std::bad_variant_access.
+  template <class T, class E>
+  expected<T, E> make_expected(std::variant<T, E>&& v)
+  {
+    if (v.index() == 1) return expected<T, E>(unexpect, std::get<1>(std::move(v)));
+    return expected<T, E>(std::get<0>(std::move(v)));
+  }
+
+  template <class T, class E>
+  expected<T, E> make_expected(std::variant<T, E> const& v)
+  {
+    if (v.index() == 1) return expected<T, E>(unexpect, std::get<1>(v));
+    return expected<T, E>(std::get<0>(v));
+  }
+
+  template <class T, class E>
+  expected<T, E> make_expected(std::variant<T, E>& v)
+  {
+    return make_expected(static_cast<std::variant<T, E> const&>(v));
+  }
+
+  template <class T, class E>
+  std::variant<T, E> make_std_variant(expected<T, E>&& e)
+  {
+    if (e.valid()) return std::variant<T, E>(std::in_place_index<0>, std::move(*e));
+    return std::variant<T, E>(std::in_place_index<1>, std::move(e.error()));
+  }
+
+  template <class T, class E>
+  std::variant<T, E> make_std_variant(expected<T, E> const& e)
+  {
+    if (e.valid()) return std::variant<T, E>(std::in_place_index<0>, *e);
+    return std::variant<T, E>(std::in_place_index<1>, e.error());
+  }
+#endif
+
+#if defined BOOST_EXPECTED_HAS_STD_EXPECTED
+  template <class T, class E>
+  expected<T, E> make_expected(std::expected<T, E>&& v)
+  {
+    if (v) return expected<T, E>(std::move(*v));
+    return expected<T, E>(unexpect, std::move(v.error()));
+  }
+
+  template <class T, class E>
+  expected<T, E> make_expected(std::expected<T, E> const& v)
+  {
+    if (v) return expected<T, E>(*v);
+    return expected<T, E>(unexpect, v.error());
+  }
+
+  template <class T, class E>
+  expected<T, E> make_expected(std::expected<T, E>& v)
+  {
+    return make_expected(static_cast<std::expected<T, E> const&>(v));
+  }
+
+  template <class E>
+  expected<void, E> make_expected(std::expected<void, E>&& v)
+  {
+    if (v) return expected<void, E>(in_place2);
+    return expected<void, E>(unexpect, std::move(v.error()));
+  }
+
+  template <class E>
+  expected<void, E> make_expected(std::expected<void, E> const& v)
+  {
+    if (v) return expected<void, E>(in_place2);
+    return expected<void, E>(unexpect, v.error());
+  }
+
+  template <class E>
+  expected<void, E> make_expected(std::expected<void, E>& v)
+  {
+    return make_expected(static_cast<std::expected<void, E> const&>(v));
+  }
+
+  template <class T, class E>
+  std::expected<T, E> make_std_expected(expected<T, E>&& e)
+  {
+    if (e.valid()) return std::expected<T, E>(std::in_place, std::move(*e));
+    return std::expected<T, E>(std::unexpect, std::move(e.error()));
+  }
+
+  template <class T, class E>
+  std::expected<T, E> make_std_expected(expected<T, E> const& e)
+  {
+    if (e.valid()) return std::expected<T, E>(std::in_place, *e);
+    return std::expected<T, E>(std::unexpect, e.error());
+  }
+
+  template <class E>
+  std::expected<void, E> make_std_expected(expected<void, E>&& e)
+  {
+    if (e.valid()) return std::expected<void, E>();
+    return std::expected<void, E>(std::unexpect, std::move(e.error()));
+  }
+
+  template <class E>
+  std::expected<void, E> make_std_expected(expected<void, E> const& e)
+  {
+    if (e.valid()) return std::expected<void, E>();
+    return std::expected<void, E>(std::unexpect, e.error());
+  }
+#endif
+
+} // namespace boost
+
+#endif // BOOST_EXPECTED_EXPECTED_TO_STD_HPP
@@ -0,0 +1,255 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_COROUTINE_HPP
+#define BOOST_EXPECTED_COROUTINE_HPP
+
+#include <boost/expected/expected.hpp>
+
+#if defined BOOST_EXPECTED_HAS_COROUTINES
+
+#include <coroutine>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// A function returning expected<T, E> can be a coroutine:
+//
+//   expected<int, E> f()
+//   {
+//     int x = co_await g(); // g() returns expected<int, E>
+//     co_return x + 1;
+//   }
+//
+// co_await on an expected gives its value, or returns its error from the
+// coroutine; co_await on an unexpected_type returns it. Exceptions
+// propagate to the caller as for a plain function.
+//
+// The coroutine never suspends but to return an error, and its frame is
+// destroyed before returning to the caller, so a compiler doing heap
+// allocation elision (clang at -O2) can place the frame on the stack.
+
+namespace boost
+{
+namespace expected_detail
+{
+  template <class T, class E>
+  class coroutine_promise_base;
+  template <class T, class E>
+  class coroutine_promise;
+
+  // Object returned by get_return_object(). It converts to the expected
+  // when the compiler asks for it, which is either after the coroutine
+  // returned (gcc, msvc), or before it runs (clang); in the latter case
+  // the promise assigns the result to the returned expected.
+  template <class T, class E>
+  class coroutine_return
+  {
+  public:
+    typedef expected<T, E> result_type;
+
+    explicit coroutine_return(coroutine_promise<T, E>& p) BOOST_NOEXCEPT
+      : promise_(&p), has_result_(false)
+    {
+      p.return_object_ = this;
+    }
+
+    coroutine_return(coroutine_return&& x)
+      : promise_(x.promise_), has_result_(x.has_result_)
+    {
+      if (has_result_)
+        ::new (static_cast<void*>(&storage_)) result_type(std::move(x.result()));
+      else
+        promise_->return_object_ = this;
+    }
+
+    coroutine_return(coroutine_return const&) = delete;
+    coroutine_return& operator=(coroutine_return const&) = delete;
+
+    ~coroutine_return()
+    {
+      if (has_result_)
+        result().~result_type();
+    }
+
+    operator result_type()
+    {
+      if (has_result_)
+        return std::move(result());
+      return result_type(coroutine_return_t(), *this);
+    }
+
+    // Called by the expected constructor on eager conversion.
+    void bind(result_type& r) BOOST_NOEXCEPT
+    {
+      promise_->target_ = &r;
+    }
+
+  private:
+    friend class coroutine_promise_base<T, E>;
+
+    result_type& result() BOOST_NOEXCEPT
+    {
+      return *reinterpret_cast<result_type*>(&storage_);
+    }
+
+    void emplace(result_type&& r)
+    {
+      ::new (static_cast<void*>(&storage_)) result_type(std::move(r));
+      has_result_ = true;
+    }
+
+    coroutine_promise<T, E>* promise_;
+    bool has_result_;
+    typename std::aligned_storage<sizeof(result_type), alignof(result_type)>::type storage_;
+  };
+
+  // co_await on an expected, X is a reference to it. The expected outlives
+  // the suspension as it is either a named object or a temporary of the
+  // full expression.
+  template <class X>
+  class expected_awaiter
+  {
+  public:
+    explicit expected_awaiter(X x) BOOST_NOEXCEPT : x_(std::forward<X>(x)) {}
+
+    bool await_ready() const BOOST_NOEXCEPT
+    {
+      return x_.valid();
+    }
+
+    // Returns the error from the coroutine. The frame, and this awaiter
+    // with it, are destroyed, so nothing must be accessed after.
+    template <class Promise>
+    void await_suspend(std::coroutine_handle<Promise> h)
+    {
+      h.promise().set_error(std::forward<X>(x_).error());
+      h.destroy();
+    }
+
+    decltype(auto) await_resume()
+    {
+      typedef typename std::decay<X>::type expected_type;
+      if constexpr (! std::is_void<typename expected_type::value_type>::value)
+        return *std::forward<X>(x_);
+    }
+
+  private:
+    X x_;
+  };
+
+  template <class G>
+  class unexpected_awaiter
+  {
+  public:
+    explicit unexpected_awaiter(unexpected_type<G>&& e) : e_(std::move(e)) {}
+
+    bool await_ready() const BOOST_NOEXCEPT
+    {
+      return false;
+    }
+
+    template <class Promise>
+    void await_suspend(std::coroutine_handle<Promise> h)
+    {
+      h.promise().set_error(std::move(e_).value());
+      h.destroy();
+    }
+
+    void await_resume() const BOOST_NOEXCEPT {}
+
+  private:
+    unexpected_type<G> e_;
+  };
+
+  template <class T, class E>
+  class coroutine_promise_base
+  {
+  public:
+    typedef expected<T, E> result_type;
+
+    coroutine_return<T, E> get_return_object() BOOST_NOEXCEPT
+    {
+      return coroutine_return<T, E>(static_cast<coroutine_promise<T, E>&>(*this));
+    }
+
+    std::suspend_never initial_suspend() const BOOST_NOEXCEPT { return {}; }
+    std::suspend_never final_suspend() const BOOST_NOEXCEPT { return {}; }
+
+    void unhandled_exception()
+    {
+      throw;
+    }
+
+    template <class X, BOOST_EXPECTED_T_REQUIRES(is_expected<typename std::decay<X>::type>::value)>
+    expected_awaiter<X&&> await_transform(X&& x) BOOST_NOEXCEPT
+    {
+      return expected_awaiter<X&&>(std::forward<X>(x));
+    }
+
+    template <class G>
+    unexpected_awaiter<G> await_transform(unexpected_type<G> e)
+    {
+      return unexpected_awaiter<G>(std::move(e));
+    }
+
+    template <class G>
+    void set_error(G&& e)
+    {
+      set(result_type(unexpect, std::forward<G>(e)));
+    }
+
+  protected:
+    friend class coroutine_return<T, E>;
+
+    coroutine_promise_base() BOOST_NOEXCEPT : return_object_(0), target_(0) {}
+
+    void set(result_type&& r)
+    {
+      if (target_)
+        *target_ = std::move(r);
+      else
+        return_object_->emplace(std::move(r));
+    }
+
+    coroutine_return<T, E>* return_object_;
+    result_type* target_;
+  };
+
+  template <class T, class E>
+  class coroutine_promise : public coroutine_promise_base<T, E>
+  {
+  public:
+    void return_value(expected<T, E> r)
+    {
+      this->set(std::move(r));
+    }
+  };
+
+  template <class E>
+  class coroutine_promise<void, E> : public coroutine_promise_base<void, E>
+  {
+  public:
+    void return_void()
+    {
+      this->set(expected<void, E>(in_place2));
+    }
+  };
+
+} // namespace expected_detail
+} // namespace boost
+
+namespace std
+{
+  template <class T, class E, class... Args>
+  struct coroutine_traits<boost::expected<T, E>, Args...>
+  {
+    typedef boost::expected_detail::coroutine_promise<T, E> promise_type;
+  };
+} // namespace std
+
+#endif // BOOST_EXPECTED_HAS_COROUTINES
+
+#endif // BOOST_EXPECTED_COROUTINE_HPP
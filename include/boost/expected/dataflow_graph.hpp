@@ -0,0 +1,328 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_DATAFLOW_GRAPH_HPP
+#define BOOST_EXPECTED_DATAFLOW_GRAPH_HPP
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/work_stealing_pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace boost
+{
+  // What a recomputation of a dataflow_graph did.
+  struct dataflow_stats
+  {
+    dataflow_stats() : computed(0), propagated(0), changed(0) {}
+
+    // Nodes whose function was called.
+    std::size_t computed;
+    // Nodes which took the error of a dependency without being called.
+    std::size_t propagated;
+    // Nodes whose outcome differs from the previous one.
+    std::size_t changed;
+  };
+
+namespace expected_detail
+{
+  // Whether two outcomes are known to be the same; false when T or E has
+  // no ==, so that the dependents are recomputed.
+  template <class T, class E>
+  auto same_outcome(expected<T, E> const& x, expected<T, E> const& y, int)
+    -> decltype(bool(*x == *y) && bool(x.error() == y.error()))
+  {
+    if (x.valid() != y.valid())
+      return false;
+    return x.valid() ? bool(*x == *y) : bool(x.error() == y.error());
+  }
+  template <class T, class E>
+  bool same_outcome(expected<T, E> const&, expected<T, E> const&, long)
+  {
+    return false;
+  }
+
+  template <class F, class Args>
+  struct dataflow_call
+  {
+    F* f;
+    Args const* args;
+
+    auto operator()() -> decltype((*f)(*args))
+    {
+      return (*f)(*args);
+    }
+  };
+
+  // f(args) as an expected, the exceptions becoming the error.
+  template <class Result, class Args, class F>
+  struct dataflow_function
+  {
+    F f;
+
+    Result operator()(Args const& args)
+    {
+      dataflow_call<F, Args> call = { &f, &args };
+      return call_task<Result>(call);
+    }
+  };
+} // namespace expected_detail
+
+  // A DAG of expected<T, E>: inputs, set from outside, and nodes computed
+  // by a function of the values of their dependencies, which is not called
+  // if one of them is an error: the node takes the error of the first one,
+  // as monad::bind would. A node depends on nodes added before it.
+  //
+  // Setting an input marks its dependents dirty; recompute() then brings
+  // the dirty nodes up to date level by level, the level of a node being
+  // one more than that of its deepest dependency. The nodes of a level do
+  // not depend on each other, so that a pool runs them in parallel. A node
+  // whose outcome is the same as before, by == on T and E when they have
+  // it, does not dirty its dependents.
+  template <class T, class E = std::exception_ptr>
+  class dataflow_graph
+  {
+  public:
+    typedef std::size_t node_id;
+    typedef expected<T, E> value_type;
+
+    // The values of the dependencies of a node, in the order given.
+    class arguments
+    {
+    public:
+      std::size_t size() const BOOST_NOEXCEPT
+      {
+        return deps_->size();
+      }
+
+      T const& operator[](std::size_t i) const
+      {
+        return *graph_->nodes_[(*deps_)[i]].value;
+      }
+
+    private:
+      friend class dataflow_graph;
+      arguments(dataflow_graph const* g, std::vector<node_id> const* d) : graph_(g), deps_(d) {}
+
+      dataflow_graph const* graph_;
+      std::vector<node_id> const* deps_;
+    };
+
+    typedef std::function<value_type(arguments const&)> function_type;
+
+    dataflow_graph() : first_dirty_(1), last_dirty_(0) {}
+
+    dataflow_graph(dataflow_graph const&) = delete;
+    dataflow_graph& operator=(dataflow_graph const&) = delete;
+
+    std::size_t size() const BOOST_NOEXCEPT
+    {
+      return nodes_.size();
+    }
+
+    node_id add_input(value_type v)
+    {
+      nodes_.push_back(node(std::move(v), 0));
+      return nodes_.size() - 1;
+    }
+
+    // Adds a node computed by f(arguments), returning T or expected<T, E>,
+    // and computes it. Throws std::out_of_range on an unknown dependency.
+    template <class F>
+    node_id add_node(std::vector<node_id> deps, F&& f)
+    {
+      std::size_t level = 1;
+      for (std::size_t i = 0; i < deps.size(); ++i)
+      {
+        if (deps[i] >= nodes_.size())
+          throw std::out_of_range("dataflow_graph: unknown dependency");
+        level = (std::max)(level, nodes_[deps[i]].level + 1);
+      }
+      typedef expected_detail::dataflow_function<value_type, arguments, typename std::decay<F>::type> function;
+      function fn = { std::forward<F>(f) };
+
+      node_id const id = nodes_.size();
+      nodes_.push_back(node(evaluate(deps, fn).first, level));
+      node& n = nodes_.back();
+      n.fn = std::move(fn);
+      n.deps = std::move(deps);
+      bool stale = false;
+      for (std::size_t i = 0; i < n.deps.size(); ++i)
+      {
+        nodes_[n.deps[i]].dependents.push_back(id);
+        stale = stale || nodes_[n.deps[i]].queued;
+      }
+      // Computed from a dependency which is still to be recomputed.
+      if (stale)
+        enqueue(id);
+      return id;
+    }
+
+    // Throws std::invalid_argument on a node which is not an input.
+    void set(node_id input, value_type v)
+    {
+      node& n = nodes_.at(input);
+      if (n.level != 0)
+        throw std::invalid_argument("dataflow_graph: not an input");
+      if (expected_detail::same_outcome(n.value, v, 0))
+        return;
+      n.value = std::move(v);
+      enqueue_dependents(n);
+    }
+
+    // The last outcome computed; the one of a dirty node is stale.
+    value_type const& get(node_id id) const
+    {
+      return nodes_.at(id).value;
+    }
+
+    bool is_dirty(node_id id) const
+    {
+      return nodes_.at(id).queued;
+    }
+
+    dataflow_stats recompute()
+    {
+      return recompute(0, 0);
+    }
+
+    // Levels with more than grain dirty nodes are split in tasks of grain
+    // nodes run on the pool.
+    dataflow_stats recompute(work_stealing_pool& pool, std::size_t grain = 256)
+    {
+      return recompute(&pool, (std::max)(grain, std::size_t(1)));
+    }
+
+  private:
+    enum { computed = 1, changed = 2 };
+
+    struct node
+    {
+      node(value_type&& v, std::size_t l) : value(std::move(v)), level(l), queued(false) {}
+
+      value_type value;
+      function_type fn;
+      std::vector<node_id> deps;
+      std::vector<node_id> dependents;
+      std::size_t level;
+      bool queued;
+    };
+
+    // The outcome, and whether the function was called.
+    template <class F>
+    std::pair<value_type, bool> evaluate(std::vector<node_id> const& deps, F& fn) const
+    {
+      for (std::size_t i = 0; i < deps.size(); ++i)
+        if (! nodes_[deps[i]].value.valid())
+          return std::pair<value_type, bool>(nodes_[deps[i]].value.get_unexpected(), false);
+      arguments args(this, &deps);
+      return std::pair<value_type, bool>(fn(args), true);
+    }
+
+    // Reads the dependencies and writes the node only, so that the nodes
+    // of a level can be updated in parallel.
+    unsigned char update(node_id id)
+    {
+      node& n = nodes_[id];
+      std::pair<value_type, bool> r = evaluate(n.deps, n.fn);
+      unsigned char outcome = r.second ? computed : 0;
+      if (! expected_detail::same_outcome(n.value, r.first, 0))
+      {
+        n.value = std::move(r.first);
+        outcome |= changed;
+      }
+      return outcome;
+    }
+
+    void enqueue(node_id id)
+    {
+      node& n = nodes_[id];
+      if (n.queued)
+        return;
+      n.queued = true;
+      if (dirty_.size() <= n.level)
+        dirty_.resize(n.level + 1);
+      dirty_[n.level].push_back(id);
+      if (first_dirty_ > last_dirty_)
+        first_dirty_ = last_dirty_ = n.level;
+      else
+      {
+        first_dirty_ = (std::min)(first_dirty_, n.level);
+        last_dirty_ = (std::max)(last_dirty_, n.level);
+      }
+    }
+
+    void enqueue_dependents(node const& n)
+    {
+      for (std::size_t i = 0; i < n.dependents.size(); ++i)
+        enqueue(n.dependents[i]);
+    }
+
+    dataflow_stats recompute(work_stealing_pool* pool, std::size_t grain)
+    {
+      dataflow_stats stats;
+      // The dependents of a level are on the levels after it.
+      for (std::size_t level = first_dirty_; level <= last_dirty_ && level < dirty_.size(); ++level)
+      {
+        current_.swap(dirty_[level]);
+        outcomes_.assign(current_.size(), 0);
+        if (pool && current_.size() > grain)
+        {
+          std::vector<task_handle<void, E> > chunks;
+          for (std::size_t begin = 0; begin < current_.size(); begin += grain)
+          {
+            std::size_t const end = (std::min)(begin + grain, current_.size());
+            chunks.push_back(pool->submit<E>([this, begin, end]
+            {
+              for (std::size_t i = begin; i < end; ++i)
+                outcomes_[i] = update(current_[i]);
+            }));
+          }
+          for (std::size_t i = 0; i < chunks.size(); ++i)
+            chunks[i].wait();
+        }
+        else
+          for (std::size_t i = 0; i < current_.size(); ++i)
+            outcomes_[i] = update(current_[i]);
+
+        for (std::size_t i = 0; i < current_.size(); ++i)
+        {
+          node& n = nodes_[current_[i]];
+          n.queued = false;
+          if (outcomes_[i] & computed)
+            ++stats.computed;
+          else
+            ++stats.propagated;
+          if (outcomes_[i] & changed)
+          {
+            ++stats.changed;
+            enqueue_dependents(n);
+          }
+        }
+        current_.clear();
+      }
+      first_dirty_ = 1;
+      last_dirty_ = 0;
+      return stats;
+    }
+
+    std::vector<node> nodes_;
+    // The dirty nodes by level, between first_dirty_ and last_dirty_.
+    std::vector<std::vector<node_id> > dirty_;
+    std::size_t first_dirty_;
+    std::size_t last_dirty_;
+    std::vector<node_id> current_;
+    std::vector<unsigned char> outcomes_;
+  };
+
+} // namespace boost
+
+#endif // BOOST_EXPECTED_DATAFLOW_GRAPH_HPP
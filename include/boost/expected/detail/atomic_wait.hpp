@@ -0,0 +1,86 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_DETAIL_ATOMIC_WAIT_HPP
+#define BOOST_EXPECTED_DETAIL_ATOMIC_WAIT_HPP
+
+#include <boost/config.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#if defined BOOST_MSVC && (defined _M_IX86 || defined _M_X64)
+#include <intrin.h>
+#endif
+
+namespace boost
+{
+namespace expected_detail
+{
+  inline void cpu_relax()
+  {
+#if (defined __GNUC__ || defined __clang__) && (defined __i386__ || defined __x86_64__)
+    __builtin_ia32_pause();
+#elif defined BOOST_MSVC && (defined _M_IX86 || defined _M_X64)
+    _mm_pause();
+#endif
+  }
+
+  // Blocks while a == old. Uses the C++20 atomic wait when the library has
+  // it, otherwise spins a little, then yields and finally sleeps with a
+  // bounded backoff, so a long wait does not burn a core.
+  template <class T>
+  void atomic_wait(std::atomic<T> const& a, T old)
+  {
+#if defined __cpp_lib_atomic_wait
+    a.wait(old, std::memory_order_acquire);
+#else
+    for (int i = 0; i < 64; ++i)
+    {
+      if (a.load(std::memory_order_acquire) != old)
+        return;
+      cpu_relax();
+    }
+    for (int i = 0; i < 16; ++i)
+    {
+      if (a.load(std::memory_order_acquire) != old)
+        return;
+      std::this_thread::yield();
+    }
+    std::chrono::microseconds backoff(1);
+    while (a.load(std::memory_order_acquire) == old)
+    {
+      std::this_thread::sleep_for(backoff);
+      if (backoff < std::chrono::microseconds(1000))
+        backoff *= 2;
+    }
+#endif
+  }
+
+  template <class T>
+  void atomic_notify_all(std::atomic<T>& a)
+  {
+#if defined __cpp_lib_atomic_wait
+    a.notify_all();
+#else
+    (void)a;
+#endif
+  }
+
+  template <class T>
+  void atomic_notify_one(std::atomic<T>& a)
+  {
+#if defined __cpp_lib_atomic_wait
+    a.notify_one();
+#else
+    (void)a;
+#endif
+  }
+
+} // namespace expected_detail
+} // namespace boost
+
+#endif // BOOST_EXPECTED_DETAIL_ATOMIC_WAIT_HPP
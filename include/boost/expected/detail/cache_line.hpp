@@ -0,0 +1,25 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_DETAIL_CACHE_LINE_HPP
+#define BOOST_EXPECTED_DETAIL_CACHE_LINE_HPP
+
+#include <boost/config.hpp>
+
+#include <cstddef>
+
+namespace boost
+{
+namespace expected_detail
+{
+  // Alignment keeping data written by different threads on different cache
+  // lines. std::hardware_destructive_interference_size is not used as its
+  // value may change between compiler versions, and with it the layout.
+  BOOST_CONSTEXPR_OR_CONST std::size_t cache_line_size = 64;
+
+} // namespace expected_detail
+} // namespace boost
+
+#endif // BOOST_EXPECTED_DETAIL_CACHE_LINE_HPP
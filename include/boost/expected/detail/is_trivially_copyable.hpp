@@ -0,0 +1,27 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_DETAIL_IS_TRIVIALLY_COPYABLE_HPP
+#define BOOST_EXPECTED_DETAIL_IS_TRIVIALLY_COPYABLE_HPP
+
+#include <boost/expected/config.hpp>
+#include <type_traits>
+
+namespace boost {
+namespace expected_detail {
+
+#if defined BOOST_EXPECTED_NO_CXX11_IS_TRIVIALLY_COPYABLE
+  // libstdc++ < 5 has no is_trivially_copyable, is_trivial is a stricter approximation
+  template <class T>
+  struct is_trivially_copyable : std::is_trivial<T> {};
+#else
+  template <class T>
+  struct is_trivially_copyable : std::is_trivially_copyable<T> {};
+#endif
+
+} // namespace expected_detail
+} // namespace boost
+
+#endif // BOOST_EXPECTED_DETAIL_IS_TRIVIALLY_COPYABLE_HPP
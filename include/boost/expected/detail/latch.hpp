@@ -0,0 +1,49 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_DETAIL_LATCH_HPP
+#define BOOST_EXPECTED_DETAIL_LATCH_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace boost
+{
+namespace expected_detail
+{
+  // Single use countdown latch. The notification is done with the mutex
+  // held, so the latch can be destroyed as soon as wait() returns.
+  class latch
+  {
+  public:
+    explicit latch(std::size_t count) : count_(count) {}
+    latch(latch const&) = delete;
+    latch& operator=(latch const&) = delete;
+
+    void count_down()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--count_ == 0)
+        cv_.notify_all();
+    }
+
+    void wait()
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (count_ != 0)
+        cv_.wait(lock);
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::size_t count_;
+  };
+
+} // namespace expected_detail
+} // namespace boost
+
+#endif // BOOST_EXPECTED_DETAIL_LATCH_HPP
@@ -0,0 +1,143 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_DETAIL_WS_DEQUE_HPP
+#define BOOST_EXPECTED_DETAIL_WS_DEQUE_HPP
+
+#include <boost/expected/detail/cache_line.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace boost
+{
+namespace expected_detail
+{
+  // Chase-Lev work-stealing deque of pointers, with the memory orders of
+  // Le, Pop, Cohen and Zappa Nardelli, "Correct and efficient work-stealing
+  // for weak memory models". The owner pushes and pops at the bottom, any
+  // other thread steals from the top. The ring grows when full; the old
+  // rings are kept until the deque is destroyed, as a thief may still be
+  // reading one.
+  template <class T>
+  class ws_deque
+  {
+    struct ring
+    {
+      explicit ring(std::int64_t n) : mask(n - 1), slots(new std::atomic<T>[std::size_t(n)]) {}
+      ~ring() { delete[] slots; }
+
+      T get(std::int64_t i) const
+      {
+        return slots[i & mask].load(std::memory_order_relaxed);
+      }
+      void put(std::int64_t i, T x)
+      {
+        slots[i & mask].store(x, std::memory_order_relaxed);
+      }
+
+      std::int64_t mask;
+      std::atomic<T>* slots;
+    };
+
+  public:
+    // The capacity must be a power of 2.
+    explicit ws_deque(std::size_t capacity = 256)
+      : top_(0), bottom_(0), ring_(new ring(std::int64_t(capacity)))
+    {}
+
+    ws_deque(ws_deque const&) = delete;
+    ws_deque& operator=(ws_deque const&) = delete;
+
+    ~ws_deque()
+    {
+      delete ring_.load(std::memory_order_relaxed);
+      for (std::size_t i = 0; i < retired_.size(); ++i)
+        delete retired_[i];
+    }
+
+    // Owner only.
+    void push(T x)
+    {
+      std::int64_t const b = bottom_.load(std::memory_order_relaxed);
+      std::int64_t const t = top_.load(std::memory_order_acquire);
+      ring* r = ring_.load(std::memory_order_relaxed);
+      if (b - t > r->mask)
+        r = grow(r, t, b);
+      r->put(b, x);
+      bottom_.store(b + 1, std::memory_order_release);
+    }
+
+    // Owner only. Returns T() when empty.
+    T pop()
+    {
+      std::int64_t const b = bottom_.load(std::memory_order_relaxed) - 1;
+      ring* r = ring_.load(std::memory_order_relaxed);
+      bottom_.store(b, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      std::int64_t t = top_.load(std::memory_order_relaxed);
+      if (t > b)
+      {
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return T();
+      }
+      T x = r->get(b);
+      if (t == b)
+      {
+        // last element, race with the thieves
+        if (! top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+          x = T();
+        bottom_.store(b + 1, std::memory_order_relaxed);
+      }
+      return x;
+    }
+
+    // Any thread. Returns T() when empty; a steal lost to another thread is
+    // retried, so T() means the deque was seen empty.
+    T steal()
+    {
+      for (;;)
+      {
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t const b = bottom_.load(std::memory_order_acquire);
+        if (t >= b)
+          return T();
+        T x = ring_.load(std::memory_order_acquire)->get(t);
+        if (top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+          return x;
+      }
+    }
+
+    bool empty() const BOOST_NOEXCEPT
+    {
+      return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    ring* grow(ring* r, std::int64_t t, std::int64_t b)
+    {
+      ring* bigger = new ring(2 * (r->mask + 1));
+      for (std::int64_t i = t; i < b; ++i)
+        bigger->put(i, r->get(i));
+      retired_.push_back(r);
+      ring_.store(bigger, std::memory_order_release);
+      return bigger;
+    }
+
+    // top_ is written by the thieves, bottom_ by the owner
+    std::atomic<std::int64_t> top_;
+    char pad0_[cache_line_size - sizeof(std::atomic<std::int64_t>)];
+    std::atomic<std::int64_t> bottom_;
+    std::atomic<ring*> ring_;
+    std::vector<ring*> retired_;
+  };
+
+} // namespace expected_detail
+} // namespace boost
+
+#endif // BOOST_EXPECTED_DETAIL_WS_DEQUE_HPP
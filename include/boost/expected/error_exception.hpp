@@ -6,6 +6,7 @@
 #ifndef BOOST_EXPECTED_ERROR_EXCEPTION_HPP
 #define BOOST_EXPECTED_ERROR_EXCEPTION_HPP
 
+#include <boost/config.hpp>
 #include <boost/expected/error_traits.hpp>
 
 namespace boost {
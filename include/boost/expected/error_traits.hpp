@@ -7,7 +7,9 @@
 #define BOOST_EXPECTED_ERROR_TRAITS_HPP
 
 #include <boost/expected/bad_expected_access.hpp>
+#ifdef BOOST_EXPECTED_USE_BOOST_HPP
 #include <boost/exception_ptr.hpp>
+#endif
 #include <exception>
 #include <system_error>
 
@@ -36,6 +38,7 @@ namespace boost {
     }
   };
 
+#ifdef BOOST_EXPECTED_USE_BOOST_HPP
   template <>
   struct error_traits<exception_ptr>
   {
@@ -53,6 +56,7 @@ namespace boost {
       rethrow_exception(e);
     }
   };
+#endif
 
   template <>
   struct error_traits<std::exception_ptr>
@@ -0,0 +1,55 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+// C++20 module interface of the core: import boost.expected; gives what
+// <boost/expected/expected.hpp> declares, parsed once for the whole build.
+// The monad and algorithm headers are not part of it and are still
+// included where they are used.
+//
+// g++ -std=c++20 -fmodules-ts -x c++ -c expected.cppm
+// clang++ -std=c++20 --precompile expected.cppm -o boost.expected.pcm
+
+module;
+
+#include <boost/expected/expected.hpp>
+
+export module boost.expected;
+
+export namespace boost
+{
+  using boost::expected;
+  using boost::exception_or;
+  using boost::is_expected;
+  using boost::holder;
+
+  using boost::unexpected_type;
+  using boost::is_unexpected;
+  using boost::bad_expected_access;
+  using boost::error_traits;
+  using boost::is_trivially_relocatable;
+
+  using boost::in_place_t;
+  using boost::in_place2;
+  using boost::expect_t;
+  using boost::expect;
+  using boost::unexpect_t;
+  using boost::unexpect;
+
+  using boost::make_expected;
+  using boost::make_expected_from_current_exception;
+  using boost::make_expected_from_exception;
+  using boost::make_expected_from_error;
+  using boost::make_expected_from_call;
+  using boost::make_unexpected;
+  using boost::make_unexpected_from_current_exception;
+
+  using boost::operator==;
+  using boost::operator!=;
+  using boost::operator<;
+  using boost::operator>;
+  using boost::operator<=;
+  using boost::operator>=;
+  using boost::swap;
+}
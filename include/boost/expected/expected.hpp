@@ -11,10 +11,13 @@
 #include <boost/expected/unexpected.hpp>
 #include <boost/expected/detail/static_addressof.hpp>
 #include <boost/expected/detail/constexpr_utility.hpp>
+#include <boost/expected/detail/is_trivially_copyable.hpp>
 #include <boost/expected/detail/requires.hpp>
 #include <boost/expected/error_traits.hpp>
 #include <boost/expected/bad_expected_access.hpp>
+#include <boost/expected/trivially_relocatable.hpp>
 #include <boost/type.hpp>
+#include <boost/type_traits/is_final.hpp>
 
 #ifdef BOOST_EXPECTED_USE_BOOST_HPP
 #include <boost/exception_ptr.hpp>
@@ -137,9 +140,9 @@ union trivial_expected_storage
   value_type _val;
   error_type _err;
   BOOST_CONSTEXPR const error_type &err() const { return _err; }
-  error_type &err() { return _err; }
+  BOOST_EXPECTED_CXX14_CONSTEXPR error_type &err() { return _err; }
   BOOST_CONSTEXPR const value_type &val() const { return _val; }
-  value_type &val() { return _val; }
+  BOOST_EXPECTED_CXX14_CONSTEXPR value_type &val() { return _val; }
 #endif
 
   BOOST_EXPECTED_0_REQUIRES(
@@ -192,7 +195,7 @@ union trivial_expected_storage<void, E>
 #else
   error_type _err;
   BOOST_CONSTEXPR const error_type &err() const { return _err; }
-  error_type &err() { return _err; }
+  BOOST_EXPECTED_CXX14_CONSTEXPR error_type &err() { return _err; }
 #endif
 
   BOOST_CONSTEXPR trivial_expected_storage()
@@ -239,9 +242,9 @@ union no_trivial_expected_storage
   value_type _val;
   error_type _err;
   BOOST_CONSTEXPR const error_type &err() const { return _err; }
-  error_type &err() { return _err; }
+  BOOST_EXPECTED_CXX14_CONSTEXPR error_type &err() { return _err; }
   BOOST_CONSTEXPR const value_type &val() const { return _val; }
-  value_type &val() { return _val; }
+  BOOST_EXPECTED_CXX14_CONSTEXPR value_type &val() { return _val; }
 #endif
 
   BOOST_CONSTEXPR no_trivial_expected_storage(only_set_initialized_t)
@@ -302,7 +305,7 @@ union no_trivial_expected_storage<void, E>
 #else
   error_type _err;
   BOOST_CONSTEXPR const error_type &err() const { return _err; }
-  error_type &err() { return _err; }
+  BOOST_EXPECTED_CXX14_CONSTEXPR error_type &err() { return _err; }
 #endif
 
   BOOST_CONSTEXPR no_trivial_expected_storage(only_set_initialized_t)
@@ -417,11 +420,41 @@ struct trivial_expected_base
 //        std::is_copy_constructible<value_type>::value &&
 //        std::is_copy_constructible<error_type>::value
 //  )
-  trivial_expected_base(const trivial_expected_base& rhs)
+  BOOST_CONSTEXPR trivial_expected_base(const trivial_expected_base& rhs)
         BOOST_NOEXCEPT_IF(
           std::is_nothrow_copy_constructible<value_type>::value &&
           std::is_nothrow_copy_constructible<error_type>::value
         )
+  : trivial_expected_base(rhs, is_trivially_copyable_t())
+  {}
+
+//  BOOST_EXPECTED_0_REQUIRES(
+//      std::is_move_constructible<value_type>::value &&
+//      std::is_move_constructible<error_type>::value
+//  )
+  BOOST_CONSTEXPR trivial_expected_base(trivial_expected_base&& rhs)
+        BOOST_NOEXCEPT_IF(
+          std::is_nothrow_move_constructible<value_type>::value &&
+          std::is_nothrow_move_constructible<error_type>::value
+        )
+  : trivial_expected_base(std::move(rhs), is_trivially_copyable_t())
+  {}
+
+   ~trivial_expected_base() = default;
+
+private:
+  typedef std::integral_constant<bool,
+      expected_detail::is_trivially_copyable<value_type>::value &&
+      expected_detail::is_trivially_copyable<error_type>::value
+    > is_trivially_copyable_t;
+
+  // The union is copied as a whole, which a constant expression can do
+  // where it cannot use placement new.
+  BOOST_CONSTEXPR trivial_expected_base(const trivial_expected_base& rhs, std::true_type)
+  : has_value(rhs.has_value), storage(rhs.storage)
+  {}
+
+  trivial_expected_base(const trivial_expected_base& rhs, std::false_type)
     {
       if (rhs.has_value)
       {
@@ -434,16 +467,7 @@ struct trivial_expected_base
       has_value = rhs.has_value;
     }
 
-//  BOOST_EXPECTED_0_REQUIRES(
-//      std::is_move_constructible<value_type>::value &&
-//      std::is_move_constructible<error_type>::value
-//  )
-  trivial_expected_base(trivial_expected_base&& rhs
-    )
-        BOOST_NOEXCEPT_IF(
-          std::is_nothrow_move_constructible<value_type>::value &&
-          std::is_nothrow_move_constructible<error_type>::value
-        )
+  trivial_expected_base(trivial_expected_base&& rhs, std::false_type)
     {
       if (rhs.has_value)
       {
@@ -455,8 +479,6 @@ struct trivial_expected_base
       }
       has_value = rhs.has_value;
     }
-
-   ~trivial_expected_base() = default;
 };
 
 template <typename E>
@@ -509,10 +531,33 @@ struct trivial_expected_base<void, E>
 //  BOOST_EXPECTED_0_REQUIRES(
 //        std::is_copy_constructible<error_type>::value
 //  )
-  trivial_expected_base(const trivial_expected_base& rhs)
+  BOOST_CONSTEXPR trivial_expected_base(const trivial_expected_base& rhs)
         BOOST_NOEXCEPT_IF(
           std::is_nothrow_copy_constructible<error_type>::value
         )
+  : trivial_expected_base(rhs, is_trivially_copyable_t())
+  {}
+
+//  BOOST_EXPECTED_0_REQUIRES(
+//      std::is_move_constructible<error_type>::value
+//  )
+  BOOST_CONSTEXPR trivial_expected_base(trivial_expected_base&& rhs)
+        BOOST_NOEXCEPT_IF(
+          std::is_nothrow_move_constructible<error_type>::value
+        )
+  : trivial_expected_base(std::move(rhs), is_trivially_copyable_t())
+  {}
+
+   ~trivial_expected_base() = default;
+
+private:
+  typedef expected_detail::is_trivially_copyable<error_type> is_trivially_copyable_t;
+
+  BOOST_CONSTEXPR trivial_expected_base(const trivial_expected_base& rhs, std::true_type)
+  : has_value(rhs.has_value), storage(rhs.storage)
+  {}
+
+  trivial_expected_base(const trivial_expected_base& rhs, std::false_type)
     {
       if (rhs.has_value)
       {
@@ -524,14 +569,7 @@ struct trivial_expected_base<void, E>
       has_value = rhs.has_value;
     }
 
-//  BOOST_EXPECTED_0_REQUIRES(
-//      std::is_move_constructible<error_type>::value
-//  )
-  trivial_expected_base(trivial_expected_base&& rhs
-    )
-        BOOST_NOEXCEPT_IF(
-          std::is_nothrow_move_constructible<error_type>::value
-        )
+  trivial_expected_base(trivial_expected_base&& rhs, std::false_type)
     {
       if (rhs.has_value)
       {
@@ -543,7 +581,6 @@ struct trivial_expected_base<void, E>
       has_value = rhs.has_value;
     }
 
-   ~trivial_expected_base() = default;
 };
 
 template <typename T, typename E >
@@ -770,9 +807,11 @@ struct no_trivial_expected_base<void, E> {
   }
 };
 
+// void counts as trivially destructible, so that expected<void, E> is a
+// literal type when E is one.
 template <typename T, typename E >
   using expected_base = typename std::conditional<
-    std::is_trivially_destructible<T>::value && std::is_trivially_destructible<E>::value,
+    (std::is_void<T>::value || std::is_trivially_destructible<T>::value) && std::is_trivially_destructible<E>::value,
     trivial_expected_base<T,E>,
     no_trivial_expected_base<T,E>
   >::type;
@@ -802,6 +841,9 @@ namespace expected_detail
   template <class C>
   using unwrap_result_type_t = typename unwrap_result_type<C>::type;
 
+  // Tag of the constructor used by coroutine.hpp.
+  struct coroutine_return_t {};
+
 }
 
 template <typename T>
@@ -809,6 +851,17 @@ struct is_expected : std::false_type {};
 template <class T, class E>
 struct is_expected<expected<T,E>> : std::true_type {};
 
+// expected is a flag and a union, so it can be relocated as bytes when both
+// alternatives can.
+template <class T, class E>
+struct is_trivially_relocatable<expected<T,E>> : std::integral_constant<bool,
+  is_trivially_relocatable<T>::value && is_trivially_relocatable<E>::value
+> {};
+template <class E>
+struct is_trivially_relocatable<expected<void,E>> : is_trivially_relocatable<E> {};
+template <class T, class E>
+struct is_trivially_relocatable<expected<T&,E>> : is_trivially_relocatable<E> {};
+
 template <typename ValueType, typename ErrorType>
 class expected
 : private detail::expected_base<ValueType, ErrorType >
@@ -927,7 +980,7 @@ public:
 //      std::is_copy_constructible<value_type>::value &&
 //      std::is_copy_constructible<error_type>::value
 //  )
-  expected(const expected& rhs)
+  BOOST_CONSTEXPR expected(const expected& rhs)
       BOOST_NOEXCEPT_IF(
         std::is_nothrow_copy_constructible<value_type>::value &&
         std::is_nothrow_copy_constructible<error_type>::value
@@ -940,7 +993,7 @@ public:
 //      std::is_move_constructible<value_type>::value &&
 //      std::is_move_constructible<error_type>::value
 //  )
-  expected(expected&& rhs
+  BOOST_CONSTEXPR expected(expected&& rhs
   )
       BOOST_NOEXCEPT_IF(
         std::is_nothrow_move_constructible<value_type>::value &&
@@ -953,14 +1006,14 @@ public:
   BOOST_EXPECTED_0_REQUIRES(
       std::is_copy_constructible<error_type>::value
   )
-  expected(unexpected_type<error_type> const& e)
+  BOOST_CONSTEXPR expected(unexpected_type<error_type> const& e)
       BOOST_NOEXCEPT_IF(
         std::is_nothrow_copy_constructible<error_type>::value
       )
   : base_type(e)
   {}
   BOOST_EXPECTED_0_REQUIRES(std::is_move_constructible<error_type>::value)
-  expected(unexpected_type<error_type> && e)
+  BOOST_CONSTEXPR expected(unexpected_type<error_type> && e)
       BOOST_NOEXCEPT_IF(
         std::is_nothrow_move_constructible<error_type>::value
       )
@@ -970,7 +1023,7 @@ public:
   template <class Err
     , BOOST_EXPECTED_T_REQUIRES(std::is_constructible<error_type, Err>::value)
   >
-  expected(unexpected_type<Err> const& e)
+  BOOST_CONSTEXPR expected(unexpected_type<Err> const& e)
       BOOST_NOEXCEPT_IF((
         std::is_nothrow_constructible<error_type, Err>::value
       ))
@@ -979,7 +1032,7 @@ public:
   template <class Err
     //, BOOST_EXPECTED_T_REQUIRES(std::is_constructible<error_type, Err&&>::value)
   >
-  expected(unexpected_type<Err> && e
+  BOOST_CONSTEXPR expected(unexpected_type<Err> && e
   )
   //BOOST_NOEXCEPT_IF(
     //std::is_nothrow_constructible<error_type, Err&&>::value
@@ -992,7 +1045,7 @@ public:
   , BOOST_EXPECTED_T_REQUIRES(std::is_constructible<error_type, Args&...>::value)
 #endif
   >
-  expected(unexpect_t, Args&&... args
+  BOOST_CONSTEXPR expected(unexpect_t, Args&&... args
   )
   BOOST_NOEXCEPT_IF(
     std::is_nothrow_copy_constructible<error_type>::value
@@ -1037,6 +1090,15 @@ public:
   : base_type(in_place_t{}, il, constexpr_forward<Args>(args)...)
   {}
 
+  // Used by coroutine.hpp when the compiler converts the return object of a
+  // coroutine before running it: the result is assigned once known.
+  template <class Return>
+  expected(expected_detail::coroutine_return_t, Return& r)
+  : base_type(unexpected_type<error_type>(error_type()))
+  {
+    r.bind(*this);
+  }
+
   ~expected() = default;
 
   // Assignments
@@ -1099,8 +1161,18 @@ public:
       else
       {
         error_type t = std::move(rhs.contained_err());
-        ::new (rhs.dataptr()) value_type(std::move(contained_val()));
-        ::new (errorptr()) error_type(t);
+        rhs.contained_err().~error_type();
+        try
+        {
+          ::new (rhs.dataptr()) value_type(std::move(contained_val()));
+        }
+        catch (...)
+        {
+          ::new (rhs.errorptr()) error_type(std::move(t));
+          throw;
+        }
+        contained_val().~value_type();
+        ::new (errorptr()) error_type(std::move(t));
         std::swap(contained_has_value(), rhs.contained_has_value());
       }
     }
@@ -1318,7 +1390,7 @@ public:
 #endif
 
   template <typename F>
-  typename rebind<void>::type
+  BOOST_EXPECTED_CATCH_ALL_CONSTEXPR typename rebind<void>::type
   catch_all_type_void(F&& f)
   {
     typedef typename rebind<void>::type result_type;
@@ -1335,7 +1407,7 @@ public:
   }
 
   template <typename F>
-  typename std::result_of<F(value_type)>::type
+  BOOST_EXPECTED_CATCH_ALL_CONSTEXPR typename std::result_of<F(value_type)>::type
   catch_all_type_type(F&& f)
   {
 #if defined BOOST_EXPECTED_CATCH_EXCEPTIONS
@@ -1349,7 +1421,7 @@ public:
 #endif
   }
   template <typename F>
-  typename rebind<typename std::result_of<F(value_type)>::type>::type
+  BOOST_EXPECTED_CATCH_ALL_CONSTEXPR typename rebind<typename std::result_of<F(value_type)>::type>::type
   catch_all_type_etype(F&& f)
   {
 #if defined BOOST_EXPECTED_CATCH_EXCEPTIONS
@@ -1364,7 +1436,7 @@ public:
 #endif
   }
   template <typename F>
-  typename rebind<void>::type
+  BOOST_EXPECTED_CATCH_ALL_CONSTEXPR typename rebind<void>::type
   catch_all_etype_void(F&& f)
   {
     typedef typename rebind<void>::type result_type;
@@ -1381,7 +1453,7 @@ public:
   }
 
   template <typename F>
-  typename std::result_of<F(expected)>::type
+  BOOST_EXPECTED_CATCH_ALL_CONSTEXPR typename std::result_of<F(expected)>::type
   catch_all_etype_type(F&& f)
   {
 #if defined BOOST_EXPECTED_CATCH_EXCEPTIONS
@@ -1396,7 +1468,7 @@ public:
 #endif
   }
   template <typename F>
-  typename rebind<typename std::result_of<F(expected)>::type>::type
+  BOOST_EXPECTED_CATCH_ALL_CONSTEXPR typename rebind<typename std::result_of<F(expected)>::type>::type
   catch_all_etype_etype(F&& f)
   {
 #if defined BOOST_EXPECTED_CATCH_EXCEPTIONS
@@ -1413,7 +1485,7 @@ public:
 
 
   template <typename F>
-  typename rebind<void>::type
+  BOOST_EXPECTED_CXX14_CONSTEXPR typename rebind<void>::type
   map(F&& f,
     BOOST_EXPECTED_REQUIRES(std::is_same<typename std::result_of<F(value_type)>::type, void>::value))
   {
@@ -1433,7 +1505,7 @@ public:
   }
 
   template <typename F>
-  typename rebind<typename std::result_of<F(value_type)>::type>::type
+  BOOST_EXPECTED_CXX14_CONSTEXPR typename rebind<typename std::result_of<F(value_type)>::type>::type
   map(F&& f,
     BOOST_EXPECTED_REQUIRES(!std::is_same<typename std::result_of<F(value_type)>::type, void>::value))
   {
@@ -1495,7 +1567,7 @@ public:
 //  }
 
   template <typename F>
-  typename std::result_of<F(value_type)>::type
+  BOOST_EXPECTED_CXX14_CONSTEXPR typename std::result_of<F(value_type)>::type
   bind(F&& f,
     BOOST_EXPECTED_REQUIRES(boost::is_expected<typename std::result_of<F(value_type)>::type>::value
         )
@@ -1516,7 +1588,7 @@ public:
   }
 
   template <typename F>
-  typename rebind<void>::type
+  BOOST_EXPECTED_CXX14_CONSTEXPR typename rebind<void>::type
   then(F&& f,
     BOOST_EXPECTED_REQUIRES(std::is_same<typename std::result_of<F(expected)>::type, void>::value))
   {
@@ -1525,7 +1597,7 @@ public:
   }
 
   template <typename F>
-  typename rebind<typename std::result_of<F(expected)>::type>::type
+  BOOST_EXPECTED_CXX14_CONSTEXPR typename rebind<typename std::result_of<F(expected)>::type>::type
   then(F&& f,
     BOOST_EXPECTED_REQUIRES(!std::is_same<typename std::result_of<F(expected)>::type, void>::value
         && !boost::is_expected<typename std::result_of<F(expected)>::type>::value
@@ -1537,7 +1609,7 @@ public:
   }
 
   template <typename F>
-  typename std::result_of<F(expected)>::type
+  BOOST_EXPECTED_CXX14_CONSTEXPR typename std::result_of<F(expected)>::type
   then(F&& f,
     BOOST_EXPECTED_REQUIRES(boost::is_expected<typename std::result_of<F(expected)>::type>::value)
     )
@@ -1547,7 +1619,7 @@ public:
   }
 
   template <typename F>
-  this_type
+  BOOST_EXPECTED_CXX14_CONSTEXPR this_type
   catch_error(F&& f,
     BOOST_EXPECTED_REQUIRES(std::is_same<typename std::result_of<F(error_type)>::type, value_type>::value))
   {
@@ -1566,7 +1638,7 @@ public:
   }
 
   template <typename F>
-  this_type catch_error(F&& f,
+  BOOST_EXPECTED_CXX14_CONSTEXPR this_type catch_error(F&& f,
     BOOST_EXPECTED_REQUIRES(std::is_same<typename std::result_of<F(error_type)>::type, this_type>::value))
   {
 #if ! defined BOOST_NO_CXX14_CONSTEXPR
@@ -1584,7 +1656,7 @@ public:
   }
 
   template <typename F>
-  this_type catch_error(F&& f,
+  BOOST_EXPECTED_CXX14_CONSTEXPR this_type catch_error(F&& f,
     BOOST_EXPECTED_REQUIRES(std::is_same<typename std::result_of<F(error_type)>::type, unexpected_type<error_type>>::value))
   {
 #if ! defined BOOST_NO_CXX14_CONSTEXPR
@@ -1738,7 +1810,7 @@ public:
 
   // Constructors/Destructors/Assignments
 
-  expected(const expected& rhs
+  BOOST_CONSTEXPR expected(const expected& rhs
     , BOOST_EXPECTED_REQUIRES( std::is_copy_constructible<error_type>::value)
   )
   BOOST_NOEXCEPT_IF(
@@ -1748,7 +1820,7 @@ public:
   {
   }
 
-  expected(expected&& rhs
+  BOOST_CONSTEXPR expected(expected&& rhs
     , BOOST_EXPECTED_REQUIRES( std::is_move_constructible<error_type>::value)
   )
   BOOST_NOEXCEPT_IF(
@@ -1775,7 +1847,7 @@ public:
 
 
   BOOST_EXPECTED_0_REQUIRES(std::is_copy_constructible<error_type>::value)
-  expected(unexpected_type<error_type> const& e)
+  BOOST_CONSTEXPR expected(unexpected_type<error_type> const& e)
   BOOST_NOEXCEPT_IF(
     std::is_nothrow_copy_constructible<error_type>::value
   )
@@ -1783,7 +1855,7 @@ public:
   {}
 
   BOOST_EXPECTED_0_REQUIRES(std::is_move_constructible<error_type>::value)
-  expected(unexpected_type<error_type> && e
+  BOOST_CONSTEXPR expected(unexpected_type<error_type> && e
   )
   BOOST_NOEXCEPT_IF(
     std::is_nothrow_move_constructible<error_type>::value
@@ -1794,7 +1866,7 @@ public:
   template <class Err
   , BOOST_EXPECTED_T_REQUIRES(std::is_constructible<error_type, Err>::value)
   >
-  expected(unexpected_type<Err> const& e
+  BOOST_CONSTEXPR expected(unexpected_type<Err> const& e
   )
   BOOST_NOEXCEPT_IF((
     std::is_nothrow_constructible<error_type, Err>::value
@@ -1803,7 +1875,7 @@ public:
   {}
 
   template <class Err>
-  expected(unexpected_type<Err> && e
+  BOOST_CONSTEXPR expected(unexpected_type<Err> && e
 //    , BOOST_EXPECTED_REQUIRES(std::is_copy_constructible<error_type, Err&&>::value)
   )
 //  BOOST_NOEXCEPT_IF(
@@ -1817,7 +1889,7 @@ public:
   , BOOST_EXPECTED_T_REQUIRES(std::is_constructible<error_type, Args&...>::value)
 #endif
   >
-  expected(unexpect_t, Args&&... args
+  BOOST_CONSTEXPR expected(unexpect_t, Args&&... args
   )
   BOOST_NOEXCEPT_IF(
       std::is_nothrow_copy_constructible<error_type>::value
@@ -1825,6 +1897,14 @@ public:
   : base_type(unexpected_type<error_type>(error_type(std::forward<Args>(args)...)))
   {}
 
+  // Used by coroutine.hpp, see expected<T, E>.
+  template <class Return>
+  expected(expected_detail::coroutine_return_t, Return& r)
+  : base_type(unexpected_type<error_type>(error_type()))
+  {
+    r.bind(*this);
+  }
+
   ~expected() = default;
 
   // Assignments
@@ -1854,7 +1934,8 @@ public:
       if (! rhs.valid())
       {
         error_type t = std::move(rhs.contained_err());
-        ::new (errorptr()) error_type(t);
+        rhs.contained_err().~error_type();
+        ::new (errorptr()) error_type(std::move(t));
         std::swap(contained_has_value(), rhs.contained_has_value());
       }
     }
@@ -1946,7 +2027,7 @@ public:
 #endif
 
   template <typename F>
-  typename rebind<void>::type
+  BOOST_EXPECTED_CATCH_ALL_CONSTEXPR typename rebind<void>::type
   catch_all_void_void(F&& f)
   {
     typedef typename rebind<void>::type result_type;
@@ -1962,7 +2043,7 @@ public:
 #endif
   }
   template <typename F>
-  typename std::result_of<F()>::type
+  BOOST_EXPECTED_CATCH_ALL_CONSTEXPR typename std::result_of<F()>::type
   catch_all_void_type(F&& f)
   {
 #if defined BOOST_EXPECTED_CATCH_EXCEPTIONS
@@ -1977,7 +2058,7 @@ public:
 #endif
   }
   template <typename F>
-  typename rebind<typename std::result_of<F()>::type>::type
+  BOOST_EXPECTED_CATCH_ALL_CONSTEXPR typename rebind<typename std::result_of<F()>::type>::type
   catch_all_void_etype(F&& f)
   {
 #if defined BOOST_EXPECTED_CATCH_EXCEPTIONS
@@ -2027,7 +2108,7 @@ public:
 //  }
 
   template <typename F>
-  typename rebind<void>::type
+  BOOST_EXPECTED_CXX14_CONSTEXPR typename rebind<void>::type
   map(F&& f,
     BOOST_EXPECTED_REQUIRES(std::is_same<typename std::result_of<F(value_type)>::type, void>::value))
   {
@@ -2047,7 +2128,7 @@ public:
   }
 
   template <typename F>
-  typename rebind<typename std::result_of<F(value_type)>::type>::type
+  BOOST_EXPECTED_CXX14_CONSTEXPR typename rebind<typename std::result_of<F(value_type)>::type>::type
   map(F&& f,
     BOOST_EXPECTED_REQUIRES(!std::is_same<typename std::result_of<F(value_type)>::type, void>::value))
   {
@@ -2111,7 +2192,7 @@ public:
 //  }
 
   template <typename F>
-  typename std::result_of<F()>::type
+  BOOST_EXPECTED_CXX14_CONSTEXPR typename std::result_of<F()>::type
   bind(F&& f,
     BOOST_EXPECTED_REQUIRES( boost::is_expected<typename std::result_of<F(value_type)>::type>::value
         ) )
@@ -2132,7 +2213,7 @@ public:
   }
 
   template <typename F>
-  typename rebind<void>::type
+  BOOST_EXPECTED_CXX14_CONSTEXPR typename rebind<void>::type
   then(F&& f,
     BOOST_EXPECTED_REQUIRES(std::is_same<typename std::result_of<F(expected)>::type, void>::value))
   {
@@ -2147,7 +2228,7 @@ public:
 
   // then factory
   template <typename F>
-  typename rebind<typename std::result_of<F(expected)>::type>::type
+  BOOST_EXPECTED_CXX14_CONSTEXPR typename rebind<typename std::result_of<F(expected)>::type>::type
   then(F&& f,
     BOOST_EXPECTED_REQUIRES(!boost::is_expected<typename std::result_of<F(expected)>::type>::value
         ))
@@ -2157,7 +2238,7 @@ public:
   }
 
   template <typename F>
-  typename std::result_of<F(expected)>::type
+  BOOST_EXPECTED_CXX14_CONSTEXPR typename std::result_of<F(expected)>::type
   then(F&& f,
     BOOST_EXPECTED_REQUIRES(!std::is_same<typename std::result_of<F(expected)>::type, void>::value
         && boost::is_expected<typename std::result_of<F(expected)>::type>::value
@@ -2170,7 +2251,7 @@ public:
   // catch_error factory
 
   template <typename F>
-  this_type catch_error(F&& f,
+  BOOST_EXPECTED_CXX14_CONSTEXPR this_type catch_error(F&& f,
     BOOST_EXPECTED_REQUIRES(std::is_same<typename std::result_of<F(error_type)>::type, value_type>::value))
   {
 #if ! defined BOOST_NO_CXX14_CONSTEXPR
@@ -2188,7 +2269,7 @@ public:
     }
 
   template <typename F>
-  this_type catch_error(F&& f,
+  BOOST_EXPECTED_CXX14_CONSTEXPR this_type catch_error(F&& f,
       BOOST_EXPECTED_REQUIRES(! std::is_same<typename std::result_of<F(error_type)>::type, value_type>::value))
   {
 #if ! defined BOOST_NO_CXX14_CONSTEXPR
@@ -2262,6 +2343,371 @@ public:
   }
 };
 
+namespace expected_detail
+{
+  // f(r), or the member of r that f points to.
+  template <class F, class T>
+  BOOST_CONSTEXPR auto invoke(F&& f, T& r) -> decltype(std::forward<F>(f)(r))
+  {
+    return std::forward<F>(f)(r);
+  }
+
+  template <class M, class C, class T>
+  BOOST_CONSTEXPR auto invoke(M C::* pm, T& r) -> decltype((r.*pm))
+  {
+    return r.*pm;
+  }
+
+  template <class M, class C, class T>
+  BOOST_CONSTEXPR auto invoke(M C::* pm, T& r) -> decltype((r.*pm)())
+  {
+    return (r.*pm)();
+  }
+
+  // The storage of expected<T&, E>: a pointer and an error. When E is empty
+  // it is an empty base and a null pointer tells the error, so that the
+  // whole is as large as a pointer.
+  template <class T, class E, bool = std::is_empty<E>::value
+      && ! boost::is_final<E>::value
+      && std::is_nothrow_default_constructible<E>::value>
+  class reference_storage
+  {
+    expected<T*, E> e;
+
+  public:
+    BOOST_CONSTEXPR reference_storage(T* p) BOOST_NOEXCEPT : e(p) {}
+    template <class Err>
+    BOOST_CONSTEXPR reference_storage(unexpected_type<Err> const& u) : e(u) {}
+    BOOST_CONSTEXPR reference_storage(unexpected_type<E>&& u) : e(constexpr_move(u)) {}
+
+    BOOST_CONSTEXPR bool valid() const BOOST_NOEXCEPT { return e.valid(); }
+    BOOST_CONSTEXPR T* ptr() const BOOST_NOEXCEPT { return *e; }
+    BOOST_CONSTEXPR E const& err() const BOOST_NOEXCEPT { return e.error(); }
+    BOOST_EXPECTED_CXX14_CONSTEXPR E& err() BOOST_NOEXCEPT { return e.error(); }
+
+    void swap(reference_storage& rhs) { e.swap(rhs.e); }
+  };
+
+  template <class T, class E>
+  class reference_storage<T, E, true> : private E
+  {
+    T* p;
+
+  public:
+    BOOST_CONSTEXPR reference_storage(T* r) BOOST_NOEXCEPT : E(), p(r) {}
+    BOOST_CONSTEXPR reference_storage(unexpected_type<E> const& u) : E(u.value()), p(nullptr) {}
+    template <class Err>
+    reference_storage(unexpected_type<Err> const& u)
+    : E(error_traits<E>::make_error(u.value())), p(nullptr) {}
+
+    BOOST_CONSTEXPR bool valid() const BOOST_NOEXCEPT { return p != nullptr; }
+    BOOST_CONSTEXPR T* ptr() const BOOST_NOEXCEPT { return p; }
+    BOOST_CONSTEXPR E const& err() const BOOST_NOEXCEPT { return *this; }
+    BOOST_EXPECTED_CXX14_CONSTEXPR E& err() BOOST_NOEXCEPT { return *this; }
+
+    void swap(reference_storage& rhs) { std::swap(p, rhs.p); }
+  };
+}
+
+// expected<T&, E> refers to a T it does not own, or holds an error. T may be
+// const. It is rebound by assignment, never assigned through, and map, bind
+// and then pass the T& itself to the function, so that a lookup returns no
+// copy. map takes a pointer to member as well, which projects the reference
+// into a reference to the member.
+template <typename T, typename ErrorType>
+class expected<T&, ErrorType>
+{
+public:
+  typedef T& value_type;
+  typedef ErrorType error_type;
+  using errored_type = boost::unexpected_type<error_type>;
+
+private:
+  typedef expected<T&, error_type> this_type;
+  typedef expected_detail::reference_storage<T, error_type> storage_type;
+
+  template <class U, class E>
+  friend class expected;
+
+  // Static asserts.
+  typedef boost::is_unexpected<error_type> is_unexpected_error_t;
+  BOOST_STATIC_ASSERT_MSG( !is_unexpected_error_t::value, "bad ErrorType" );
+  typedef std::is_same<error_type, in_place_t> is_same_error_in_place_t;
+  BOOST_STATIC_ASSERT_MSG( !is_same_error_in_place_t::value, "bad ErrorType" );
+  typedef std::is_same<error_type, unexpect_t> is_same_error_unexpect_t;
+  BOOST_STATIC_ASSERT_MSG( !is_same_error_unexpect_t::value, "bad ErrorType" );
+  typedef std::is_same<error_type, expect_t> is_same_error_expect_t;
+  BOOST_STATIC_ASSERT_MSG( !is_same_error_expect_t::value, "bad ErrorType" );
+
+  storage_type storage;
+
+public:
+
+  // Using a template alias here causes an ICE in VS2013 and VS14 CTP 3
+  // so back to the old fashioned way
+  template <class U>
+  struct rebind
+  {
+    typedef expected<U, error_type> type;
+  };
+
+  using type_constructor = expected<holder, error_type>;
+
+  // Constructors/Destructors/Assignments
+
+  BOOST_CONSTEXPR expected(T& r) BOOST_NOEXCEPT
+  : storage(detail::static_addressof(r))
+  {}
+
+  // The temporary would be gone before the expected.
+  expected(typename std::remove_const<T>::type&&) = delete;
+
+  template <class U
+    , BOOST_EXPECTED_T_REQUIRES(std::is_convertible<U*, T*>::value && ! std::is_same<U, T>::value)
+  >
+  BOOST_CONSTEXPR expected(expected<U&, error_type> const& rhs)
+  : storage(rhs.valid()
+      ? storage_type(rhs.storage.ptr())
+      : storage_type(rhs.get_unexpected()))
+  {}
+
+  BOOST_CONSTEXPR expected(unexpected_type<error_type> const& e)
+  : storage(e)
+  {}
+
+  BOOST_CONSTEXPR expected(unexpected_type<error_type>&& e)
+  : storage(constexpr_move(e))
+  {}
+
+  template <class Err
+    , BOOST_EXPECTED_T_REQUIRES(std::is_constructible<error_type, Err>::value)
+  >
+  BOOST_CONSTEXPR expected(unexpected_type<Err> const& e)
+  : storage(e)
+  {}
+
+  template <class... Args
+    , BOOST_EXPECTED_T_REQUIRES(std::is_constructible<error_type, Args&...>::value)
+  >
+  BOOST_CONSTEXPR expected(unexpect_t, Args&&... args)
+  : storage(unexpected_type<error_type>(error_type(std::forward<Args>(args)...)))
+  {}
+
+  void emplace(T& r) BOOST_NOEXCEPT
+  {
+    this_type(r).swap(*this);
+  }
+
+  // Modifiers
+  void swap(expected& rhs)
+  {
+    storage.swap(rhs.storage);
+  }
+
+  // Observers
+  BOOST_CONSTEXPR bool valid() const BOOST_NOEXCEPT
+  {
+    return storage.valid();
+  }
+
+#if ! defined(BOOST_NO_CXX11_EXPLICIT_CONVERSION_OPERATORS)
+  BOOST_CONSTEXPR bool operator !() const BOOST_NOEXCEPT
+  {
+    return !valid();
+  }
+  BOOST_CONSTEXPR explicit operator bool() const BOOST_NOEXCEPT
+  {
+    return valid();
+  }
+#endif
+
+  BOOST_CONSTEXPR T& value() const
+  {
+    return valid()
+      ? *storage.ptr()
+      : (
+          error_traits<error_type>::rethrow(storage.err()),
+          *storage.ptr()
+        )
+      ;
+  }
+
+  BOOST_CONSTEXPR T& operator*() const BOOST_NOEXCEPT
+  {
+    return *storage.ptr();
+  }
+
+  BOOST_CONSTEXPR T* operator->() const BOOST_NOEXCEPT
+  {
+    return storage.ptr();
+  }
+
+#if ! defined BOOST_EXPECTED_NO_CXX11_RVALUE_REFERENCE_FOR_THIS
+  BOOST_CONSTEXPR error_type const& error() const& BOOST_NOEXCEPT
+  {
+    return storage.err();
+  }
+  BOOST_EXPECTED_CONSTEXPR_IF_MOVE_ACCESSORS error_type& error() & BOOST_NOEXCEPT
+  {
+    return storage.err();
+  }
+  BOOST_EXPECTED_CONSTEXPR_IF_MOVE_ACCESSORS error_type&& error() && BOOST_NOEXCEPT
+  {
+    return constexpr_move(storage.err());
+  }
+
+  BOOST_CONSTEXPR unexpected_type<error_type> get_unexpected() const& BOOST_NOEXCEPT
+  {
+    return unexpected_type<error_type>(storage.err());
+  }
+  BOOST_EXPECTED_CONSTEXPR_IF_MOVE_ACCESSORS unexpected_type<error_type> get_unexpected() && BOOST_NOEXCEPT
+  {
+    return unexpected_type<error_type>(constexpr_move(storage.err()));
+  }
+#else
+  BOOST_CONSTEXPR error_type const& error() const BOOST_NOEXCEPT
+  {
+    return storage.err();
+  }
+  error_type& error() BOOST_NOEXCEPT
+  {
+    return storage.err();
+  }
+
+  BOOST_CONSTEXPR unexpected_type<error_type> get_unexpected() const BOOST_NOEXCEPT
+  {
+    return unexpected_type<error_type>(storage.err());
+  }
+#endif
+
+  // Utilities
+
+  // An lvalue fallback is referred to, anything else is converted to a copy.
+  template <class V
+    , BOOST_EXPECTED_T_REQUIRES(std::is_convertible<V*, T*>::value)
+  >
+  BOOST_CONSTEXPR T& value_or(V& v) const BOOST_NOEXCEPT
+  {
+    return valid() ? *storage.ptr() : v;
+  }
+
+  template <class V
+    , BOOST_EXPECTED_T_REQUIRES(! std::is_lvalue_reference<V>::value
+        || ! std::is_convertible<typename std::remove_reference<V>::type*, T*>::value)
+  >
+  BOOST_CONSTEXPR typename std::remove_const<T>::type value_or(V&& v) const
+  {
+    return valid()
+      ? *storage.ptr()
+      : static_cast<typename std::remove_const<T>::type>(constexpr_forward<V>(v));
+  }
+
+  template <class Exception>
+  BOOST_CONSTEXPR T& value_or_throw() const
+  {
+    return valid()
+      ? *storage.ptr()
+      : throw Exception(storage.err());
+  }
+
+  template <typename F
+    , class FR = decltype(expected_detail::invoke(std::declval<F>(), std::declval<T&>()))
+  >
+  BOOST_EXPECTED_CATCH_ALL_CONSTEXPR typename rebind<void>::type
+  map(F&& f,
+    BOOST_EXPECTED_REQUIRES(std::is_same<FR, void>::value)) const
+  {
+    typedef typename rebind<void>::type result_type;
+    if (! valid())
+      return get_unexpected();
+#if defined BOOST_EXPECTED_CATCH_EXCEPTIONS
+    try {
+#endif
+      expected_detail::invoke(std::forward<F>(f), *storage.ptr());
+      return result_type(in_place_t{});
+#if defined BOOST_EXPECTED_CATCH_EXCEPTIONS
+    } catch (...) {
+      return make_unexpected(error_traits<error_type>::make_error_from_current_exception());
+    }
+#endif
+  }
+
+  template <typename F
+    , class FR = decltype(expected_detail::invoke(std::declval<F>(), std::declval<T&>()))
+  >
+  BOOST_EXPECTED_CATCH_ALL_CONSTEXPR typename rebind<FR>::type
+  map(F&& f,
+    BOOST_EXPECTED_REQUIRES(! std::is_same<FR, void>::value)) const
+  {
+    typedef typename rebind<FR>::type result_type;
+    if (! valid())
+      return get_unexpected();
+#if defined BOOST_EXPECTED_CATCH_EXCEPTIONS
+    try {
+#endif
+      return result_type(expected_detail::invoke(std::forward<F>(f), *storage.ptr()));
+#if defined BOOST_EXPECTED_CATCH_EXCEPTIONS
+    } catch (...) {
+      return make_unexpected(error_traits<error_type>::make_error_from_current_exception());
+    }
+#endif
+  }
+
+  template <typename F
+    , class FR = decltype(expected_detail::invoke(std::declval<F>(), std::declval<T&>()))
+  >
+  BOOST_EXPECTED_CATCH_ALL_CONSTEXPR FR
+  bind(F&& f,
+    BOOST_EXPECTED_REQUIRES(boost::is_expected<FR>::value)) const
+  {
+    if (! valid())
+      return get_unexpected();
+#if defined BOOST_EXPECTED_CATCH_EXCEPTIONS
+    try {
+#endif
+      return expected_detail::invoke(std::forward<F>(f), *storage.ptr());
+#if defined BOOST_EXPECTED_CATCH_EXCEPTIONS
+    } catch (...) {
+      return make_unexpected(error_traits<error_type>::make_error_from_current_exception());
+    }
+#endif
+  }
+
+  template <typename F>
+  BOOST_EXPECTED_CXX14_CONSTEXPR typename rebind<typename std::result_of<F(expected)>::type>::type
+  then(F&& f,
+    BOOST_EXPECTED_REQUIRES(! boost::is_expected<typename std::result_of<F(expected)>::type>::value)) const
+  {
+    typedef typename rebind<typename std::result_of<F(expected)>::type>::type result_type;
+    return result_type(f(*this));
+  }
+
+  template <typename F>
+  BOOST_EXPECTED_CXX14_CONSTEXPR typename std::result_of<F(expected)>::type
+  then(F&& f,
+    BOOST_EXPECTED_REQUIRES(boost::is_expected<typename std::result_of<F(expected)>::type>::value)) const
+  {
+    return f(*this);
+  }
+
+  template <typename F>
+  BOOST_EXPECTED_CXX14_CONSTEXPR this_type
+  catch_error(F&& f,
+    BOOST_EXPECTED_REQUIRES(std::is_same<typename std::result_of<F(error_type)>::type, value_type>::value)) const
+  {
+    return valid() ? *this : this_type(f(storage.err()));
+  }
+
+  template <typename F>
+  BOOST_EXPECTED_CXX14_CONSTEXPR this_type
+  catch_error(F&& f,
+    BOOST_EXPECTED_REQUIRES(std::is_same<typename std::result_of<F(error_type)>::type, this_type>::value
+        || std::is_same<typename std::result_of<F(error_type)>::type, unexpected_type<error_type>>::value)) const
+  {
+    return valid() ? *this : this_type(f(storage.err()));
+  }
+};
+
 // Relational operators
 template <class T, class E>
 BOOST_CONSTEXPR bool operator==(const expected<T,E>& x, const expected<T,E>& y)
@@ -2390,6 +2836,30 @@ BOOST_CONSTEXPR bool operator>=(const T& v, const expected<T,E>& x)
   return ! (v < x);
 }
 
+// T is deduced from the expected only, as a value of a reference type is
+// not a reference.
+template <class T, class E>
+BOOST_CONSTEXPR bool operator==(const expected<T&,E>& x, const typename std::remove_const<T>::type& v)
+{
+  return (x) ? *x == v : false;
+}
+template <class T, class E>
+BOOST_CONSTEXPR bool operator==(const typename std::remove_const<T>::type& v, const expected<T&,E>& x)
+{
+  return x == v;
+}
+
+template <class T, class E>
+BOOST_CONSTEXPR bool operator!=(const expected<T&,E>& x, const typename std::remove_const<T>::type& v)
+{
+  return ! (x == v);
+}
+template <class T, class E>
+BOOST_CONSTEXPR bool operator!=(const typename std::remove_const<T>::type& v, const expected<T&,E>& x)
+{
+  return ! (x == v);
+}
+
 // Relational operators with unexpected_type<E>
 template <class T, class E>
 BOOST_CONSTEXPR bool operator==(const expected<T,E>& x, const unexpected_type<E>& e)
@@ -0,0 +1,111 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_EXPECTED_BUFFER_HPP
+#define BOOST_EXPECTED_EXPECTED_BUFFER_HPP
+
+#include <boost/expected/expected.hpp>
+#include <boost/assert.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace boost
+{
+  // A sequence of expected<T, E> stored as a structure of arrays: a validity
+  // mask, a value array and an error array. The value of an invalid element
+  // and the error of a valid one are unspecified but always constructed, so
+  // lanes can be processed without looking at the mask.
+  template <class T, class E = std::exception_ptr>
+  class expected_buffer
+  {
+  public:
+    typedef T value_type;
+    typedef E error_type;
+    typedef unsigned char mask_type;
+    typedef std::size_t size_type;
+
+    expected_buffer() {}
+
+    // n valid value-initialized elements.
+    explicit expected_buffer(size_type n) :
+      valid_(n, 1), values_(n), errors_(n)
+    {
+    }
+
+    template <class InputIterator>
+    expected_buffer(InputIterator first, InputIterator last)
+    {
+      for (; first != last; ++first)
+        push_back(*first);
+    }
+
+    size_type size() const BOOST_NOEXCEPT { return valid_.size(); }
+    bool empty() const BOOST_NOEXCEPT { return valid_.empty(); }
+
+    void resize(size_type n)
+    {
+      valid_.resize(n, 1);
+      values_.resize(n);
+      errors_.resize(n);
+    }
+
+    void reserve(size_type n)
+    {
+      valid_.reserve(n);
+      values_.reserve(n);
+      errors_.reserve(n);
+    }
+
+    void push_back(expected<T, E> const& x)
+    {
+      valid_.push_back(x.valid());
+      values_.push_back(x.valid() ? *x : T());
+      errors_.push_back(x.valid() ? E() : x.error());
+    }
+
+    expected<T, E> operator[](size_type i) const
+    {
+      BOOST_ASSERT(i < size());
+      if (valid_[i])
+        return values_[i];
+      return make_unexpected(errors_[i]);
+    }
+
+    void set_value(size_type i, T const& v)
+    {
+      BOOST_ASSERT(i < size());
+      valid_[i] = 1;
+      values_[i] = v;
+    }
+
+    void set_error(size_type i, E const& e)
+    {
+      BOOST_ASSERT(i < size());
+      valid_[i] = 0;
+      errors_[i] = e;
+    }
+
+    bool valid(size_type i) const { return valid_[i] != 0; }
+    T const& value(size_type i) const { return values_[i]; }
+    E const& error(size_type i) const { return errors_[i]; }
+
+    // Direct access to the arrays, mask lanes are 0 or 1.
+    mask_type* mask_data() BOOST_NOEXCEPT { return valid_.data(); }
+    mask_type const* mask_data() const BOOST_NOEXCEPT { return valid_.data(); }
+    T* value_data() BOOST_NOEXCEPT { return values_.data(); }
+    T const* value_data() const BOOST_NOEXCEPT { return values_.data(); }
+    E* error_data() BOOST_NOEXCEPT { return errors_.data(); }
+    E const* error_data() const BOOST_NOEXCEPT { return errors_.data(); }
+
+  private:
+    std::vector<mask_type> valid_;
+    std::vector<T> values_;
+    std::vector<E> errors_;
+  };
+
+} // namespace boost
+
+#endif // BOOST_EXPECTED_EXPECTED_BUFFER_HPP
@@ -0,0 +1,658 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_EXPECTED_CHANNEL_HPP
+#define BOOST_EXPECTED_EXPECTED_CHANNEL_HPP
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/detail/atomic_wait.hpp>
+#include <boost/expected/detail/cache_line.hpp>
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Bounded channels of expected<T, E> between threads. The elements are
+// stored in place in a ring of slots.
+//
+// Pushing an invalid expected (or an unexpected_type) closes the channel:
+// the error is queued after the values pushed before it, and any later push
+// fails with channel_op_status::closed. Once the consumers reach it, every
+// pop gives a copy of the error with channel_op_status::closed, so all of
+// them see why the channel was closed.
+
+namespace boost
+{
+  enum class channel_op_status { success, empty, full, closed };
+
+namespace expected_detail
+{
+  inline std::size_t channel_capacity(std::size_t n)
+  {
+    BOOST_ASSERT(n > 0);
+    std::size_t c = 1;
+    while (c < n)
+      c <<= 1;
+    return c;
+  }
+
+  template <class T, class E>
+  bool is_error(expected<T, E> const& x) BOOST_NOEXCEPT
+  {
+    return ! x.valid();
+  }
+
+  template <class E>
+  bool is_error(unexpected_type<E> const&) BOOST_NOEXCEPT
+  {
+    return true;
+  }
+
+  template <class T>
+  bool is_error(T const&) BOOST_NOEXCEPT
+  {
+    return false;
+  }
+} // namespace expected_detail
+
+  // Single producer, single consumer channel.
+  // Each side publishes its position with a single store and keeps a cached
+  // copy of the other side position, so the cache line of the other side is
+  // only read when the cached copy says the ring is full or empty.
+  template <class T, class E = std::exception_ptr>
+  class spsc_expected_channel
+  {
+  public:
+    typedef expected<T, E> value_type;
+
+    // The capacity is rounded up to a power of 2.
+    explicit spsc_expected_channel(std::size_t capacity) :
+      mask_(expected_detail::channel_capacity(capacity) - 1),
+      slots_(new storage_type[mask_ + 1]),
+      tail_(0), head_cache_(0), closed_(false),
+      head_(0), tail_cache_(0)
+    {
+    }
+
+    spsc_expected_channel(spsc_expected_channel const&) = delete;
+    spsc_expected_channel& operator=(spsc_expected_channel const&) = delete;
+
+    ~spsc_expected_channel()
+    {
+      std::size_t const tail = tail_.load(std::memory_order_relaxed);
+      for (std::size_t i = head_.load(std::memory_order_relaxed); i != tail; ++i)
+        slot(i).~value_type();
+    }
+
+    std::size_t capacity() const BOOST_NOEXCEPT
+    {
+      return mask_ + 1;
+    }
+
+    // Producer side.
+
+    channel_op_status try_push(value_type const& x)
+    {
+      return try_emplace(x);
+    }
+
+    channel_op_status try_push(value_type&& x)
+    {
+      return try_emplace(std::move(x));
+    }
+
+    // Pushes the first elements of [first, first + n) that fit, up to and
+    // including the first error, with a single publication.
+    // Returns the number of elements pushed.
+    template <class InputIterator>
+    std::size_t try_push_n(InputIterator first, std::size_t n)
+    {
+      if (closed_)
+        return 0;
+      std::size_t const tail = tail_.load(std::memory_order_relaxed);
+      std::size_t const k = (std::min)(n, free_slots(tail, n));
+      std::size_t i = 0;
+      try
+      {
+        while (i < k)
+        {
+          value_type* p = ::new (address(tail + i)) value_type(*first);
+          ++i;
+          ++first;
+          if (! p->valid())
+          {
+            closed_ = true;
+            break;
+          }
+        }
+      }
+      catch (...)
+      {
+        publish_tail(tail + i);
+        throw;
+      }
+      if (i != 0)
+        publish_tail(tail + i);
+      return i;
+    }
+
+    // Waits while the channel is full.
+    channel_op_status push(value_type const& x)
+    {
+      return wait_push(x);
+    }
+
+    channel_op_status push(value_type&& x)
+    {
+      return wait_push(std::move(x));
+    }
+
+    // Consumer side.
+
+    // Moves the next value to out, or copies the error that closed the
+    // channel.
+    channel_op_status try_pop(value_type& out)
+    {
+      std::size_t const head = head_.load(std::memory_order_relaxed);
+      if (head == tail_cache_)
+      {
+        tail_cache_ = tail_.load(std::memory_order_acquire);
+        if (head == tail_cache_)
+          return channel_op_status::empty;
+      }
+      value_type& x = slot(head);
+      if (! x.valid())
+      {
+        out = x;
+        return channel_op_status::closed;
+      }
+      out = std::move(x);
+      x.~value_type();
+      publish_head(head + 1);
+      return channel_op_status::success;
+    }
+
+    // Moves up to n values to out with a single publication, stopping before
+    // the error that closed the channel. Returns the number of values popped.
+    template <class OutputIterator>
+    std::size_t try_pop_n(OutputIterator out, std::size_t n)
+    {
+      std::size_t const head = head_.load(std::memory_order_relaxed);
+      if (tail_cache_ - head < n)
+        tail_cache_ = tail_.load(std::memory_order_acquire);
+      std::size_t const k = (std::min)(n, tail_cache_ - head);
+      std::size_t i = 0;
+      try
+      {
+        for (; i < k; ++i)
+        {
+          value_type& x = slot(head + i);
+          if (! x.valid())
+            break;
+          *out = std::move(x);
+          ++out;
+          x.~value_type();
+        }
+      }
+      catch (...)
+      {
+        publish_head(head + i);
+        throw;
+      }
+      if (i != 0)
+        publish_head(head + i);
+      return i;
+    }
+
+    // Waits while the channel is empty.
+    channel_op_status pop(value_type& out)
+    {
+      for (;;)
+      {
+        std::size_t const tail = tail_.load(std::memory_order_acquire);
+        channel_op_status const s = try_pop(out);
+        if (s != channel_op_status::empty)
+          return s;
+        expected_detail::atomic_wait(tail_, tail);
+      }
+    }
+
+  private:
+    typedef typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type storage_type;
+
+    void* address(std::size_t i) BOOST_NOEXCEPT
+    {
+      return &slots_[i & mask_];
+    }
+
+    value_type& slot(std::size_t i) BOOST_NOEXCEPT
+    {
+      return *reinterpret_cast<value_type*>(address(i));
+    }
+
+    std::size_t free_slots(std::size_t tail, std::size_t wanted)
+    {
+      if (tail - head_cache_ + wanted > capacity())
+        head_cache_ = head_.load(std::memory_order_acquire);
+      return capacity() - (tail - head_cache_);
+    }
+
+    template <class X>
+    channel_op_status try_emplace(X&& x)
+    {
+      if (closed_)
+        return channel_op_status::closed;
+      std::size_t const tail = tail_.load(std::memory_order_relaxed);
+      if (free_slots(tail, 1) == 0)
+        return channel_op_status::full;
+      value_type* p = ::new (address(tail)) value_type(std::forward<X>(x));
+      closed_ = ! p->valid();
+      publish_tail(tail + 1);
+      return channel_op_status::success;
+    }
+
+    template <class X>
+    channel_op_status wait_push(X&& x)
+    {
+      for (;;)
+      {
+        std::size_t const head = head_.load(std::memory_order_acquire);
+        channel_op_status const s = try_emplace(std::forward<X>(x));
+        if (s != channel_op_status::full)
+          return s;
+        expected_detail::atomic_wait(head_, head);
+      }
+    }
+
+    void publish_tail(std::size_t tail) BOOST_NOEXCEPT
+    {
+      tail_.store(tail, std::memory_order_release);
+      expected_detail::atomic_notify_one(tail_);
+    }
+
+    void publish_head(std::size_t head) BOOST_NOEXCEPT
+    {
+      head_.store(head, std::memory_order_release);
+      expected_detail::atomic_notify_one(head_);
+    }
+
+    // The padding keeps the data written by each side on its own cache
+    // lines. It is used instead of alignas so the channel can be allocated
+    // with new before C++17.
+    // read only
+    std::size_t const mask_;
+    std::unique_ptr<storage_type[]> const slots_;
+    char pad0_[expected_detail::cache_line_size];
+    // producer
+    std::atomic<std::size_t> tail_;
+    char pad1_[expected_detail::cache_line_size];
+    std::size_t head_cache_;
+    bool closed_;
+    char pad2_[expected_detail::cache_line_size];
+    // consumer
+    std::atomic<std::size_t> head_;
+    char pad3_[expected_detail::cache_line_size];
+    std::size_t tail_cache_;
+    char pad4_[expected_detail::cache_line_size];
+  };
+
+  // Multiple producers, multiple consumers channel.
+  // Each slot has a sequence number telling whether it is free or full for
+  // the current lap, so producers and consumers only contend on their own
+  // position, which they advance with a CAS (D. Vyukov's bounded queue).
+  // The closed flag is the low bit of the push position, so that a push
+  // can not take a slot after the one of the error.
+  // value_type must be nothrow move constructible, as a slot that was taken
+  // must be filled.
+  template <class T, class E = std::exception_ptr>
+  class mpmc_expected_channel
+  {
+  public:
+    typedef expected<T, E> value_type;
+
+    static_assert(std::is_nothrow_move_constructible<value_type>::value,
+        "mpmc_expected_channel requires a nothrow move constructible expected<T, E>");
+
+    // The capacity is rounded up to a power of 2.
+    explicit mpmc_expected_channel(std::size_t capacity) :
+      mask_(expected_detail::channel_capacity(capacity) - 1),
+      cells_(new cell[mask_ + 1]),
+      closed_at_(none), waiters_(0),
+      push_pos_(0), pop_pos_(0),
+      push_epoch_(0), pop_epoch_(0)
+    {
+      for (std::size_t i = 0; i <= mask_; ++i)
+        cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    mpmc_expected_channel(mpmc_expected_channel const&) = delete;
+    mpmc_expected_channel& operator=(mpmc_expected_channel const&) = delete;
+
+    ~mpmc_expected_channel()
+    {
+      std::size_t const end = push_pos_.load(std::memory_order_relaxed) >> 1;
+      for (std::size_t i = pop_pos_.load(std::memory_order_relaxed); i != end; ++i)
+        slot(cells_[i & mask_]).~value_type();
+    }
+
+    std::size_t capacity() const BOOST_NOEXCEPT
+    {
+      return mask_ + 1;
+    }
+
+    // Producer side.
+
+    channel_op_status try_push(value_type const& x)
+    {
+      value_type tmp(x);
+      return try_push(std::move(tmp));
+    }
+
+    // x is only moved from on success.
+    channel_op_status try_push(value_type&& x)
+    {
+      bool const close = ! x.valid();
+      std::size_t v = push_pos_.load(std::memory_order_relaxed);
+      for (;;)
+      {
+        if (v & 1)
+          return channel_op_status::closed;
+        std::size_t const pos = v >> 1;
+        cell& c = cells_[pos & mask_];
+        std::ptrdiff_t const dif = std::ptrdiff_t(c.seq.load(std::memory_order_acquire) - pos);
+        if (dif == 0)
+        {
+          if (push_pos_.compare_exchange_weak(v, ((pos + 1) << 1) | close, std::memory_order_relaxed))
+          {
+            if (close)
+              closed_at_.store(pos, std::memory_order_relaxed);
+            ::new (&c.storage) value_type(std::move(x));
+            c.seq.store(pos + 1, std::memory_order_release);
+            wake(push_epoch_);
+            return channel_op_status::success;
+          }
+        }
+        else if (dif < 0)
+          return channel_op_status::full;
+        else
+          v = push_pos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    // Pushes the first elements of [first, first + n) that fit, up to and
+    // including the first error. When value_type can be built from the
+    // elements without throwing, the slots are taken with a single CAS.
+    // Returns the number of elements pushed.
+    template <class ForwardIterator>
+    std::size_t try_push_n(ForwardIterator first, std::size_t n)
+    {
+      typedef typename std::iterator_traits<ForwardIterator>::reference reference;
+      return push_n(first, n, std::integral_constant<bool,
+          std::is_nothrow_constructible<value_type, reference>::value>());
+    }
+
+    // Waits while the channel is full.
+    channel_op_status push(value_type const& x)
+    {
+      value_type tmp(x);
+      return push(std::move(tmp));
+    }
+
+    channel_op_status push(value_type&& x)
+    {
+      channel_op_status s = try_push(std::move(x));
+      if (s != channel_op_status::full)
+        return s;
+      waiters_.fetch_add(1, std::memory_order_seq_cst);
+      for (;;)
+      {
+        unsigned const epoch = pop_epoch_.load(std::memory_order_seq_cst);
+        s = try_push(std::move(x));
+        if (s != channel_op_status::full)
+          break;
+        expected_detail::atomic_wait(pop_epoch_, epoch);
+      }
+      waiters_.fetch_sub(1, std::memory_order_relaxed);
+      return s;
+    }
+
+    // Consumer side.
+
+    // Moves the next value to out, or copies the error that closed the
+    // channel.
+    channel_op_status try_pop(value_type& out)
+    {
+      std::size_t pos = pop_pos_.load(std::memory_order_relaxed);
+      for (;;)
+      {
+        cell& c = cells_[pos & mask_];
+        std::ptrdiff_t const dif = std::ptrdiff_t(c.seq.load(std::memory_order_acquire) - (pos + 1));
+        if (dif == 0)
+        {
+          // The error slot is never popped, so it can be read here.
+          if (pos == closed_at_.load(std::memory_order_relaxed))
+          {
+            out = slot(c);
+            return channel_op_status::closed;
+          }
+          if (pop_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          {
+            release_guard guard(*this, pos, 1);
+            out = std::move(slot(c));
+            return channel_op_status::success;
+          }
+        }
+        else if (dif < 0)
+          return channel_op_status::empty;
+        else
+          pos = pop_pos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    // Moves up to n values to out, taking the slots with a single CAS and
+    // stopping before the error that closed the channel.
+    // Returns the number of values popped.
+    template <class OutputIterator>
+    std::size_t try_pop_n(OutputIterator out, std::size_t n)
+    {
+      std::size_t pos = pop_pos_.load(std::memory_order_relaxed);
+      for (;;)
+      {
+        std::size_t k = 0;
+        while (k < n && cells_[(pos + k) & mask_].seq.load(std::memory_order_acquire) == pos + k + 1)
+          ++k;
+        // the acquire loads above make the position of a full error slot
+        // visible
+        std::size_t const closed_at = closed_at_.load(std::memory_order_relaxed);
+        if (closed_at - pos < k)
+          k = closed_at - pos;
+        if (k == 0)
+        {
+          std::ptrdiff_t const dif = std::ptrdiff_t(
+              cells_[pos & mask_].seq.load(std::memory_order_acquire) - (pos + 1));
+          if (dif <= 0)
+            return 0;
+          pos = pop_pos_.load(std::memory_order_relaxed);
+          continue;
+        }
+        if (pop_pos_.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed))
+        {
+          release_guard guard(*this, pos, k);
+          for (; guard.done != k; ++guard.done)
+          {
+            value_type& x = slot(cells_[(pos + guard.done) & mask_]);
+            *out = std::move(x);
+            ++out;
+            x.~value_type();
+            cells_[(pos + guard.done) & mask_].seq.store(pos + guard.done + mask_ + 1, std::memory_order_release);
+          }
+          return k;
+        }
+      }
+    }
+
+    // Waits while the channel is empty.
+    channel_op_status pop(value_type& out)
+    {
+      channel_op_status s = try_pop(out);
+      if (s != channel_op_status::empty)
+        return s;
+      waiters_.fetch_add(1, std::memory_order_seq_cst);
+      for (;;)
+      {
+        unsigned const epoch = push_epoch_.load(std::memory_order_seq_cst);
+        s = try_pop(out);
+        if (s != channel_op_status::empty)
+          break;
+        expected_detail::atomic_wait(push_epoch_, epoch);
+      }
+      waiters_.fetch_sub(1, std::memory_order_relaxed);
+      return s;
+    }
+
+  private:
+    typedef typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type storage_type;
+
+    struct cell
+    {
+      std::atomic<std::size_t> seq;
+      storage_type storage;
+    };
+
+    BOOST_STATIC_CONSTEXPR std::size_t none = (std::numeric_limits<std::size_t>::max)();
+
+    static value_type& slot(cell& c) BOOST_NOEXCEPT
+    {
+      return *reinterpret_cast<value_type*>(&c.storage);
+    }
+
+    // Destroys and frees the popped slots [pos + done, pos + k), even when
+    // moving a value out throws.
+    struct release_guard
+    {
+      mpmc_expected_channel& ch;
+      std::size_t pos;
+      std::size_t k;
+      std::size_t done;
+
+      release_guard(mpmc_expected_channel& ch, std::size_t pos, std::size_t k)
+        : ch(ch), pos(pos), k(k), done(0) {}
+
+      ~release_guard()
+      {
+        for (; done != k; ++done)
+        {
+          cell& c = ch.cells_[(pos + done) & ch.mask_];
+          slot(c).~value_type();
+          c.seq.store(pos + done + ch.mask_ + 1, std::memory_order_release);
+        }
+        ch.wake(ch.pop_epoch_);
+      }
+    };
+
+    template <class ForwardIterator>
+    std::size_t push_n(ForwardIterator first, std::size_t n, std::false_type)
+    {
+      std::size_t i = 0;
+      for (; i < n; ++i, ++first)
+      {
+        value_type tmp(*first);
+        bool const close = ! tmp.valid();
+        if (try_push(std::move(tmp)) != channel_op_status::success)
+          break;
+        if (close)
+          return i + 1;
+      }
+      return i;
+    }
+
+    template <class ForwardIterator>
+    std::size_t push_n(ForwardIterator first, std::size_t n, std::true_type)
+    {
+      std::size_t v = push_pos_.load(std::memory_order_relaxed);
+      for (;;)
+      {
+        if (v & 1)
+          return 0;
+        std::size_t const pos = v >> 1;
+        std::size_t k = 0;
+        bool close = false;
+        ForwardIterator it = first;
+        while (! close && k < n && cells_[(pos + k) & mask_].seq.load(std::memory_order_acquire) == pos + k)
+        {
+          close = expected_detail::is_error(*it);
+          ++it;
+          ++k;
+        }
+        if (k == 0)
+        {
+          std::ptrdiff_t const dif = std::ptrdiff_t(
+              cells_[pos & mask_].seq.load(std::memory_order_acquire) - pos);
+          if (dif < 0 || n == 0)
+            return 0;
+          v = push_pos_.load(std::memory_order_relaxed);
+          continue;
+        }
+        if (push_pos_.compare_exchange_weak(v, ((pos + k) << 1) | close, std::memory_order_relaxed))
+        {
+          if (close)
+            closed_at_.store(pos + k - 1, std::memory_order_relaxed);
+          for (std::size_t i = 0; i < k; ++i, ++first)
+          {
+            cell& c = cells_[(pos + i) & mask_];
+            ::new (&c.storage) value_type(*first);
+            c.seq.store(pos + i + 1, std::memory_order_release);
+          }
+          wake(push_epoch_);
+          return k;
+        }
+      }
+    }
+
+    // Wakes the threads blocked in push or pop. The fence orders the slot
+    // publication before the read of waiters_, as the waiters increment
+    // waiters_ before trying again.
+    void wake(std::atomic<unsigned>& epoch) BOOST_NOEXCEPT
+    {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (waiters_.load(std::memory_order_relaxed) != 0)
+      {
+        epoch.fetch_add(1, std::memory_order_release);
+        expected_detail::atomic_notify_all(epoch);
+      }
+    }
+
+    // padded as spsc_expected_channel
+    // read only
+    std::size_t const mask_;
+    std::unique_ptr<cell[]> const cells_;
+    char pad0_[expected_detail::cache_line_size];
+    // read mostly
+    std::atomic<std::size_t> closed_at_;
+    std::atomic<unsigned> waiters_;
+    char pad1_[expected_detail::cache_line_size];
+    // producers
+    std::atomic<std::size_t> push_pos_;
+    char pad2_[expected_detail::cache_line_size];
+    // consumers
+    std::atomic<std::size_t> pop_pos_;
+    char pad3_[expected_detail::cache_line_size];
+    // blocked threads
+    std::atomic<unsigned> push_epoch_;
+    char pad4_[expected_detail::cache_line_size];
+    std::atomic<unsigned> pop_epoch_;
+    char pad5_[expected_detail::cache_line_size];
+  };
+
+} // namespace boost
+
+#endif // BOOST_EXPECTED_EXPECTED_CHANNEL_HPP
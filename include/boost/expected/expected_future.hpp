@@ -0,0 +1,341 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_EXPECTED_FUTURE_HPP
+#define BOOST_EXPECTED_EXPECTED_FUTURE_HPP
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/detail/atomic_wait.hpp>
+
+#include <atomic>
+#include <exception>
+#include <future>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace boost
+{
+  template <class T, class E = std::exception_ptr>
+  class expected_future;
+  template <class T, class E = std::exception_ptr>
+  class expected_promise;
+
+namespace expected_detail
+{
+  // State shared by an expected_promise and its expected_future. The result
+  // is published through a single atomic status word:
+  // empty -> writing -> ready, or empty -> broken when the promise is
+  // destroyed without a result.
+  template <class T, class E>
+  class future_state
+  {
+  public:
+    typedef expected<T, E> result_type;
+    enum status_type : unsigned { empty, writing, ready, broken };
+
+    future_state() : status_(empty), refs_(1) {}
+    future_state(future_state const&) = delete;
+    future_state& operator=(future_state const&) = delete;
+
+    ~future_state()
+    {
+      if (status_.load(std::memory_order_relaxed) == ready)
+        result().~result_type();
+    }
+
+    void retain() BOOST_NOEXCEPT
+    {
+      refs_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() BOOST_NOEXCEPT
+    {
+      if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+    }
+
+    template <class ...Args>
+    void set(Args&&... args)
+    {
+      unsigned status = empty;
+      if (! status_.compare_exchange_strong(status, writing, std::memory_order_acquire))
+        throw std::future_error(std::future_errc::promise_already_satisfied);
+      try
+      {
+        ::new (static_cast<void*>(&storage_)) result_type(std::forward<Args>(args)...);
+      }
+      catch (...)
+      {
+        status_.store(empty, std::memory_order_release);
+        throw;
+      }
+      status_.store(ready, std::memory_order_release);
+      atomic_notify_all(status_);
+    }
+
+    void abandon() BOOST_NOEXCEPT
+    {
+      unsigned status = empty;
+      if (status_.compare_exchange_strong(status, broken, std::memory_order_release))
+        atomic_notify_all(status_);
+    }
+
+    bool is_ready() const BOOST_NOEXCEPT
+    {
+      return status_.load(std::memory_order_acquire) >= ready;
+    }
+
+    void wait() const
+    {
+      unsigned status;
+      while ((status = status_.load(std::memory_order_acquire)) < ready)
+        atomic_wait(status_, status);
+    }
+
+    result_type get()
+    {
+      wait();
+      if (status_.load(std::memory_order_relaxed) == broken)
+        throw std::future_error(std::future_errc::broken_promise);
+      return std::move(result());
+    }
+
+  private:
+    result_type& result() BOOST_NOEXCEPT
+    {
+      return *reinterpret_cast<result_type*>(&storage_);
+    }
+
+    std::atomic<unsigned> status_;
+    std::atomic<unsigned> refs_;
+    typename std::aligned_storage<sizeof(result_type), alignof(result_type)>::type storage_;
+  };
+} // namespace expected_detail
+
+  // One-shot future whose get() returns the expected<T, E> result instead of
+  // throwing. A future made from an already known result stores it inline,
+  // without allocation nor synchronization.
+  template <class T, class E>
+  class expected_future
+  {
+    typedef expected_detail::future_state<T, E> state_type;
+  public:
+    typedef expected<T, E> result_type;
+
+    expected_future() BOOST_NOEXCEPT : state_(0), inline_(false) {}
+
+    explicit expected_future(result_type r) : state_(0), inline_(true)
+    {
+      ::new (static_cast<void*>(&storage_)) result_type(std::move(r));
+    }
+
+    expected_future(expected_future&& x) : state_(x.state_), inline_(x.inline_)
+    {
+      if (inline_)
+      {
+        ::new (static_cast<void*>(&storage_)) result_type(std::move(x.result()));
+        x.reset();
+      }
+      x.state_ = 0;
+    }
+
+    expected_future& operator=(expected_future&& x)
+    {
+      if (this != &x)
+      {
+        reset();
+        if (x.inline_)
+        {
+          ::new (static_cast<void*>(&storage_)) result_type(std::move(x.result()));
+          inline_ = true;
+          x.reset();
+        }
+        state_ = x.state_;
+        x.state_ = 0;
+      }
+      return *this;
+    }
+
+    expected_future(expected_future const&) = delete;
+    expected_future& operator=(expected_future const&) = delete;
+
+    ~expected_future()
+    {
+      reset();
+    }
+
+    // Whether the future refers to a result, i.e. get() has not been called.
+    bool valid() const BOOST_NOEXCEPT
+    {
+      return inline_ || state_ != 0;
+    }
+
+    bool is_ready() const BOOST_NOEXCEPT
+    {
+      return inline_ || (state_ != 0 && state_->is_ready());
+    }
+
+    void wait() const
+    {
+      if (state_)
+        state_->wait();
+    }
+
+    // Waits for the result and moves it out; the future is no longer valid.
+    // Throws std::future_error if there is no state or the promise was
+    // destroyed without a result.
+    result_type get()
+    {
+      if (inline_)
+      {
+        result_type r(std::move(result()));
+        reset();
+        return r;
+      }
+      if (! state_)
+        throw std::future_error(std::future_errc::no_state);
+      state_type* state = state_;
+      state_ = 0;
+      try
+      {
+        result_type r(state->get());
+        state->release();
+        return r;
+      }
+      catch (...)
+      {
+        state->release();
+        throw;
+      }
+    }
+
+  private:
+    friend class expected_promise<T, E>;
+
+    explicit expected_future(state_type* state) BOOST_NOEXCEPT : state_(state), inline_(false) {}
+
+    result_type& result() BOOST_NOEXCEPT
+    {
+      return *reinterpret_cast<result_type*>(&storage_);
+    }
+
+    void reset() BOOST_NOEXCEPT
+    {
+      if (inline_)
+      {
+        result().~result_type();
+        inline_ = false;
+      }
+      if (state_)
+      {
+        state_->release();
+        state_ = 0;
+      }
+    }
+
+    state_type* state_;
+    bool inline_;
+    typename std::aligned_storage<sizeof(result_type), alignof(result_type)>::type storage_;
+  };
+
+  // Producer side of an expected_future. The shared state is allocated
+  // when the promise is created; setting the result is a single atomic
+  // transition, and waiting is done on the same atomic.
+  template <class T, class E>
+  class expected_promise
+  {
+    typedef expected_detail::future_state<T, E> state_type;
+  public:
+    typedef expected<T, E> result_type;
+
+    expected_promise() : state_(new state_type), retrieved_(false) {}
+
+    expected_promise(expected_promise&& x) BOOST_NOEXCEPT
+      : state_(x.state_), retrieved_(x.retrieved_)
+    {
+      x.state_ = 0;
+    }
+
+    expected_promise& operator=(expected_promise&& x) BOOST_NOEXCEPT
+    {
+      if (this != &x)
+      {
+        reset();
+        state_ = x.state_;
+        retrieved_ = x.retrieved_;
+        x.state_ = 0;
+      }
+      return *this;
+    }
+
+    expected_promise(expected_promise const&) = delete;
+    expected_promise& operator=(expected_promise const&) = delete;
+
+    // A promise destroyed without a result makes the future get() throw
+    // std::future_error(broken_promise).
+    ~expected_promise()
+    {
+      reset();
+    }
+
+    expected_future<T, E> get_future()
+    {
+      if (! state_)
+        throw std::future_error(std::future_errc::no_state);
+      if (retrieved_)
+        throw std::future_error(std::future_errc::future_already_retrieved);
+      retrieved_ = true;
+      state_->retain();
+      return expected_future<T, E>(state_);
+    }
+
+    template <class ...Args>
+    void set_value(Args&&... args)
+    {
+      state().set(in_place_t{}, std::forward<Args>(args)...);
+    }
+
+    void set_error(E e)
+    {
+      state().set(make_unexpected(std::move(e)));
+    }
+
+    void set_result(result_type r)
+    {
+      state().set(std::move(r));
+    }
+
+  private:
+    state_type& state()
+    {
+      if (! state_)
+        throw std::future_error(std::future_errc::no_state);
+      return *state_;
+    }
+
+    void reset() BOOST_NOEXCEPT
+    {
+      if (state_)
+      {
+        state_->abandon();
+        state_->release();
+        state_ = 0;
+      }
+    }
+
+    state_type* state_;
+    bool retrieved_;
+  };
+
+  template <class T, class E>
+  expected_future<T, E> make_ready_expected_future(expected<T, E> r)
+  {
+    return expected_future<T, E>(std::move(r));
+  }
+
+} // namespace boost
+
+#endif // BOOST_EXPECTED_EXPECTED_FUTURE_HPP
@@ -30,8 +30,8 @@ namespace functional
   template <class T, class E>
   struct errored_traits<expected<T, E> > : errored_traits<category::forward> {
     template <class M>
-    static BOOST_CONSTEXPR auto get_errored(M&& m) -> decltype(m.get_unexpected())
-    { return m.get_unexpected();}
+    static BOOST_CONSTEXPR auto get_errored(M&& m) -> decltype(std::forward<M>(m).get_unexpected())
+    { return std::forward<M>(m).get_unexpected();}
 
   };
 
@@ -60,6 +60,16 @@ namespace functional
       return make_unexpected(std::forward<E>(e));
     }
   };
+
+namespace do_detail
+{
+  // DO_RETURN under BOOST_EXPECTED_CATCH_EXCEPTIONS: as for bind.
+  template <class T, class E>
+  unexpected_type<E> on_exception(expected<T, E> const&)
+  {
+    return make_unexpected(error_traits<E>::make_error_from_current_exception());
+  }
+} // namespace do_detail
 }
 }
 
@@ -0,0 +1,383 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_LAZY_EXPECTED_HPP
+#define BOOST_EXPECTED_LAZY_EXPECTED_HPP
+
+#include <boost/expected/expected.hpp>
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace boost
+{
+  template <class T, class E = std::exception_ptr, class F = std::function<expected<T, E>()> >
+  class lazy_expected;
+
+namespace expected_detail
+{
+  // The expected a function returning R gives: R itself or expected<R>.
+  template <class R>
+  struct lazy_result
+  {
+    typedef expected<R> type;
+  };
+
+  template <class T, class E>
+  struct lazy_result<expected<T, E> >
+  {
+    typedef expected<T, E> type;
+  };
+
+  // The function or, once it has run, its outcome.
+  template <class T, class E, class F>
+  class lazy_storage
+  {
+  public:
+    typedef expected<T, E> expected_type;
+
+    // The function is destroyed before the outcome takes its place.
+    BOOST_STATIC_ASSERT_MSG(std::is_nothrow_move_constructible<expected_type>::value,
+        "the outcome of a lazy_expected must be nothrow move constructible");
+
+    lazy_storage() {}
+    ~lazy_storage() {}
+
+    void construct(F&& f) { ::new (&fn) F(std::move(f)); }
+    void construct(F const& f) { ::new (&fn) F(f); }
+    void construct(expected_type&& e) { ::new (&result) expected_type(std::move(e)); }
+    void construct(expected_type const& e) { ::new (&result) expected_type(e); }
+
+    void construct(lazy_storage&& s, bool ready)
+    {
+      if (ready) construct(std::move(s.result));
+      else construct(std::move(s.fn));
+    }
+
+    void construct(lazy_storage const& s, bool ready)
+    {
+      if (ready) construct(s.result);
+      else construct(s.fn);
+    }
+
+    void destroy(bool ready)
+    {
+      if (ready) result.~expected_type();
+      else fn.~F();
+    }
+
+    // If the function throws it stays, to be called again.
+    void run()
+    {
+      expected_type r(fn());
+      fn.~F();
+      ::new (&result) expected_type(std::move(r));
+    }
+
+    union
+    {
+      F fn;
+      expected_type result;
+    };
+  };
+
+  template <class Lazy, class G>
+  struct lazy_map
+  {
+    Lazy source;
+    G g;
+
+    auto operator()() -> decltype(source.get().map(std::move(g)))
+    {
+      return source.get().map(std::move(g));
+    }
+  };
+
+  template <class Lazy, class G>
+  struct lazy_bind
+  {
+    Lazy source;
+    G g;
+
+    auto operator()() -> decltype(source.get().bind(std::move(g)))
+    {
+      return source.get().bind(std::move(g));
+    }
+  };
+
+  template <class Fn>
+  struct lazy_type
+  {
+    typedef typename lazy_result<decltype(std::declval<Fn&>()())>::type result_type;
+    typedef lazy_expected<typename result_type::value_type, typename result_type::error_type, Fn> type;
+  };
+} // namespace expected_detail
+
+  // An expected computed by F on first access, at most once, and kept in
+  // place of F. F returns an expected<T, E> or something an expected<T, E>
+  // is built from. The default F erases the type of the function; the one
+  // of make_lazy_expected, map and bind keeps it, so that nothing is
+  // allocated. map and bind return a lazy_expected which runs this one,
+  // then the function, on its own first access; they consume *this.
+  //
+  // The accessors are const, as the outcome is a cache. Accesses from
+  // several threads need concurrent_lazy_expected. A copy made before the
+  // function has run has its own copy of the function.
+  template <class T, class E, class F>
+  class lazy_expected
+  {
+    template <class T2, class E2, class F2>
+    friend class lazy_expected;
+
+    typedef expected_detail::lazy_storage<T, E, F> storage_type;
+
+  public:
+    typedef T value_type;
+    typedef E error_type;
+    typedef F function_type;
+    typedef expected<T, E> expected_type;
+
+    explicit lazy_expected(F f)
+    : ready(false)
+    {
+      storage.construct(std::move(f));
+    }
+
+    // An outcome already known.
+    lazy_expected(expected_type e)
+    : ready(true)
+    {
+      storage.construct(std::move(e));
+    }
+
+    // From another function type, F being built from it, e.g. to erase it.
+    template <class G
+      , BOOST_EXPECTED_T_REQUIRES(std::is_constructible<F, G&&>::value && ! std::is_same<F, G>::value)
+    >
+    lazy_expected(lazy_expected<T, E, G>&& other)
+    : ready(other.ready)
+    {
+      if (ready) storage.construct(std::move(other.storage.result));
+      else storage.construct(F(std::move(other.storage.fn)));
+    }
+
+    lazy_expected(lazy_expected const& other)
+    : ready(other.ready)
+    {
+      storage.construct(other.storage, ready);
+    }
+
+    lazy_expected(lazy_expected&& other)
+    : ready(other.ready)
+    {
+      storage.construct(std::move(other.storage), ready);
+    }
+
+    ~lazy_expected()
+    {
+      storage.destroy(ready);
+    }
+
+    lazy_expected& operator=(lazy_expected&& other) BOOST_NOEXCEPT
+    {
+      BOOST_STATIC_ASSERT_MSG(std::is_nothrow_move_constructible<F>::value,
+          "lazy_expected is move assignable when its function is nothrow move constructible");
+      if (this != &other)
+      {
+        storage.destroy(ready);
+        ready = other.ready;
+        storage.construct(std::move(other.storage), ready);
+      }
+      return *this;
+    }
+
+    lazy_expected& operator=(lazy_expected const& other)
+    {
+      lazy_expected tmp(other);
+      return *this = std::move(tmp);
+    }
+
+    // Whether the function has run.
+    bool is_ready() const BOOST_NOEXCEPT
+    {
+      return ready;
+    }
+
+    // Runs the function unless it has run.
+    expected_type& get() const
+    {
+      if (! ready)
+      {
+        storage.run();
+        ready = true;
+      }
+      return storage.result;
+    }
+
+    bool valid() const
+    {
+      return get().valid();
+    }
+
+#if ! defined(BOOST_NO_CXX11_EXPLICIT_CONVERSION_OPERATORS)
+    explicit operator bool() const
+    {
+      return valid();
+    }
+#endif
+
+    typename std::add_lvalue_reference<T>::type value() const
+    {
+      return get().value();
+    }
+
+    typename std::add_lvalue_reference<T>::type operator*() const
+    {
+      return *get();
+    }
+
+    T* operator->() const
+    {
+      return &*get();
+    }
+
+    E& error() const
+    {
+      return get().error();
+    }
+
+    template <class V>
+    T value_or(V&& v) const
+    {
+      return get().value_or(std::forward<V>(v));
+    }
+
+    template <class G>
+    typename expected_detail::lazy_type<expected_detail::lazy_map<lazy_expected, decay_t<G> > >::type
+    map(G&& g) &&
+    {
+      typedef expected_detail::lazy_map<lazy_expected, decay_t<G> > fn;
+      typedef typename expected_detail::lazy_type<fn>::type result_type;
+      return result_type(fn{ std::move(*this), std::forward<G>(g) });
+    }
+
+    template <class G>
+    typename expected_detail::lazy_type<expected_detail::lazy_bind<lazy_expected, decay_t<G> > >::type
+    bind(G&& g) &&
+    {
+      typedef expected_detail::lazy_bind<lazy_expected, decay_t<G> > fn;
+      typedef typename expected_detail::lazy_type<fn>::type result_type;
+      return result_type(fn{ std::move(*this), std::forward<G>(g) });
+    }
+
+  private:
+    mutable storage_type storage;
+    mutable bool ready;
+  };
+
+  template <class F>
+  typename expected_detail::lazy_type<decay_t<F> >::type make_lazy_expected(F&& f)
+  {
+    return typename expected_detail::lazy_type<decay_t<F> >::type(std::forward<F>(f));
+  }
+
+  // A lazy_expected which threads may access concurrently: the first one
+  // runs the function under a std::once_flag and the others wait for it.
+  // Once ready, an access is an acquire load. It is neither copied nor
+  // moved, as the threads refer to it.
+  template <class T, class E = std::exception_ptr, class F = std::function<expected<T, E>()> >
+  class concurrent_lazy_expected
+  {
+    typedef expected_detail::lazy_storage<T, E, F> storage_type;
+
+  public:
+    typedef T value_type;
+    typedef E error_type;
+    typedef F function_type;
+    typedef expected<T, E> expected_type;
+
+    explicit concurrent_lazy_expected(F f)
+    : ready(false)
+    {
+      storage.construct(std::move(f));
+    }
+
+    concurrent_lazy_expected(concurrent_lazy_expected const&) = delete;
+    concurrent_lazy_expected& operator=(concurrent_lazy_expected const&) = delete;
+
+    ~concurrent_lazy_expected()
+    {
+      storage.destroy(ready.load(std::memory_order_relaxed));
+    }
+
+    bool is_ready() const BOOST_NOEXCEPT
+    {
+      return ready.load(std::memory_order_acquire);
+    }
+
+    // Runs the function unless it has run or is running, in which case it
+    // waits for it. If the function throws, the next access calls it again.
+    expected_type& get() const
+    {
+      if (! ready.load(std::memory_order_acquire))
+        std::call_once(once, [this]
+        {
+          storage.run();
+          ready.store(true, std::memory_order_release);
+        });
+      return storage.result;
+    }
+
+    bool valid() const
+    {
+      return get().valid();
+    }
+
+#if ! defined(BOOST_NO_CXX11_EXPLICIT_CONVERSION_OPERATORS)
+    explicit operator bool() const
+    {
+      return valid();
+    }
+#endif
+
+    typename std::add_lvalue_reference<T>::type value() const
+    {
+      return get().value();
+    }
+
+    typename std::add_lvalue_reference<T>::type operator*() const
+    {
+      return *get();
+    }
+
+    T* operator->() const
+    {
+      return &*get();
+    }
+
+    E& error() const
+    {
+      return get().error();
+    }
+
+    template <class V>
+    T value_or(V&& v) const
+    {
+      return get().value_or(std::forward<V>(v));
+    }
+
+  private:
+    mutable storage_type storage;
+    mutable std::once_flag once;
+    mutable std::atomic<bool> ready;
+  };
+
+} // namespace boost
+
+#endif // BOOST_EXPECTED_LAZY_EXPECTED_HPP
@@ -0,0 +1,302 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_MEMOIZE_HPP
+#define BOOST_EXPECTED_MEMOIZE_HPP
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/detail/cache_line.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace boost
+{
+  // Limits of a memoize cache. Values and errors are kept apart, so that
+  // failing keys are remembered for a short time without evicting values.
+  // A capacity of 0 disables caching of that outcome.
+  struct memoize_options
+  {
+    memoize_options()
+      : value_capacity(4096), error_capacity(1024),
+        value_ttl(std::chrono::hours(24 * 365)), error_ttl(std::chrono::seconds(1)),
+        shards(16)
+    {}
+
+    std::size_t value_capacity;
+    std::size_t error_capacity;
+    std::chrono::nanoseconds value_ttl;
+    std::chrono::nanoseconds error_ttl;
+    // Rounded up to a power of 2.
+    std::size_t shards;
+  };
+
+  struct memoize_stats
+  {
+    memoize_stats()
+      : value_hits(0), error_hits(0), value_misses(0), error_misses(0),
+        coalesced(0), evictions(0), expirations(0)
+    {}
+
+    // Lookups served from the cache, by outcome.
+    std::size_t value_hits;
+    std::size_t error_hits;
+    // Lookups that called the function, by the outcome it returned.
+    std::size_t value_misses;
+    std::size_t error_misses;
+    // Lookups that waited for the call made by another thread.
+    std::size_t coalesced;
+    std::size_t evictions;
+    std::size_t expirations;
+  };
+
+  template <class K, class R, class Hash = std::hash<K>, class Pred = std::equal_to<K>,
+      class Clock = std::chrono::steady_clock>
+  class memoize;
+
+  // Concurrent cache of f(k), where f returns an expected. The table is
+  // split in shards, each with its own lock and, per outcome, a ring of
+  // entries evicted with the CLOCK algorithm. Concurrent misses on a key
+  // make a single call, the other threads waiting for its result.
+  template <class K, class T, class E, class Hash, class Pred, class Clock>
+  class memoize<K, expected<T, E>, Hash, Pred, Clock>
+  {
+  public:
+    typedef K key_type;
+    typedef expected<T, E> result_type;
+    typedef std::function<result_type(K const&)> function_type;
+
+    explicit memoize(function_type f, memoize_options const& opts = memoize_options())
+      : f_(std::move(f)), opts_(opts)
+    {
+      std::size_t n = 1;
+      shift_ = 64;
+      while (n < opts.shards)
+      {
+        n *= 2;
+        --shift_;
+      }
+      std::size_t const values = (opts.value_capacity + n - 1) / n;
+      std::size_t const errors = (opts.error_capacity + n - 1) / n;
+      shards_.reserve(n);
+      for (std::size_t i = 0; i < n; ++i)
+        shards_.push_back(std::unique_ptr<shard>(new shard(values, errors)));
+    }
+
+    memoize(memoize const&) = delete;
+    memoize& operator=(memoize const&) = delete;
+
+    // The cached result of f(k), or the result of calling it. If f throws,
+    // the exception is propagated and nothing is cached.
+    result_type operator()(K const& k)
+    {
+      std::size_t const h = hash_(k);
+      shard& s = shard_for(h);
+      std::unique_lock<std::mutex> lock(s.mutex);
+      for (;;)
+      {
+        typename index_type::iterator it = s.index.find(k);
+        if (it == s.index.end())
+          break;
+        if (it->second.pending)
+        {
+          // the result is taken from the flight, as it may not be cached
+          std::shared_ptr<flight> fl = it->second.pending;
+          while (! fl->done)
+            s.done.wait(lock);
+          if (! fl->result)
+            continue;
+          ++s.stats.coalesced;
+          return *fl->result;
+        }
+        slot& e = s.rings[it->second.ring].slots[it->second.index];
+        if (Clock::now() < e.expires)
+        {
+          e.referenced = true;
+          ++(it->second.ring == value_ring ? s.stats.value_hits : s.stats.error_hits);
+          return *e.result;
+        }
+        ++s.stats.expirations;
+        e.result.reset();
+        s.index.erase(it);
+        break;
+      }
+
+      std::shared_ptr<flight> fl = std::make_shared<flight>();
+      s.index[k].pending = fl;
+      lock.unlock();
+      try
+      {
+        fl->computed.reset(new result_type(f_(k)));
+      }
+      catch (...)
+      {
+        lock.lock();
+        fl->done = true;
+        s.index.erase(k);
+        s.done.notify_all();
+        throw;
+      }
+      lock.lock();
+      fl->result = std::move(fl->computed);
+      fl->done = true;
+      store(s, k, *fl->result);
+      s.done.notify_all();
+      return *fl->result;
+    }
+
+    // Drops the cached result of k, if any.
+    void invalidate(K const& k)
+    {
+      shard& s = shard_for(hash_(k));
+      std::lock_guard<std::mutex> lock(s.mutex);
+      typename index_type::iterator it = s.index.find(k);
+      if (it == s.index.end() || it->second.pending)
+        return;
+      s.rings[it->second.ring].slots[it->second.index].result.reset();
+      s.index.erase(it);
+    }
+
+    memoize_stats stats() const
+    {
+      memoize_stats total;
+      for (std::size_t i = 0; i < shards_.size(); ++i)
+      {
+        std::lock_guard<std::mutex> lock(shards_[i]->mutex);
+        memoize_stats const& s = shards_[i]->stats;
+        total.value_hits += s.value_hits;
+        total.error_hits += s.error_hits;
+        total.value_misses += s.value_misses;
+        total.error_misses += s.error_misses;
+        total.coalesced += s.coalesced;
+        total.evictions += s.evictions;
+        total.expirations += s.expirations;
+      }
+      return total;
+    }
+
+  private:
+    enum { value_ring, error_ring };
+
+    // The call in progress for a key; result stays null if it threw.
+    struct flight
+    {
+      flight() : done(false) {}
+      std::unique_ptr<result_type> computed;
+      std::unique_ptr<result_type> result;
+      bool done;
+    };
+
+    struct location
+    {
+      location() : ring(0), index(0) {}
+      std::shared_ptr<flight> pending;
+      unsigned char ring;
+      std::size_t index;
+    };
+
+    struct slot
+    {
+      slot() : referenced(false) {}
+      std::unique_ptr<K> key;
+      std::unique_ptr<result_type> result;
+      typename Clock::time_point expires;
+      bool referenced;
+    };
+
+    struct ring
+    {
+      explicit ring(std::size_t n) : slots(n), hand(0) {}
+      std::vector<slot> slots;
+      std::size_t hand;
+    };
+
+    typedef std::unordered_map<K, location, Hash, Pred> index_type;
+
+    struct shard
+    {
+      shard(std::size_t values, std::size_t errors)
+      {
+        rings.push_back(ring(values));
+        rings.push_back(ring(errors));
+      }
+
+      mutable std::mutex mutex;
+      std::condition_variable done;
+      index_type index;
+      std::vector<ring> rings;
+      memoize_stats stats;
+      // shards are allocated apart; keeps two of them off one cache line
+      char pad[expected_detail::cache_line_size];
+    };
+
+    shard& shard_for(std::size_t h)
+    {
+      // the top bits of a multiplicative hash, as std::hash is often the identity
+      std::uint64_t const mixed = std::uint64_t(h) * 0x9E3779B97F4A7C15ull;
+      return *shards_[shift_ == 64 ? 0 : std::size_t(mixed >> shift_)];
+    }
+
+    // Called with the lock held and k pending in the index.
+    void store(shard& s, K const& k, result_type const& x)
+    {
+      bool const valid = x.valid();
+      valid ? ++s.stats.value_misses : ++s.stats.error_misses;
+      unsigned char const which = valid ? value_ring : error_ring;
+      ring& r = s.rings[which];
+      if (r.slots.empty())
+      {
+        s.index.erase(k);
+        return;
+      }
+
+      // CLOCK: skip and clear the referenced entries, take the first other
+      for (;;)
+      {
+        slot& e = r.slots[r.hand];
+        if (e.result && e.referenced)
+        {
+          e.referenced = false;
+          r.hand = (r.hand + 1) % r.slots.size();
+          continue;
+        }
+        if (e.result)
+        {
+          ++s.stats.evictions;
+          s.index.erase(*e.key);
+        }
+        break;
+      }
+      slot& e = r.slots[r.hand];
+      e.key.reset(new K(k));
+      e.result.reset(new result_type(x));
+      e.expires = Clock::now() + std::chrono::duration_cast<typename Clock::duration>(
+          valid ? opts_.value_ttl : opts_.error_ttl);
+      e.referenced = false;
+      location& l = s.index[k];
+      l.pending.reset();
+      l.ring = which;
+      l.index = r.hand;
+      r.hand = (r.hand + 1) % r.slots.size();
+    }
+
+    function_type f_;
+    memoize_options opts_;
+    Hash hash_;
+    unsigned shift_;
+    std::vector<std::unique_ptr<shard> > shards_;
+  };
+
+} // namespace boost
+
+#endif // BOOST_EXPECTED_MEMOIZE_HPP
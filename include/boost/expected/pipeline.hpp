@@ -0,0 +1,300 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_PIPELINE_HPP
+#define BOOST_EXPECTED_PIPELINE_HPP
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/error_traits.hpp>
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Lazy pipelines: e | fmap(f) | fbind(g) | recover(k) is the same as
+// e.map(f).bind(g).catch_error(k), but the stages are only collected until
+// the result is asked for, then run as a single fused function. A value
+// goes from stage to stage as a plain value, and an error skips to the
+// next recover stage or to the end, without an expected in between.
+
+namespace boost
+{
+namespace expected_detail
+{
+  template <class F> struct map_stage { F f; };
+  template <class F> struct bind_stage { F f; };
+  template <class F> struct recover_stage { F f; };
+
+  // The value type after a stage, given the one before.
+  template <class S, class V>
+  struct stage_value;
+  template <class F, class V>
+  struct stage_value<map_stage<F>, V>
+  {
+    typedef typename std::decay<typename std::result_of<F&(V)>::type>::type type;
+    static_assert(! std::is_void<type>::value, "fmap of a function returning void");
+  };
+  template <class F, class V>
+  struct stage_value<bind_stage<F>, V>
+  {
+    typedef typename std::decay<typename std::result_of<F&(V)>::type>::type::value_type type;
+  };
+  template <class F, class V>
+  struct stage_value<recover_stage<F>, V>
+  {
+    typedef V type;
+  };
+
+  template <class V, class E, class ...S>
+  struct pipeline_result;
+  template <class V, class E>
+  struct pipeline_result<V, E>
+  {
+    typedef expected<V, E> type;
+  };
+  template <class V, class E, class S, class ...Ss>
+  struct pipeline_result<V, E, S, Ss...>
+    : pipeline_result<typename stage_value<S, V>::type, E, Ss...>
+  {};
+
+  // Runs the stages from I on, given a value or an error. Every stage is
+  // a direct call of the next, so that the whole pipeline inlines into
+  // one function, with one exit per point where an error may appear.
+  template <class R, std::size_t I, class Stages, bool End = (I == std::tuple_size<Stages>::value)>
+  struct fused;
+
+  template <class R, std::size_t I, class Stages>
+  struct fused<R, I, Stages, true>
+  {
+    template <class V>
+    static R value(Stages&, V&& v)
+    {
+      return R(std::forward<V>(v));
+    }
+    template <class V, class G>
+    static R error(Stages&, G&& e)
+    {
+      return R(make_unexpected(std::forward<G>(e)));
+    }
+  };
+
+  template <class R, std::size_t I, class Stages>
+  struct fused<R, I, Stages, false>
+  {
+    typedef fused<R, I + 1, Stages> next;
+    typedef typename R::error_type error_type;
+
+    template <class V>
+    static R value(Stages& s, V&& v)
+    {
+      return value(std::get<I>(s), s, std::forward<V>(v));
+    }
+
+    // V is the value type a recover stage would give.
+    template <class V, class G>
+    static R error(Stages& s, G&& e)
+    {
+      return error<V>(std::get<I>(s), s, std::forward<G>(e));
+    }
+
+  private:
+    template <class F, class V>
+    static R value(map_stage<F>& st, Stages& s, V&& v)
+    {
+#if defined BOOST_EXPECTED_CATCH_EXCEPTIONS
+      typedef typename stage_value<map_stage<F>, V>::type U;
+      try {
+#endif
+        return next::value(s, st.f(std::forward<V>(v)));
+#if defined BOOST_EXPECTED_CATCH_EXCEPTIONS
+      } catch (...) {
+        return next::template error<U>(s, error_traits<error_type>::make_error_from_current_exception());
+      }
+#endif
+    }
+
+    template <class F, class V>
+    static R value(bind_stage<F>& st, Stages& s, V&& v)
+    {
+      typedef typename stage_value<bind_stage<F>, V>::type U;
+#if defined BOOST_EXPECTED_CATCH_EXCEPTIONS
+      try {
+#endif
+        typename std::result_of<F&(V)>::type r = st.f(std::forward<V>(v));
+        if (BOOST_LIKELY(r.valid()))
+          return next::value(s, std::move(*r));
+        return next::template error<U>(s, std::move(r.error()));
+#if defined BOOST_EXPECTED_CATCH_EXCEPTIONS
+      } catch (...) {
+        return next::template error<U>(s, error_traits<error_type>::make_error_from_current_exception());
+      }
+#endif
+    }
+
+    template <class F, class V>
+    static R value(recover_stage<F>&, Stages& s, V&& v)
+    {
+      return next::value(s, std::forward<V>(v));
+    }
+
+    template <class V, class F, class G>
+    static R error(map_stage<F>&, Stages& s, G&& e)
+    {
+      return next::template error<typename stage_value<map_stage<F>, V>::type>(s, std::forward<G>(e));
+    }
+
+    template <class V, class F, class G>
+    static R error(bind_stage<F>&, Stages& s, G&& e)
+    {
+      return next::template error<typename stage_value<bind_stage<F>, V>::type>(s, std::forward<G>(e));
+    }
+
+    // k(e) gives a V, an expected<V, E> or an unexpected_type<E>, as for
+    // catch_error.
+    template <class V, class F, class G>
+    static R error(recover_stage<F>& st, Stages& s, G&& e)
+    {
+      return recovered<V>(s, st.f(std::forward<G>(e)));
+    }
+
+    template <class V, class X>
+    static R recovered(Stages& s, X&& x,
+        BOOST_EXPECTED_REQUIRES(std::is_convertible<X, V>::value))
+    {
+      return next::value(s, V(std::forward<X>(x)));
+    }
+    template <class V, class G>
+    static R recovered(Stages& s, expected<V, G>&& x)
+    {
+      if (x.valid())
+        return next::value(s, std::move(*x));
+      return next::template error<V>(s, std::move(x.error()));
+    }
+    template <class V, class G>
+    static R recovered(Stages& s, unexpected_type<G>&& x)
+    {
+      return next::template error<V>(s, std::move(x.value()));
+    }
+  };
+} // namespace expected_detail
+
+  // A list of stages, applied to an expected with operator() or operator|.
+  template <class ...S>
+  class pipeline
+  {
+  public:
+    typedef std::tuple<S...> stages_type;
+
+    template <class T, class E>
+    struct result
+      : expected_detail::pipeline_result<T, E, S...>
+    {};
+
+    explicit pipeline(stages_type s) : stages_(std::move(s)) {}
+
+    template <class T, class E>
+    typename result<T, E>::type operator()(expected<T, E> const& e)
+    {
+      typedef expected_detail::fused<typename result<T, E>::type, 0, stages_type> fused;
+      if (e.valid())
+        return fused::value(stages_, *e);
+      return fused::template error<T>(stages_, e.error());
+    }
+
+    template <class T, class E>
+    typename result<T, E>::type operator()(expected<T, E>&& e)
+    {
+      typedef expected_detail::fused<typename result<T, E>::type, 0, stages_type> fused;
+      if (e.valid())
+        return fused::value(stages_, std::move(*e));
+      return fused::template error<T>(stages_, std::move(e.error()));
+    }
+
+    stages_type& stages() BOOST_NOEXCEPT { return stages_; }
+
+  private:
+    stages_type stages_;
+  };
+
+  template <class ...S1, class ...S2>
+  pipeline<S1..., S2...> operator|(pipeline<S1...> p, pipeline<S2...> q)
+  {
+    return pipeline<S1..., S2...>(std::tuple_cat(std::move(p.stages()), std::move(q.stages())));
+  }
+
+  // An expected and the stages to apply to it, run when converted to their
+  // result. The expected is referred to, not copied, so the conversion
+  // must happen in the same full expression.
+  template <class X, class ...S>
+  class piped
+  {
+    typedef typename std::decay<X>::type expected_type;
+  public:
+    typedef typename pipeline<S...>::template result<
+        typename expected_type::value_type, typename expected_type::error_type>::type result_type;
+
+    piped(X&& e, pipeline<S...> p) : e_(std::forward<X>(e)), p_(std::move(p)) {}
+
+    result_type run()
+    {
+      return p_(std::forward<X>(e_));
+    }
+
+    operator result_type()
+    {
+      return run();
+    }
+
+    template <class ...S2>
+    piped<X, S..., S2...> operator|(pipeline<S2...> q)
+    {
+      return piped<X, S..., S2...>(std::forward<X>(e_), p_ | std::move(q));
+    }
+
+  private:
+    X&& e_;
+    pipeline<S...> p_;
+  };
+
+  template <class T, class E, class ...S>
+  piped<expected<T, E> const&, S...> operator|(expected<T, E> const& e, pipeline<S...> p)
+  {
+    return piped<expected<T, E> const&, S...>(e, std::move(p));
+  }
+
+  template <class T, class E, class ...S>
+  piped<expected<T, E>, S...> operator|(expected<T, E>&& e, pipeline<S...> p)
+  {
+    return piped<expected<T, E>, S...>(std::move(e), std::move(p));
+  }
+
+  // As map(f).
+  template <class F>
+  pipeline<expected_detail::map_stage<typename std::decay<F>::type> > fmap(F&& f)
+  {
+    expected_detail::map_stage<typename std::decay<F>::type> s = { std::forward<F>(f) };
+    return pipeline<expected_detail::map_stage<typename std::decay<F>::type> >(std::make_tuple(std::move(s)));
+  }
+
+  // As bind(f), f returning an expected.
+  template <class F>
+  pipeline<expected_detail::bind_stage<typename std::decay<F>::type> > fbind(F&& f)
+  {
+    expected_detail::bind_stage<typename std::decay<F>::type> s = { std::forward<F>(f) };
+    return pipeline<expected_detail::bind_stage<typename std::decay<F>::type> >(std::make_tuple(std::move(s)));
+  }
+
+  // As catch_error(f).
+  template <class F>
+  pipeline<expected_detail::recover_stage<typename std::decay<F>::type> > recover(F&& f)
+  {
+    expected_detail::recover_stage<typename std::decay<F>::type> s = { std::forward<F>(f) };
+    return pipeline<expected_detail::recover_stage<typename std::decay<F>::type> >(std::make_tuple(std::move(s)));
+  }
+
+} // namespace boost
+
+#endif // BOOST_EXPECTED_PIPELINE_HPP
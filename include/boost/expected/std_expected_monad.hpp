@@ -0,0 +1,92 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_STD_EXPECTED_MONAD_HPP
+#define BOOST_EXPECTED_STD_EXPECTED_MONAD_HPP
+
+// std::expected as a monad, as expected in expected_monad.hpp. map and bind
+// work on the std::expected itself and move its value or error when it is
+// an rvalue.
+
+#include <boost/expected/config.hpp>
+
+#if defined BOOST_EXPECTED_HAS_STD_EXPECTED
+
+#include <boost/functional/monads/errored.hpp>
+#include <boost/functional/monads/functor.hpp>
+#include <boost/functional/monads/categories/errored.hpp>
+#include <boost/functional/monads/monad.hpp>
+#include <boost/functional/monads/monad_error.hpp>
+#include <expected>
+#include <utility>
+
+namespace boost
+{
+namespace functional
+{
+  template <class T, class E>
+  struct rebindable_traits<std::expected<T, E>> : rebindable_traits<category::default_>
+  {
+    template <class M>
+    using value_type = T;
+
+    template <class M>
+    struct type_constructor {
+      template <class U>
+      using type = std::expected<U, E>;
+    };
+  };
+
+  template <class T, class E>
+  struct valued_traits<std::expected<T, E>> : valued_traits<category::default_>
+  {
+    template <class M>
+    static BOOST_CONSTEXPR bool has_value(M&& m)
+    { return m.has_value(); }
+
+    template <class M>
+    static BOOST_CONSTEXPR auto deref(M&& m) -> decltype(*std::forward<M>(m))
+    { return *std::forward<M>(m); }
+
+    template <class M>
+    static BOOST_CONSTEXPR auto get_value(M&& m) -> decltype(std::forward<M>(m).value())
+    { return std::forward<M>(m).value(); }
+  };
+
+  template <class T, class E>
+  struct errored_traits<std::expected<T, E>> : errored_traits<category::default_>
+  {
+    template <class M>
+    using error_type = E;
+    template <class M>
+    using errored_type = std::unexpected<E>;
+
+    template <class M>
+    static BOOST_CONSTEXPR std::unexpected<E> get_errored(M&& m)
+    { return std::unexpected<E>(std::forward<M>(m).error()); }
+
+    template <class M>
+    static BOOST_CONSTEXPR auto error(M&& m) -> decltype(std::forward<M>(m).error())
+    { return std::forward<M>(m).error(); }
+  };
+
+  template <class T, class E>
+  struct functor_traits<std::expected<T, E>> : functor_traits<category::errored> {};
+
+  template <class T, class E>
+  struct monad_traits<std::expected<T, E>> : monad_traits<category::errored> {};
+
+  template <class T, class E1>
+  struct monad_error_traits<std::expected<T, E1>> : monad_error_traits<category::default_>
+  {
+    template <class M, class E>
+    static BOOST_CONSTEXPR std::unexpected<std::decay_t<E>> make_error(E&& e)
+    { return std::unexpected<std::decay_t<E>>(std::forward<E>(e)); }
+  };
+}
+}
+
+#endif
+#endif // BOOST_EXPECTED_STD_EXPECTED_MONAD_HPP
@@ -0,0 +1,95 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_STD_OPTIONAL_MONAD_HPP
+#define BOOST_EXPECTED_STD_OPTIONAL_MONAD_HPP
+
+// std::optional as a monad, as boost::optional in optional_monad.hpp. map
+// and bind work on the optional itself and move its value when it is an
+// rvalue.
+
+#include <boost/expected/config.hpp>
+
+#if defined BOOST_EXPECTED_HAS_STD_OPTIONAL
+
+#include <boost/functional/meta.hpp>
+#include <boost/functional/monads/errored.hpp>
+#include <boost/functional/monads/functor.hpp>
+#include <boost/functional/monads/categories/errored.hpp>
+#include <boost/functional/monads/categories/pointer_like.hpp>
+#include <boost/functional/monads/monad.hpp>
+#include <boost/functional/monads/monad_error.hpp>
+#include <optional>
+#include <utility>
+
+namespace boost
+{
+  using std_optional_monad = functional::lift<std::optional>;
+
+namespace functional
+{
+  template <class T>
+  struct rebindable_traits<std::optional<T>> : rebindable_traits<category::default_>
+  {
+    template <class M>
+    using value_type = T;
+
+    template <class M>
+    struct type_constructor {
+      template <class U>
+      using type = std::optional<U>;
+    };
+  };
+
+  template <class T>
+  struct valued_traits<std::optional<T>> : valued_traits<category::pointer_like>
+  {
+    template <class M>
+    static BOOST_CONSTEXPR auto deref(M&& m) -> decltype(*std::forward<M>(m))
+    { return *std::forward<M>(m); }
+
+    template <class M>
+    static BOOST_CONSTEXPR auto get_value(M&& m) -> decltype(std::forward<M>(m).value())
+    { return std::forward<M>(m).value(); }
+  };
+
+  template <class T>
+  struct errored_traits<std::optional<T>> : errored_traits<category::default_>
+  {
+    template <class M>
+    using error_type = std::nullopt_t;
+    template <class M>
+    using errored_type = std::nullopt_t;
+
+    template <class M>
+    static BOOST_CONSTEXPR std::nullopt_t get_errored(M&&)
+    { return std::nullopt; }
+
+    template <class M>
+    static BOOST_CONSTEXPR std::nullopt_t error(M&&)
+    { return std::nullopt; }
+  };
+
+  template <class T>
+  struct functor_traits<std::optional<T>> : functor_traits<category::errored> {};
+
+  template <class T>
+  struct monad_traits<std::optional<T>> : monad_traits<category::errored> {};
+
+  template <>
+  struct monad_error_traits<std_optional_monad> : monad_error_traits<category::default_>
+  {
+    template <class M, class E>
+    static BOOST_CONSTEXPR std::nullopt_t make_error(E&&)
+    { return std::nullopt; }
+  };
+
+  template <class T>
+  struct monad_error_traits<std::optional<T>> : monad_error_traits<std_optional_monad> {};
+}
+}
+
+#endif
+#endif // BOOST_EXPECTED_STD_OPTIONAL_MONAD_HPP
@@ -0,0 +1,125 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_STD_VARIANT_MONAD_HPP
+#define BOOST_EXPECTED_STD_VARIANT_MONAD_HPP
+
+// std::variant<T, E> as a monad with a value T and an error E. map and bind
+// work on the variant itself and move its alternatives when it is an rvalue.
+// map takes a single variant.
+
+#include <boost/expected/config.hpp>
+
+#if defined BOOST_EXPECTED_HAS_STD_VARIANT
+
+#include <boost/expected/detail/requires.hpp>
+#include <boost/functional/monads/errored.hpp>
+#include <boost/functional/monads/functor.hpp>
+#include <boost/functional/monads/monad.hpp>
+#include <boost/functional/monads/monad_error.hpp>
+#include <utility>
+#include <variant>
+
+namespace boost
+{
+namespace functional
+{
+  template <class T, class E>
+  struct rebindable_traits<std::variant<T, E>> : rebindable_traits<category::default_>
+  {
+    template <class M>
+    using value_type = T;
+
+    template <class M>
+    struct type_constructor {
+      template <class U>
+      using type = std::variant<U, E>;
+    };
+  };
+
+  // A variant valueless by exception has no value, and throws
+  // std::bad_variant_access as its error is accessed.
+  template <class T, class E>
+  struct valued_traits<std::variant<T, E>> : valued_traits<category::default_>
+  {
+    template <class M>
+    static BOOST_CONSTEXPR bool has_value(M&& m)
+    { return m.index() == 0; }
+
+    // Unchecked, as has_value has been tested.
+    template <class M, class R = decltype(std::get<0>(std::declval<M>()))>
+    static BOOST_CONSTEXPR R deref(M&& m)
+    { return static_cast<R>(*std::get_if<0>(&m)); }
+
+    template <class M>
+    static BOOST_CONSTEXPR auto get_value(M&& m) -> decltype(std::get<0>(std::forward<M>(m)))
+    { return std::get<0>(std::forward<M>(m)); }
+  };
+
+  template <class T, class E>
+  struct errored_traits<std::variant<T, E>> : errored_traits<category::default_>
+  {
+    template <class M>
+    using error_type = E;
+    template <class M>
+    using errored_type = E;
+
+    template <class M>
+    static BOOST_CONSTEXPR auto get_errored(M&& m) -> decltype(std::get<1>(std::forward<M>(m)))
+    { return std::get<1>(std::forward<M>(m)); }
+
+    template <class M>
+    static BOOST_CONSTEXPR auto error(M&& m) -> decltype(std::get<1>(std::forward<M>(m)))
+    { return std::get<1>(std::forward<M>(m)); }
+  };
+
+  // The results are built with std::in_place_index, as variant<U, E> cannot
+  // be built from a U or an E alone when one is convertible to the other.
+  template <class T, class E>
+  struct functor_traits<std::variant<T, E>> : functor_traits<category::default_>
+  {
+    template <class F, class M, class FR = decltype(std::declval<F>()(valued::deref(std::declval<M>())))>
+    static BOOST_EXPECTED_CXX14_CONSTEXPR std::variant<FR, E> map(F&& f, M&& m)
+    {
+      using namespace valued;
+      if (has_value(m))
+        return std::variant<FR, E>(std::in_place_index<0>, std::forward<F>(f)(deref(std::forward<M>(m))));
+      return std::variant<FR, E>(std::in_place_index<1>, std::get<1>(std::forward<M>(m)));
+    }
+  };
+
+  template <class T, class E>
+  struct monad_traits<std::variant<T, E>> : monad_traits<category::default_>
+  {
+    template <class M, class F, class FR = decltype(std::declval<F>()(valued::deref(std::declval<M>())))>
+    static BOOST_EXPECTED_CXX14_CONSTEXPR FR bind(M&& m, F&& f,
+        BOOST_EXPECTED_REQUIRES(boost::functional::is_monad<FR>::value))
+    {
+      using namespace valued;
+      if (has_value(m))
+        return std::forward<F>(f)(deref(std::forward<M>(m)));
+      return FR(std::in_place_index<1>, std::get<1>(std::forward<M>(m)));
+    }
+
+    template <class M, class F, class FR = decltype(std::declval<F>()(valued::deref(std::declval<M>())))>
+    static BOOST_EXPECTED_CXX14_CONSTEXPR std::variant<FR, E> bind(M&& m, F&& f,
+        BOOST_EXPECTED_REQUIRES(! boost::functional::is_monad<FR>::value))
+    {
+      return functor_traits<std::variant<T, E>>::map(std::forward<F>(f), std::forward<M>(m));
+    }
+  };
+
+  template <class T, class E1>
+  struct monad_error_traits<std::variant<T, E1>> : monad_error_traits<category::default_>
+  {
+    template <class M, class E>
+    static BOOST_CONSTEXPR M make_error(E&& e)
+    { return M(std::in_place_index<1>, std::forward<E>(e)); }
+  };
+}
+}
+
+#endif
+#endif // BOOST_EXPECTED_STD_VARIANT_MONAD_HPP
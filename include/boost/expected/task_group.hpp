@@ -0,0 +1,249 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_TASK_GROUP_HPP
+#define BOOST_EXPECTED_TASK_GROUP_HPP
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/cancellation.hpp>
+#include <boost/expected/work_stealing_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace boost
+{
+  // The errors of the children of a task_group, ordered by child index,
+  // and the number of children skipped or stopped by the cancellation.
+  template <class E>
+  class aggregate_error
+  {
+  public:
+    struct entry
+    {
+      std::size_t index;
+      E error;
+    };
+    typedef std::vector<entry> container_type;
+
+    aggregate_error(container_type errors, std::size_t cancelled)
+      : errors_(std::move(errors)), cancelled_(cancelled)
+    {}
+
+    container_type const& errors() const BOOST_NOEXCEPT { return errors_; }
+    std::size_t size() const BOOST_NOEXCEPT { return errors_.size(); }
+    std::size_t cancelled() const BOOST_NOEXCEPT { return cancelled_; }
+
+  private:
+    container_type errors_;
+    std::size_t cancelled_;
+  };
+
+namespace expected_detail
+{
+  // f(token) if f takes one, else f().
+  template <class F>
+  auto call_child(F& f, cancellation_token const& t, int) -> decltype(f(t))
+  {
+    return f(t);
+  }
+  template <class F>
+  auto call_child(F& f, cancellation_token const&, long) -> decltype(f())
+  {
+    return f();
+  }
+
+  template <class F>
+  struct child_call
+  {
+    F* f;
+    cancellation_token const* token;
+
+    auto operator()() -> decltype(call_child(*f, *token, 0))
+    {
+      return call_child(*f, *token, 0);
+    }
+  };
+} // namespace expected_detail
+
+  // Fan-out of at most n children on a work_stealing_pool, joined as
+  // expected<std::vector<T>, aggregate_error<E>>. Each child writes its
+  // value in its own preallocated slot, and its error, if any, to a
+  // lock-free list; the first error requests cancellation, so that the
+  // children not started yet are skipped and the running ones may stop
+  // early, looking at the token they are given. A child is f(token) or
+  // f(), returning T or expected<T, E>; an exception becomes the error
+  // through error_traits. Children are spawned from a single thread, and
+  // do not outlive the group: the destructor waits for them.
+  template <class T, class E = std::exception_ptr>
+  class task_group
+  {
+    static_assert(! std::is_void<T>::value, "task_group needs a value type");
+  public:
+    typedef expected<std::vector<T>, aggregate_error<E> > result_type;
+
+    task_group(work_stealing_pool& pool, std::size_t n)
+      : pool_(pool), capacity_(n), slots_(new slot[n]), done_(new bool[n]()),
+        errors_(0), cancelled_(0), token_(source_.token())
+    {
+      children_.reserve(n);
+    }
+
+    task_group(task_group const&) = delete;
+    task_group& operator=(task_group const&) = delete;
+
+    ~task_group()
+    {
+      wait();
+      for (std::size_t i = 0; i < children_.size(); ++i)
+        if (done_[i])
+          value(i).~T();
+      for (error_node* p = errors_.load(std::memory_order_acquire); p;)
+      {
+        error_node* next = p->next;
+        delete p;
+        p = next;
+      }
+    }
+
+    // Returns the index of the child. Throws std::length_error past the
+    // size given to the constructor.
+    template <class F>
+    std::size_t spawn(F&& f)
+    {
+      std::size_t const i = children_.size();
+      if (i == capacity_)
+        throw std::length_error("task_group: too many children");
+      children_.push_back(pool_.submit<E>(child<typename std::decay<F>::type>(this, i, std::forward<F>(f))));
+      return i;
+    }
+
+    cancellation_token const& token() const BOOST_NOEXCEPT
+    {
+      return token_;
+    }
+
+    void cancel()
+    {
+      source_.request_cancellation();
+    }
+
+    // Waits for the children and returns their values by index, or their
+    // errors. Can be called once.
+    result_type join()
+    {
+      wait();
+      error_node* list = errors_.exchange(0, std::memory_order_acquire);
+      std::size_t const cancelled = cancelled_.load(std::memory_order_relaxed);
+      if (list || cancelled)
+      {
+        typename aggregate_error<E>::container_type errors;
+        while (list)
+        {
+          typename aggregate_error<E>::entry e = { list->index, std::move(list->error) };
+          errors.push_back(std::move(e));
+          error_node* next = list->next;
+          delete list;
+          list = next;
+        }
+        std::sort(errors.begin(), errors.end(),
+          [](typename aggregate_error<E>::entry const& x, typename aggregate_error<E>::entry const& y)
+          {
+            return x.index < y.index;
+          });
+        return make_unexpected(aggregate_error<E>(std::move(errors), cancelled));
+      }
+      std::vector<T> values;
+      values.reserve(children_.size());
+      for (std::size_t i = 0; i < children_.size(); ++i)
+      {
+        values.push_back(std::move(value(i)));
+        value(i).~T();
+        done_[i] = false;
+      }
+      return std::move(values);
+    }
+
+  private:
+    typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type slot;
+
+    struct error_node
+    {
+      std::size_t index;
+      E error;
+      error_node* next;
+    };
+
+    template <class F>
+    struct child
+    {
+      child(task_group* g, std::size_t i, F&& f) : group(g), index(i), fct(std::move(f)) {}
+      child(task_group* g, std::size_t i, F const& f) : group(g), index(i), fct(f) {}
+
+      void operator()()
+      {
+        if (group->token_.is_cancellation_requested())
+        {
+          group->cancelled_.fetch_add(1, std::memory_order_relaxed);
+          return;
+        }
+        expected_detail::child_call<F> call = { &fct, &group->token_ };
+        expected<T, E> r = expected_detail::call_task<expected<T, E> >(call);
+        if (r.valid())
+        {
+          new (&group->slots_[index]) T(std::move(*r));
+          group->done_[index] = true;
+        }
+        else
+          group->fail(index, std::move(r.error()));
+      }
+
+      task_group* group;
+      std::size_t index;
+      F fct;
+    };
+
+    T& value(std::size_t i)
+    {
+      return *reinterpret_cast<T*>(&slots_[i]);
+    }
+
+    void fail(std::size_t i, E&& e)
+    {
+      error_node* node = new error_node{ i, std::move(e), errors_.load(std::memory_order_relaxed) };
+      while (! errors_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+        ;
+      source_.request_cancellation();
+    }
+
+    // The handles publish what the children wrote.
+    void wait()
+    {
+      for (std::size_t i = 0; i < children_.size(); ++i)
+        if (children_[i].valid())
+          children_[i].wait();
+    }
+
+    work_stealing_pool& pool_;
+    std::size_t capacity_;
+    std::unique_ptr<slot[]> slots_;
+    std::unique_ptr<bool[]> done_;
+    std::vector<task_handle<void, E> > children_;
+    std::atomic<error_node*> errors_;
+    std::atomic<std::size_t> cancelled_;
+    cancellation_source source_;
+    cancellation_token token_;
+  };
+
+} // namespace boost
+
+#endif // BOOST_EXPECTED_TASK_GROUP_HPP
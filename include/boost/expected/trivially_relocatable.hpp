@@ -0,0 +1,96 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_TRIVIALLY_RELOCATABLE_HPP
+#define BOOST_EXPECTED_TRIVIALLY_RELOCATABLE_HPP
+
+#include <boost/expected/config.hpp>
+#include <boost/expected/detail/is_trivially_copyable.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace boost
+{
+  // A type is trivially relocatable when moving an object to new storage and
+  // destroying the source is the same as copying its bytes, i.e. the object
+  // has no pointer to itself and no registration anywhere by address.
+  // Specialize it for your own types.
+  template <class T>
+  struct is_trivially_relocatable : expected_detail::is_trivially_copyable<T> {};
+
+  template <class T>
+  struct is_trivially_relocatable<T const> : is_trivially_relocatable<T> {};
+
+  template <class T, class D>
+  struct is_trivially_relocatable<std::unique_ptr<T, D>> : is_trivially_relocatable<D> {};
+
+  template <class T>
+  struct is_trivially_relocatable<std::shared_ptr<T>> : std::true_type {};
+
+  template <class T>
+  struct is_trivially_relocatable<std::weak_ptr<T>> : std::true_type {};
+
+  template <>
+  struct is_trivially_relocatable<std::exception_ptr> : std::true_type {};
+
+#if defined _LIBCPP_VERSION
+  // libstdc++ strings point to their own small buffer, libc++ ones do not.
+  template <class C, class Traits, class A>
+  struct is_trivially_relocatable<std::basic_string<C, Traits, A>> : is_trivially_relocatable<A> {};
+#endif
+
+namespace expected_detail
+{
+  template <class T>
+  T* uninitialized_relocate(T* first, T* last, T* dest, std::true_type)
+  {
+    std::size_t const n = static_cast<std::size_t>(last - first);
+    if (n != 0)
+      std::memmove(static_cast<void*>(dest), static_cast<void const*>(first), n * sizeof(T));
+    return dest + n;
+  }
+
+  template <class T>
+  T* uninitialized_relocate(T* first, T* last, T* dest, std::false_type)
+  {
+    static_assert(std::is_nothrow_move_constructible<T>::value,
+        "uninitialized_relocate requires a trivially relocatable or nothrow move constructible type");
+    for (; first != last; ++first, ++dest)
+    {
+      ::new (static_cast<void*>(dest)) T(std::move(*first));
+      first->~T();
+    }
+    return dest;
+  }
+} // namespace expected_detail
+
+  // Moves the objects of [first, last) to the uninitialized storage starting
+  // at dest and ends their lifetime in the source, which becomes raw storage.
+  // Trivially relocatable objects are copied with memmove, so the ranges can
+  // overlap if dest <= first. Returns the end of the destination range.
+  template <class T>
+  T* uninitialized_relocate(T* first, T* last, T* dest)
+  {
+    return expected_detail::uninitialized_relocate(first, last, dest,
+        std::integral_constant<bool, is_trivially_relocatable<T>::value>());
+  }
+
+  // Same for a single object.
+  template <class T>
+  T* relocate_at(T* source, T* dest)
+  {
+    return uninitialized_relocate(source, source + 1, dest) - 1;
+  }
+
+} // namespace boost
+
+#endif // BOOST_EXPECTED_TRIVIALLY_RELOCATABLE_HPP
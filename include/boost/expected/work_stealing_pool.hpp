@@ -0,0 +1,742 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_EXPECTED_WORK_STEALING_POOL_HPP
+#define BOOST_EXPECTED_WORK_STEALING_POOL_HPP
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/error_traits.hpp>
+#include <boost/expected/detail/atomic_wait.hpp>
+#include <boost/expected/detail/ws_deque.hpp>
+#include <boost/functional/detail/index_sequence.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace boost
+{
+  class work_stealing_pool;
+  template <class T, class E = std::exception_ptr>
+  class task_handle;
+
+namespace expected_detail
+{
+  // Unit of work run by a pool worker, or inline by the task it continues.
+  class pool_task
+  {
+  public:
+    virtual void run() = 0;
+  protected:
+    ~pool_task() {}
+  };
+
+  // Completion word and reference count of a task result. cont_ is null
+  // while pending, waiting_tag() once a thread blocks on it, the attached
+  // continuation if there is one, and `this` once the result is set.
+  class task_state_base
+  {
+  public:
+    explicit task_state_base(unsigned refs) : refs_(refs), cont_(0) {}
+    task_state_base(task_state_base const&) = delete;
+    task_state_base& operator=(task_state_base const&) = delete;
+    virtual ~task_state_base() {}
+
+    void retain() BOOST_NOEXCEPT
+    {
+      refs_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() BOOST_NOEXCEPT
+    {
+      if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+    }
+
+    bool is_ready() const BOOST_NOEXCEPT
+    {
+      return cont_.load(std::memory_order_acquire) == this;
+    }
+
+    // Defined after work_stealing_pool, as a worker helps while waiting.
+    void wait();
+
+    // Runs k when the result is set, inline if it already is. At most one
+    // continuation, and not together with wait().
+    void attach(pool_task* k)
+    {
+      void* c = 0;
+      if (! cont_.compare_exchange_strong(c, k, std::memory_order_acq_rel, std::memory_order_acquire))
+        k->run();
+    }
+
+  protected:
+    // To be called once the result is constructed.
+    void ready()
+    {
+      void* const c = cont_.exchange(this, std::memory_order_acq_rel);
+      if (c == waiting_tag())
+        atomic_notify_all(cont_);
+      else if (c != 0)
+        static_cast<pool_task*>(c)->run();
+    }
+
+  private:
+    static void* waiting_tag() BOOST_NOEXCEPT
+    {
+      static char tag;
+      return &tag;
+    }
+
+    void block()
+    {
+      void* c = 0;
+      cont_.compare_exchange_strong(c, waiting_tag(), std::memory_order_acquire);
+      while ((c = cont_.load(std::memory_order_acquire)) != this)
+        atomic_wait(cont_, c);
+    }
+
+    std::atomic<unsigned> refs_;
+    std::atomic<void*> cont_;
+  };
+
+  template <class T, class E>
+  class task_state : public task_state_base
+  {
+  public:
+    typedef expected<T, E> result_type;
+
+    explicit task_state(unsigned refs) : task_state_base(refs) {}
+
+    ~task_state()
+    {
+      if (is_ready())
+        result().~result_type();
+    }
+
+    result_type& result() BOOST_NOEXCEPT
+    {
+      return *reinterpret_cast<result_type*>(&storage_);
+    }
+
+    void complete(result_type&& r)
+    {
+      ::new (static_cast<void*>(&storage_)) result_type(std::move(r));
+      ready();
+    }
+
+  private:
+    typename std::aligned_storage<sizeof(result_type), alignof(result_type)>::type storage_;
+  };
+
+  // The result of a task returning R: R itself when it is an expected,
+  // expected<R, E> otherwise.
+  template <class R, class E>
+  struct task_result
+  {
+    typedef expected<typename std::decay<R>::type, E> type;
+  };
+  template <class T, class G, class E>
+  struct task_result<expected<T, G>, E>
+  {
+    typedef expected<T, G> type;
+  };
+
+  template <class R>
+  struct handle_for
+  {
+    typedef task_handle<typename R::value_type, typename R::error_type> type;
+  };
+
+  template <class Result, class F>
+  Result call_task(F& f, std::true_type /*returns expected*/, std::false_type)
+  {
+    return f();
+  }
+  template <class Result, class F>
+  Result call_task(F& f, std::false_type, std::true_type /*returns void*/)
+  {
+    f();
+    return Result(in_place_t{});
+  }
+  template <class Result, class F>
+  Result call_task(F& f, std::false_type, std::false_type)
+  {
+    return Result(f());
+  }
+
+  // Calls f, the exceptions becoming the error through error_traits.
+  template <class Result, class F>
+  Result call_task(F& f)
+  {
+    typedef typename std::result_of<F()>::type R;
+    try
+    {
+      return call_task<Result>(f, is_expected<R>(), std::is_void<R>());
+    }
+    catch (...)
+    {
+      return make_unexpected(error_traits<typename Result::error_type>::make_error_from_current_exception());
+    }
+  }
+
+  // A task and its result in a single allocation. The references are held
+  // by the runner and by the handle.
+  template <class T, class E, class F>
+  class callable_task : public task_state<T, E>, public pool_task
+  {
+  public:
+    explicit callable_task(F&& f) : task_state<T, E>(2), f_(std::move(f)) {}
+
+    void run()
+    {
+      this->complete(call_task<expected<T, E> >(f_));
+      this->release();
+    }
+
+  private:
+    F f_;
+  };
+
+  // Fire and forget task. As for std::thread, an exception escaping f
+  // calls std::terminate.
+  template <class F>
+  class function_task final : public pool_task
+  {
+  public:
+    explicit function_task(F&& f) : f_(std::move(f)) {}
+
+    void run() BOOST_NOEXCEPT
+    {
+      f_();
+      delete this;
+    }
+
+  private:
+    F f_;
+  };
+
+  // Calls f with the result of the continued task, that it owns.
+  template <class T, class E, class F>
+  struct continuation
+  {
+    typename std::result_of<F(expected<T, E>)>::type operator()()
+    {
+      return f(std::move(parent->result()));
+    }
+
+    continuation(F&& fn, task_state<T, E>* p) : f(std::move(fn)), parent(p) {}
+    continuation(continuation&& x) : f(std::move(x.f)), parent(x.parent)
+    {
+      x.parent = 0;
+    }
+    ~continuation()
+    {
+      if (parent)
+        parent->release();
+    }
+
+    F f;
+    task_state<T, E>* parent;
+  };
+
+  template <class E, class ...T>
+  class when_all_state : public task_state<std::tuple<T...>, E>
+  {
+    typedef task_state<std::tuple<T...>, E> base_type;
+    typedef std::tuple<task_state<T, E>*...> children_type;
+    typedef functional::detail::index_sequence_for<T...> indices;
+
+    struct arm : pool_task
+    {
+      void run()
+      {
+        owner->arrive();
+      }
+      when_all_state* owner;
+    };
+
+  public:
+    // References: the handle, and the children until the last one is ready.
+    explicit when_all_state(task_state<T, E>*... children)
+      : base_type(2), children_(children...), pending_(sizeof...(T))
+    {}
+
+    void start()
+    {
+      start(indices());
+    }
+
+  private:
+    template <std::size_t ...I>
+    void start(functional::detail::index_sequence<I...>)
+    {
+      int dummy[] = { (arms_[I].owner = this, std::get<I>(children_)->attach(&arms_[I]), 0)... };
+      (void)dummy;
+    }
+
+    template <std::size_t ...I>
+    void release_children(functional::detail::index_sequence<I...>)
+    {
+      int dummy[] = { (std::get<I>(children_)->release(), 0)... };
+      (void)dummy;
+    }
+
+    void arrive()
+    {
+      if (pending_.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        return;
+      typename base_type::result_type r(collect(indices()));
+      release_children(indices());
+      this->complete(std::move(r));
+      this->release();
+    }
+
+    // The values, or the error of the first failed child in argument order.
+    template <std::size_t ...I>
+    typename base_type::result_type collect(functional::detail::index_sequence<I...>)
+    {
+      E* error = 0;
+      int dummy[] = { (error == 0 && ! std::get<I>(children_)->result().valid()
+          ? (error = &std::get<I>(children_)->result().error(), 0) : 0)... };
+      (void)dummy;
+      if (error)
+        return make_unexpected(std::move(*error));
+      return typename base_type::result_type(in_place_t{}, std::move(*std::get<I>(children_)->result())...);
+    }
+
+    children_type children_;
+    arm arms_[sizeof...(T)];
+    std::atomic<std::size_t> pending_;
+  };
+
+  template <class T, class E>
+  class when_any_state : public task_state<T, E>
+  {
+    typedef task_state<T, E> base_type;
+
+    struct arm : pool_task
+    {
+      void run()
+      {
+        owner->arrive(child);
+      }
+      when_any_state* owner;
+      task_state<T, E>* child;
+    };
+
+  public:
+    // References: the handle, and one per child still pending.
+    explicit when_any_state(std::vector<task_state<T, E>*> const& children)
+      : base_type(unsigned(children.size() + 1)), arms_(children.size()),
+        pending_(children.size()), done_(false)
+    {
+      for (std::size_t i = 0; i < children.size(); ++i)
+      {
+        arms_[i].owner = this;
+        arms_[i].child = children[i];
+      }
+    }
+
+    void start()
+    {
+      for (std::size_t i = 0; i < arms_.size(); ++i)
+        arms_[i].child->attach(&arms_[i]);
+    }
+
+  private:
+    // The first value wins; if every child failed, the last error.
+    void arrive(task_state<T, E>* child)
+    {
+      bool const last = pending_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+      if ((child->result().valid() || last) && ! done_.exchange(true, std::memory_order_acq_rel))
+        this->complete(std::move(child->result()));
+      child->release();
+      this->release();
+    }
+
+    std::vector<arm> arms_;
+    std::atomic<std::size_t> pending_;
+    std::atomic<bool> done_;
+  };
+
+  inline void help_while_pending(task_state_base& state);
+
+} // namespace expected_detail
+
+  // Handle on the result of a task submitted to a work_stealing_pool. As
+  // a future, get() waits and moves the result out; a pool worker waiting
+  // runs other queued tasks meanwhile.
+  template <class T, class E>
+  class task_handle
+  {
+    typedef expected_detail::task_state<T, E> state_type;
+  public:
+    typedef expected<T, E> result_type;
+    typedef T value_type;
+    typedef E error_type;
+
+    task_handle() BOOST_NOEXCEPT : state_(0) {}
+
+    task_handle(task_handle&& x) BOOST_NOEXCEPT : state_(x.state_)
+    {
+      x.state_ = 0;
+    }
+
+    task_handle& operator=(task_handle&& x) BOOST_NOEXCEPT
+    {
+      if (this != &x)
+      {
+        reset();
+        state_ = x.state_;
+        x.state_ = 0;
+      }
+      return *this;
+    }
+
+    task_handle(task_handle const&) = delete;
+    task_handle& operator=(task_handle const&) = delete;
+
+    ~task_handle()
+    {
+      reset();
+    }
+
+    // Whether the handle refers to a result, i.e. neither get() nor then()
+    // nor a when_all/when_any consumed it.
+    bool valid() const BOOST_NOEXCEPT
+    {
+      return state_ != 0;
+    }
+
+    bool is_ready() const BOOST_NOEXCEPT
+    {
+      return state_ != 0 && state_->is_ready();
+    }
+
+    void wait()
+    {
+      state().wait();
+    }
+
+    // Throws std::future_error(no_state) on an invalid handle.
+    result_type get()
+    {
+      state().wait();
+      result_type r(std::move(state_->result()));
+      reset();
+      return r;
+    }
+
+    // Returns the handle of f(expected<T, E>), called inline by the thread
+    // completing this task, or by the calling one if it is already ready.
+    // The result type follows expected::then: an expected returned as is,
+    // void giving expected<void, E> and any other U expected<U, E>.
+    template <class F>
+    typename expected_detail::handle_for<
+      typename expected_detail::task_result<typename std::result_of<F(result_type)>::type, E>::type
+    >::type
+    then(F f)
+    {
+      typedef typename expected_detail::task_result<typename std::result_of<F(result_type)>::type, E>::type result;
+      typedef expected_detail::continuation<T, E, F> continuation;
+      typedef expected_detail::callable_task<typename result::value_type, typename result::error_type, continuation> task;
+
+      state_type* parent = &state();
+      state_ = 0;
+      task* k = new task(continuation(std::move(f), parent));
+      typename expected_detail::handle_for<result>::type h(k);
+      parent->attach(k);
+      return h;
+    }
+
+  private:
+    friend class work_stealing_pool;
+    template <class U, class G> friend class task_handle;
+    template <class G, class ...U>
+    friend task_handle<std::tuple<U...>, G> when_all(task_handle<U, G>&&... hs);
+    template <class U, class G, class ...V>
+    friend task_handle<U, G> when_any(task_handle<U, G>&& h, task_handle<V, G>&&... hs);
+
+    explicit task_handle(state_type* s) BOOST_NOEXCEPT : state_(s) {}
+
+    state_type& state()
+    {
+      if (! state_)
+        throw std::future_error(std::future_errc::no_state);
+      return *state_;
+    }
+
+    state_type* release_state() BOOST_NOEXCEPT
+    {
+      state_type* s = state_;
+      state_ = 0;
+      return s;
+    }
+
+    void reset() BOOST_NOEXCEPT
+    {
+      if (state_)
+      {
+        state_->release();
+        state_ = 0;
+      }
+    }
+
+    state_type* state_;
+  };
+
+  // Fixed size pool of threads each owning a Chase-Lev deque. Tasks
+  // submitted by a worker go to its own deque and are run in LIFO order;
+  // idle workers steal the oldest tasks of the others. Tasks submitted from
+  // other threads go to a shared queue. Idle workers sleep on an epoch
+  // counter bumped by the submitters only when someone sleeps.
+  class work_stealing_pool
+  {
+  public:
+    // 0 threads uses std::thread::hardware_concurrency().
+    explicit work_stealing_pool(std::size_t threads = 0)
+      : injected_size_(0), sleepers_(0), epoch_(0), stop_(false)
+    {
+      if (threads == 0)
+        threads = (std::max)(std::thread::hardware_concurrency(), 1u);
+      workers_.reserve(threads);
+      for (std::size_t i = 0; i < threads; ++i)
+        workers_.push_back(std::unique_ptr<worker>(new worker(this, unsigned(i + 1))));
+      for (std::size_t i = 0; i < threads; ++i)
+        workers_[i]->thread = std::thread(&work_stealing_pool::work, this, workers_[i].get());
+    }
+
+    work_stealing_pool(work_stealing_pool const&) = delete;
+    work_stealing_pool& operator=(work_stealing_pool const&) = delete;
+
+    // Runs the pending tasks, then joins the workers.
+    ~work_stealing_pool()
+    {
+      stop_.store(true, std::memory_order_seq_cst);
+      epoch_.fetch_add(1, std::memory_order_seq_cst);
+      expected_detail::atomic_notify_all(epoch_);
+      for (std::size_t i = 0; i < workers_.size(); ++i)
+        workers_[i]->thread.join();
+    }
+
+    std::size_t size() const BOOST_NOEXCEPT
+    {
+      return workers_.size();
+    }
+
+    // Runs f() on the pool; the handle yields f() as an expected: as is if
+    // f returns an expected, expected<void, E> if it returns void,
+    // expected<R, E> otherwise. An exception thrown by f becomes the error
+    // through error_traits.
+    template <class E = std::exception_ptr, class F>
+    typename expected_detail::handle_for<
+      typename expected_detail::task_result<typename std::result_of<typename std::decay<F>::type()>::type, E>::type
+    >::type
+    submit(F&& f)
+    {
+      typedef typename std::decay<F>::type function;
+      typedef typename expected_detail::task_result<typename std::result_of<function()>::type, E>::type result;
+      typedef expected_detail::callable_task<typename result::value_type, typename result::error_type, function> task;
+
+      task* t = new task(function(std::forward<F>(f)));
+      typename expected_detail::handle_for<result>::type h(t);
+      schedule(t);
+      return h;
+    }
+
+    // Runs f() on the pool, without a result. An exception escaping f calls
+    // std::terminate.
+    template <class F>
+    void execute(F&& f)
+    {
+      typedef typename std::decay<F>::type function;
+      schedule(new expected_detail::function_task<function>(function(std::forward<F>(f))));
+    }
+
+  private:
+    friend void expected_detail::help_while_pending(expected_detail::task_state_base&);
+
+    struct worker
+    {
+      worker(work_stealing_pool* p, unsigned s) : pool(p), seed(s) {}
+
+      expected_detail::ws_deque<expected_detail::pool_task*> tasks;
+      work_stealing_pool* pool;
+      unsigned seed;
+      std::thread thread;
+    };
+
+    static worker*& current() BOOST_NOEXCEPT
+    {
+      static thread_local worker* w = 0;
+      return w;
+    }
+
+    void schedule(expected_detail::pool_task* t)
+    {
+      worker* const w = current();
+      if (w && w->pool == this)
+        w->tasks.push(t);
+      else
+      {
+        std::lock_guard<std::mutex> lock(injected_mutex_);
+        injected_.push_back(t);
+        injected_size_.fetch_add(1, std::memory_order_relaxed);
+      }
+      // pairs with the fence of a worker going to sleep
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (sleepers_.load(std::memory_order_relaxed) != 0)
+      {
+        epoch_.fetch_add(1, std::memory_order_release);
+        expected_detail::atomic_notify_all(epoch_);
+      }
+    }
+
+    expected_detail::pool_task* find_task(worker* self)
+    {
+      if (expected_detail::pool_task* t = self->tasks.pop())
+        return t;
+      if (injected_size_.load(std::memory_order_relaxed) != 0)
+      {
+        std::lock_guard<std::mutex> lock(injected_mutex_);
+        if (! injected_.empty())
+        {
+          expected_detail::pool_task* t = injected_.front();
+          injected_.pop_front();
+          injected_size_.fetch_sub(1, std::memory_order_relaxed);
+          return t;
+        }
+      }
+      // xorshift, to spread the thieves over the victims
+      self->seed ^= self->seed << 13;
+      self->seed ^= self->seed >> 17;
+      self->seed ^= self->seed << 5;
+      std::size_t const n = workers_.size();
+      std::size_t const first = self->seed % n;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        worker* victim = workers_[(first + i) % n].get();
+        if (victim == self)
+          continue;
+        if (expected_detail::pool_task* t = victim->tasks.steal())
+          return t;
+      }
+      return 0;
+    }
+
+    void work(worker* self)
+    {
+      current() = self;
+      for (;;)
+      {
+        if (expected_detail::pool_task* t = find_task(self))
+        {
+          t->run();
+          continue;
+        }
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        unsigned const epoch = epoch_.load(std::memory_order_seq_cst);
+        expected_detail::pool_task* t = find_task(self);
+        if (! t)
+        {
+          if (stop_.load(std::memory_order_seq_cst))
+          {
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            return;
+          }
+          expected_detail::atomic_wait(epoch_, epoch);
+        }
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        if (t)
+          t->run();
+      }
+    }
+
+    std::vector<std::unique_ptr<worker> > workers_;
+    std::mutex injected_mutex_;
+    std::deque<expected_detail::pool_task*> injected_;
+    std::atomic<std::size_t> injected_size_;
+    std::atomic<unsigned> sleepers_;
+    std::atomic<unsigned> epoch_;
+    std::atomic<bool> stop_;
+  };
+
+namespace expected_detail
+{
+  // A worker runs other tasks while the result is pending, so that nested
+  // fork/join does not exhaust the pool; it blocks once there are none.
+  inline void help_while_pending(task_state_base& state)
+  {
+    if (work_stealing_pool::worker* self = work_stealing_pool::current())
+    {
+      while (! state.is_ready())
+      {
+        pool_task* t = self->pool->find_task(self);
+        if (! t)
+          break;
+        t->run();
+      }
+    }
+  }
+
+  inline void task_state_base::wait()
+  {
+    if (is_ready())
+      return;
+    help_while_pending(*this);
+    block();
+  }
+} // namespace expected_detail
+
+  // Handle of the tuple of the values of hs, or of the error of the first
+  // of them that failed, in argument order. Consumes the handles.
+  template <class E, class ...T>
+  task_handle<std::tuple<T...>, E> when_all(task_handle<T, E>&&... hs)
+  {
+    static_assert(sizeof...(T) != 0, "when_all needs at least one handle");
+    typedef expected_detail::when_all_state<E, T...> state;
+    state* s = new state(&hs.state()...);
+    int dummy[] = { (hs.release_state(), 0)... };
+    (void)dummy;
+    task_handle<std::tuple<T...>, E> h(s);
+    s->start();
+    return h;
+  }
+
+  // Handle of the first value among hs, or of the last error if they all
+  // failed. Consumes the handles.
+  template <class T, class E, class ...U>
+  task_handle<T, E> when_any(task_handle<T, E>&& h, task_handle<U, E>&&... hs)
+  {
+    typedef expected_detail::when_any_state<T, E> state;
+    std::vector<expected_detail::task_state<T, E>*> children;
+    children.reserve(1 + sizeof...(U));
+    children.push_back(&h.state());
+    int dummy[] = { 0, (children.push_back(&hs.state()), 0)... };
+    (void)dummy;
+    state* s = new state(children);
+    h.release_state();
+    int dummy2[] = { 0, (hs.release_state(), 0)... };
+    (void)dummy2;
+    task_handle<T, E> r(s);
+    s->start();
+    return r;
+  }
+
+} // namespace boost
+
+#endif // BOOST_EXPECTED_WORK_STEALING_POOL_HPP
@@ -0,0 +1,56 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_FUNCTIONAL_DETAIL_INDEX_SEQUENCE_HPP
+#define BOOST_FUNCTIONAL_DETAIL_INDEX_SEQUENCE_HPP
+
+#include <cstddef>
+
+namespace boost
+{
+namespace functional
+{
+namespace detail
+{
+  // C++11 replacement for std::index_sequence.
+  template <std::size_t ...I>
+  struct index_sequence
+  {
+    typedef index_sequence type;
+    static constexpr std::size_t size() { return sizeof...(I); }
+  };
+
+  template <class S1, class S2>
+  struct concat_index_sequence;
+
+  template <std::size_t ...I1, std::size_t ...I2>
+  struct concat_index_sequence<index_sequence<I1...>, index_sequence<I2...>>
+    : index_sequence<I1..., (sizeof...(I1) + I2)...>
+  {};
+
+  // Built by halves, so the instantiation depth is logarithmic in N.
+  template <std::size_t N>
+  struct make_index_sequence_impl
+    : concat_index_sequence<
+        typename make_index_sequence_impl<N / 2>::type,
+        typename make_index_sequence_impl<N - N / 2>::type
+      >
+  {};
+  template <>
+  struct make_index_sequence_impl<0> : index_sequence<> {};
+  template <>
+  struct make_index_sequence_impl<1> : index_sequence<0> {};
+
+  template <std::size_t N>
+  using make_index_sequence = typename make_index_sequence_impl<N>::type;
+
+  template <class ...T>
+  using index_sequence_for = make_index_sequence<sizeof...(T)>;
+
+} // namespace detail
+} // namespace functional
+} // namespace boost
+
+#endif // BOOST_FUNCTIONAL_DETAIL_INDEX_SEQUENCE_HPP
@@ -0,0 +1,79 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_FUNCTIONAL_FUNCTION_REF_HPP
+#define BOOST_FUNCTIONAL_FUNCTION_REF_HPP
+
+#include <boost/config.hpp>
+#include <boost/functional/type_traits_t.hpp>
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace boost
+{
+namespace functional
+{
+  template <class Sig>
+  class function_ref;
+
+  // A non-owning reference to a callable, for parameters that must not be
+  // templates: two words, never allocating, and as cheap to pass as a
+  // pointer. The callable must outlive the function_ref.
+  template <class R, class ...Args>
+  class function_ref<R(Args...)>
+  {
+    union target
+    {
+      void* object;
+      void (*function)();
+    };
+
+  public:
+    template <class F,
+      class = typename std::enable_if<
+           ! std::is_same<decay_t<F>, function_ref>::value
+        && ! std::is_function<typename std::remove_reference<F>::type>::value
+        && std::is_convertible<result_of_t<F&(Args...)>, R>::value
+      >::type
+    >
+    function_ref(F&& f) BOOST_NOEXCEPT
+      : call_(&call_object<typename std::remove_reference<F>::type>)
+    {
+      target_.object = const_cast<void*>(static_cast<void const*>(std::addressof(f)));
+    }
+
+    function_ref(R (*f)(Args...)) BOOST_NOEXCEPT
+      : call_(&call_function)
+    {
+      target_.function = reinterpret_cast<void (*)()>(f);
+    }
+
+    R operator()(Args... args) const
+    {
+      return call_(target_, std::forward<Args>(args)...);
+    }
+
+  private:
+    template <class F>
+    static R call_object(target t, Args... args)
+    {
+      return (*static_cast<F*>(t.object))(std::forward<Args>(args)...);
+    }
+
+    static R call_function(target t, Args... args)
+    {
+      return reinterpret_cast<R (*)(Args...)>(t.function)(std::forward<Args>(args)...);
+    }
+
+    target target_;
+    R (*call_)(target, Args...);
+  };
+
+} // namespace functional
+} // namespace boost
+
+#endif // BOOST_FUNCTIONAL_FUNCTION_REF_HPP
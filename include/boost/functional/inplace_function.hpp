@@ -0,0 +1,145 @@
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+// (C) Copyright 2015 Vicente J. Botet Escriba
+
+#ifndef BOOST_FUNCTIONAL_INPLACE_FUNCTION_HPP
+#define BOOST_FUNCTIONAL_INPLACE_FUNCTION_HPP
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/functional/type_traits_t.hpp>
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace boost
+{
+namespace functional
+{
+  template <class Sig, std::size_t Capacity = 4 * sizeof(void*),
+      std::size_t Align = std::alignment_of<std::max_align_t>::value>
+  class inplace_function;
+
+  // An owning, move-only callable stored in Capacity bytes inside the
+  // object, for where a callable must be kept without knowing its type, as
+  // in a list of handlers: unlike std::function, it never allocates. A
+  // callable that does not fit does not compile.
+  template <class R, class ...Args, std::size_t Capacity, std::size_t Align>
+  class inplace_function<R(Args...), Capacity, Align>
+  {
+    typedef typename std::aligned_storage<Capacity, Align>::type storage_type;
+
+    struct vtable
+    {
+      R (*call)(storage_type&, Args&&...);
+      void (*move)(storage_type& to, storage_type& from);
+      void (*destroy)(storage_type&);
+    };
+
+    template <class F>
+    struct vtable_for
+    {
+      static R call(storage_type& s, Args&&... args)
+      {
+        return (*reinterpret_cast<F*>(&s))(std::forward<Args>(args)...);
+      }
+      static void move(storage_type& to, storage_type& from)
+      {
+        ::new (static_cast<void*>(&to)) F(std::move(*reinterpret_cast<F*>(&from)));
+        reinterpret_cast<F*>(&from)->~F();
+      }
+      static void destroy(storage_type& s)
+      {
+        reinterpret_cast<F*>(&s)->~F();
+      }
+      static const vtable value;
+    };
+
+  public:
+    // Whether a callable of type F can be held.
+    template <class F>
+    struct fits
+      : std::integral_constant<bool, sizeof(F) <= Capacity && Align % std::alignment_of<F>::value == 0>
+    {};
+
+    inplace_function() BOOST_NOEXCEPT : vtable_(0) {}
+
+    template <class F,
+      class = typename std::enable_if<
+           ! std::is_same<decay_t<F>, inplace_function>::value
+        && std::is_convertible<result_of_t<decay_t<F>&(Args...)>, R>::value
+      >::type
+    >
+    inplace_function(F&& f)
+      : vtable_(&vtable_for<decay_t<F> >::value)
+    {
+      static_assert(fits<decay_t<F> >::value, "inplace_function: the callable does not fit");
+      ::new (static_cast<void*>(&storage_)) decay_t<F>(std::forward<F>(f));
+    }
+
+    inplace_function(inplace_function&& x)
+      : vtable_(x.vtable_)
+    {
+      if (vtable_)
+        vtable_->move(storage_, x.storage_);
+      x.vtable_ = 0;
+    }
+
+    inplace_function& operator=(inplace_function&& x)
+    {
+      if (this != &x)
+      {
+        reset();
+        if (x.vtable_)
+          x.vtable_->move(storage_, x.storage_);
+        vtable_ = x.vtable_;
+        x.vtable_ = 0;
+      }
+      return *this;
+    }
+
+    inplace_function(inplace_function const&) = delete;
+    inplace_function& operator=(inplace_function const&) = delete;
+
+    ~inplace_function()
+    {
+      reset();
+    }
+
+    explicit operator bool() const BOOST_NOEXCEPT
+    {
+      return vtable_ != 0;
+    }
+
+    R operator()(Args... args)
+    {
+      BOOST_ASSERT(vtable_);
+      return vtable_->call(storage_, std::forward<Args>(args)...);
+    }
+
+  private:
+    void reset() BOOST_NOEXCEPT
+    {
+      if (vtable_)
+        vtable_->destroy(storage_);
+      vtable_ = 0;
+    }
+
+    storage_type storage_;
+    vtable const* vtable_;
+  };
+
+  template <class R, class ...Args, std::size_t Capacity, std::size_t Align>
+  template <class F>
+  const typename inplace_function<R(Args...), Capacity, Align>::vtable
+  inplace_function<R(Args...), Capacity, Align>::vtable_for<F>::value = {
+    &vtable_for<F>::call, &vtable_for<F>::move, &vtable_for<F>::destroy
+  };
+
+} // namespace functional
+} // namespace boost
+
+#endif // BOOST_FUNCTIONAL_INPLACE_FUNCTION_HPP
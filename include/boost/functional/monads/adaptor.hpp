@@ -10,15 +10,57 @@
 #include <boost/utility/result_of.hpp>
 #include <boost/functional/monads.hpp>
 #include <boost/expected/expected.hpp>
+#include <boost/expected/cancellation.hpp>
+#include <boost/type_traits/is_final.hpp>
+#include <type_traits>
+#include <utility>
 
 namespace boost
 {
 namespace functional
 {
+namespace detail
+{
+  // Holds a functor, as an empty base when it can be one. I tells apart
+  // two functors of the same type held by the same class.
+  template <class F, int I = 0, bool = std::is_empty<F>::value && ! boost::is_final<F>::value>
+  class functor_storage
+  {
+    F fct_;
+  public:
+    explicit functor_storage(F const& f) : fct_(f) {}
+    explicit functor_storage(F&& f) : fct_(std::move(f)) {}
+
+    F& functor() BOOST_NOEXCEPT { return fct_; }
+  };
+
+  template <class F, int I>
+  class functor_storage<F, I, true> : private F
+  {
+  public:
+    explicit functor_storage(F const& f) : F(f) {}
+    explicit functor_storage(F&& f) : F(std::move(f)) {}
+
+    F& functor() BOOST_NOEXCEPT { return *this; }
+  };
+
+  // x as an rvalue when M is one.
+  template <class M, class X>
+  typename std::conditional<std::is_lvalue_reference<M>::value, X&, X&&>::type
+  forward_like(X& x) BOOST_NOEXCEPT
+  {
+    return static_cast<typename std::conditional<std::is_lvalue_reference<M>::value, X&, X&&>::type>(x);
+  }
+} // namespace detail
 
+  // The functor is held once, and each call builds the adaptor for the type
+  // of its argument, referring to it. The argument is forwarded, so that
+  // then() moves its expected through the adaptor instead of copying it.
   template <class H>
   class adaptor_holder
+    : private detail::functor_storage<typename H::funct_type>
   {
+    typedef detail::functor_storage<typename H::funct_type> storage_type;
   public:
     typedef H holder_type;
     typedef typename H::funct_type funct_type;
@@ -28,29 +70,68 @@ namespace functional
       typedef typename H::template rebind_right<E>::type type;
     };
 
-    explicit adaptor_holder(funct_type f) :
-      fct_(f)
+    explicit adaptor_holder(funct_type const& f) :
+      storage_type(f)
+    {
+    }
+    explicit adaptor_holder(funct_type&& f) :
+      storage_type(std::move(f))
+    {
+    }
+
+    template <class E>
+    typename H::template rebind_right<decay_t<E>>::type::result_type operator()(E&& e)
+    {
+      return typename H::template rebind_right<decay_t<E>>::type(this->functor())(std::forward<E>(e));
+    }
+  };
+
+  // a | b calls b on the result of a, as one callable, so that
+  // e.then(if_valued(f) | if_unexpected(g)) is
+  // e.then(if_valued(f)).then(if_unexpected(g)) with a single then().
+  template <class A, class B>
+  class adaptor_pipe
+    : private detail::functor_storage<A, 0>, private detail::functor_storage<B, 1>
+  {
+    typedef detail::functor_storage<A, 0> first_type;
+    typedef detail::functor_storage<B, 1> second_type;
+  public:
+    adaptor_pipe(A&& a, B&& b) :
+      first_type(std::move(a)), second_type(std::move(b))
     {
     }
 
     template <class E>
-    typename H::template rebind_right<decay_t<E>>::type::result_type operator()(E e)
+    auto operator()(E&& e)
+      -> decltype(std::declval<B&>()(std::declval<A&>()(std::forward<E>(e))))
     {
-      return typename H::template rebind_right<decay_t<E>>::type(fct_)(std::forward<E>(e));
+      return second_type::functor()(first_type::functor()(std::forward<E>(e)));
     }
-  private:
-    funct_type fct_;
   };
 
+  template <class H1, class H2>
+  inline adaptor_pipe<adaptor_holder<H1>, adaptor_holder<H2> >
+  operator|(adaptor_holder<H1> a, adaptor_holder<H2> b)
+  {
+    return adaptor_pipe<adaptor_holder<H1>, adaptor_holder<H2> >(std::move(a), std::move(b));
+  }
+
+  template <class A, class B, class H>
+  inline adaptor_pipe<adaptor_pipe<A, B>, adaptor_holder<H> >
+  operator|(adaptor_pipe<A, B> a, adaptor_holder<H> b)
+  {
+    return adaptor_pipe<adaptor_pipe<A, B>, adaptor_holder<H> >(std::move(a), std::move(b));
+  }
+
 namespace detail
 {
 
   template <class E, class F, class V>
   class if_valued0
   {
-    F fct_;
+    F& fct_;
   public:
-    explicit if_valued0(F f) :
+    explicit if_valued0(F& f) :
       fct_(f)
     {
     }
@@ -58,16 +139,17 @@ namespace detail
     typedef rebindable::value_type<E> value_type;
     typedef typename rebindable::rebind<E, typename std::result_of<F(value_type)>::type>::type result_type;
 
-    result_type operator()(E e)
+    template <class M>
+    result_type operator()(M&& e)
     {
       using namespace ::boost::functional::errored;
       if (has_value(e))
       {
-        return result_type(fct_(deref(e)));
+        return result_type(fct_(forward_like<M>(deref(e))));
       }
       else
       {
-        return result_type(get_errored(e));
+        return result_type(get_errored(std::forward<M>(e)));
       }
     }
   };
@@ -75,9 +157,9 @@ namespace detail
   template <class E, class F, class R>
   class if_valued2
   {
-    F fct_;
+    F& fct_;
   public:
-    explicit if_valued2(F f) :
+    explicit if_valued2(F& f) :
       fct_(f)
     {
     }
@@ -85,7 +167,8 @@ namespace detail
     typedef void value_type;
     typedef typename rebindable::rebind<E, R>::type result_type;
 
-    result_type operator()(E e)
+    template <class M>
+    result_type operator()(M&& e)
     {
       using namespace ::boost::functional::errored;
       if (has_value(e))
@@ -94,7 +177,7 @@ namespace detail
       }
       else
       {
-        return result_type(get_errored(e));
+        return result_type(get_errored(std::forward<M>(e)));
       }
     }
   };
@@ -102,9 +185,9 @@ namespace detail
   template <class E, class F>
   class if_valued2<E, F, void>
   {
-    F fct_;
+    F& fct_;
   public:
-    explicit if_valued2(F f) :
+    explicit if_valued2(F& f) :
       fct_(f)
     {
     }
@@ -112,7 +195,8 @@ namespace detail
     typedef void value_type;
     typedef typename rebindable::rebind<E, void>::type result_type;
 
-    result_type operator()(E e)
+    template <class M>
+    result_type operator()(M&& e)
     {
       using namespace ::boost::functional::errored;
       if (has_value(e))
@@ -122,7 +206,7 @@ namespace detail
       }
       else
       {
-        return result_type(get_errored(e));
+        return result_type(get_errored(std::forward<M>(e)));
       }
     }
   };
@@ -131,7 +215,7 @@ namespace detail
   struct if_valued0<E, F, void> : if_valued2<E, F, typename std::result_of<F()>::type>
   {
 
-    explicit if_valued0(F f) :
+    explicit if_valued0(F& f) :
       if_valued2<E, F, typename std::result_of<F()>::type> (f)
     {
     }
@@ -151,39 +235,42 @@ namespace detail
 }
 
   template <class F>
-  inline adaptor_holder<detail::if_valued_adaptor<F> > if_valued(F f)
+  inline adaptor_holder<detail::if_valued_adaptor<decay_t<F>> > if_valued(F&& f)
   {
-    return adaptor_holder<detail::if_valued_adaptor<F> > (f);
+    return adaptor_holder<detail::if_valued_adaptor<decay_t<F>> > (std::forward<F>(f));
   }
 
 namespace detail
 {
 
   template <class F>
-  class ident_t
+  class ident_t : private functor_storage<F>
   {
-    F fct_;
   public:
 
-    explicit ident_t(F f) :
-      fct_(f)
+    explicit ident_t(F const& f) :
+      functor_storage<F>(f)
+    {
+    }
+    explicit ident_t(F&& f) :
+      functor_storage<F>(std::move(f))
     {
     }
 
     typedef typename std::result_of<F()>::type result_type;
 
     template <class G>
-    result_type operator()(G e)
+    result_type operator()(G&&)
     {
-      return fct_();
+      return this->functor()();
     }
   };
 }
 
   template <class F>
-  inline detail::ident_t<F> ident(F f)
+  inline detail::ident_t<decay_t<F>> ident(F&& f)
   {
-    return detail::ident_t<F>(f);
+    return detail::ident_t<decay_t<F>>(std::forward<F>(f));
   }
 
 namespace detail
@@ -192,26 +279,27 @@ namespace detail
   template <class E, class F, class V>
   class if_unexpected
   {
-    F fct_;
+    F& fct_;
   public:
     typedef F funct_type;
     typedef E result_type;
 
-    explicit if_unexpected(funct_type f) :
+    explicit if_unexpected(funct_type& f) :
       fct_(f)
     {
     }
 
-    decay_t<E> operator()(E e)
+    template <class M>
+    result_type operator()(M&& e)
     {
       using namespace ::boost::functional::errored;
       if (!has_value(e))
       {
-        return result_type(fct_(error(e)));
+        return result_type(fct_(forward_like<M>(error(e))));
       }
       else
       {
-        return std::move(e);
+        return std::forward<M>(e);
       }
     }
   };
@@ -229,9 +317,9 @@ namespace detail
 }
 
   template <class F>
-  inline adaptor_holder<detail::if_unexpected_adaptor<F> > if_unexpected(F f)
+  inline adaptor_holder<detail::if_unexpected_adaptor<decay_t<F>> > if_unexpected(F&& f)
   {
-    return adaptor_holder<detail::if_unexpected_adaptor<F> > (f);
+    return adaptor_holder<detail::if_unexpected_adaptor<decay_t<F>> > (std::forward<F>(f));
   }
 
   namespace detail
@@ -240,23 +328,24 @@ namespace detail
     template <class E, class F, class V>
     class catch_all
     {
-      F fct_;
+      F& fct_;
     public:
       typedef F funct_type;
       typedef E result_type;
 
-      explicit catch_all(funct_type f) :
+      explicit catch_all(funct_type& f) :
         fct_(f)
       {
       }
 
-      decay_t<E> operator()(E e)
+      template <class M>
+      result_type operator()(M&& e)
       {
         using namespace ::boost::functional::monad_exception;
         using namespace ::boost::functional::valued;
 
         try {
-          return fct_(value(e));
+          return fct_(forward_like<M>(value(e)));
         } catch (...) {
           return make_exception<type_constructor<E>>(std::current_exception());
         }
@@ -275,9 +364,103 @@ namespace detail
     };
   }
   template <class F>
-  inline adaptor_holder<detail::catch_all_adaptor<F> > catch_all(F f)
+  inline adaptor_holder<detail::catch_all_adaptor<decay_t<F>> > catch_all(F&& f)
+  {
+    return adaptor_holder<detail::catch_all_adaptor<decay_t<F>> > (std::forward<F>(f));
+  }
+
+  namespace detail
+  {
+
+    // The token is referenced, so that checking it costs no reference count
+    // update per step.
+    template <class F>
+    struct cancellable_function
+    {
+      F fct;
+      cancellation_token const* token;
+    };
+
+    // f's result when it is an expected, as bind, E rebound to it otherwise,
+    // as map.
+    template <class E, class R, bool = is_expected<R>::value>
+    struct cancellable_result
+    {
+      typedef typename rebindable::rebind<E, R>::type type;
+    };
+    template <class E, class R>
+    struct cancellable_result<E, R, true>
+    {
+      typedef R type;
+    };
+
+    template <class E, class F, class V>
+    class cancellable
+    {
+      cancellable_function<F>& fct_;
+    public:
+      typedef cancellable_function<F> funct_type;
+      typedef typename cancellable_result<E, typename std::result_of<F(V)>::type>::type result_type;
+
+      explicit cancellable(funct_type& f) :
+        fct_(f)
+      {
+      }
+
+      template <class M>
+      result_type operator()(M&& e)
+      {
+        using namespace ::boost::functional::errored;
+        if (! has_value(e))
+        {
+          return result_type(get_errored(std::forward<M>(e)));
+        }
+        else if (fct_.token->is_cancellation_requested())
+        {
+          return result_type(make_unexpected_cancelled<typename result_type::error_type>());
+        }
+        else
+        {
+          return call<M>(e, std::is_void<typename std::result_of<F(V)>::type>());
+        }
+      }
+
+    private:
+      template <class M>
+      result_type call(decay_t<M>& e, std::false_type)
+      {
+        using namespace ::boost::functional::errored;
+        return result_type(fct_.fct(forward_like<M>(deref(e))));
+      }
+      template <class M>
+      result_type call(decay_t<M>& e, std::true_type)
+      {
+        using namespace ::boost::functional::errored;
+        fct_.fct(forward_like<M>(deref(e)));
+        return result_type(in_place2);
+      }
+    };
+
+    template <class F>
+    struct cancellable_adaptor
+    {
+      typedef cancellable_function<F> funct_type;
+      template <class E>
+      struct rebind_right
+      {
+        typedef cancellable<E, F, rebindable::value_type<E>> type;
+      };
+    };
+  }
+
+  // As if_valued(f), but a value gives the operation_cancelled error, through
+  // error_traits, once cancellation is requested on the token. The token must
+  // outlive the adaptor, as it does when the adaptor is passed to then().
+  template <class F>
+  inline adaptor_holder<detail::cancellable_adaptor<decay_t<F>> > cancellable(F&& f, cancellation_token const& token)
   {
-    return adaptor_holder<detail::catch_all_adaptor<F> > (f);
+    detail::cancellable_function<decay_t<F>> fct = { std::forward<F>(f), &token };
+    return adaptor_holder<detail::cancellable_adaptor<decay_t<F>> > (std::move(fct));
   }
 
 }
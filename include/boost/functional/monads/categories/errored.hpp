@@ -7,16 +7,19 @@
 #define BOOST_EXPECTED_MONADS_CATEGORIES_VALUED_AND_ERRORED_HPP
 
 #include <boost/config.hpp>
+#include <boost/expected/config.hpp>
 #include <boost/expected/detail/requires.hpp>
 
 #include <boost/functional/monads/errored.hpp>
 #include <boost/functional/monads/functor.hpp>
 #include <boost/functional/monads/monad.hpp>
-#include <boost/functional/monads/algorithms/have_value.hpp>
-#include <boost/functional/monads/algorithms/first_unexpected.hpp>
 #include <boost/functional/meta.hpp>
+#include <boost/functional/detail/index_sequence.hpp>
 #include <boost/utility/enable_if.hpp>
 #include <boost/type_traits/is_same.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
 #include <type_traits>
 
 namespace boost
@@ -28,13 +31,67 @@ namespace functional
     struct errored {};
   }
 
+namespace errored_detail
+{
+  typedef std::uint_least64_t mask_type;
+
+  BOOST_CONSTEXPR mask_type all_valid(std::size_t n)
+  {
+    return n == 64 ? ~mask_type(0) : (mask_type(1) << n) - 1;
+  }
+
+  BOOST_CONSTEXPR std::size_t count_trailing_zeros(mask_type m)
+  {
+#if defined __GNUC__ || defined __clang__
+    return __builtin_ctzll(m);
+#else
+    return (m & 1) ? 0 : 1 + count_trailing_zeros(m >> 1);
+#endif
+  }
+
+  // Bit I is set when the I-th argument has a value. All the arguments are
+  // tested, without short-circuit, so there is no branch for trivial ones.
+  template <std::size_t ...I, class ...M>
+  BOOST_EXPECTED_CXX14_CONSTEXPR mask_type validity_mask(functional::detail::index_sequence<I...>, M const& ...m)
+  {
+    mask_type mask = 0;
+    int const expand[] = { 0, (mask |= mask_type(valued::has_value(m)) << I, 0)... };
+    (void)expand;
+    return mask;
+  }
+
+  template <class R, std::size_t I, class ...M>
+  BOOST_EXPECTED_CXX14_CONSTEXPR R errored_at(M&& ...m)
+  {
+    return R(errored::get_errored(std::get<I>(std::forward_as_tuple(std::forward<M>(m)...))));
+  }
+
+  // One entry per argument, returning the error of this argument.
+  template <class R, class Indexes, class ...M>
+  struct first_errored;
+
+  template <class R, std::size_t ...I, class ...M>
+  struct first_errored<R, functional::detail::index_sequence<I...>, M...>
+  {
+    typedef R (*function)(M&&...);
+    static BOOST_CONSTEXPR_OR_CONST function table[sizeof...(M)] = { &errored_at<R, I, M...>... };
+  };
+
+  template <class R, std::size_t ...I, class ...M>
+  BOOST_CONSTEXPR_OR_CONST typename first_errored<R, functional::detail::index_sequence<I...>, M...>::function
+  first_errored<R, functional::detail::index_sequence<I...>, M...>::table[sizeof...(M)];
+} // namespace errored_detail
+
   template <>
   struct functor_traits<category::errored> : functor_traits<category::default_>
   {
-
+    // The validity of all the arguments is computed in a single pass, then
+    // f is called or the error of the first invalid argument is returned,
+    // selected through a table indexed by the position of this argument.
+    // Each argument is forwarded once.
     template <class F, class M0, class ...M,
     class FR = decltype(std::declval<F>()(errored::deref(std::declval<M0>()), errored::deref(std::declval<M>())...))>
-      static BOOST_CONSTEXPR auto map(F&& f, M0&& m0, M&& ...m)
+      static BOOST_EXPECTED_CXX14_CONSTEXPR auto map(F&& f, M0&& m0, M&& ...m)
 #if !defined BOOST_MSVC || BOOST_MSVC >= 1900
       -> typename errored::rebind<decay_t<M0>, FR>::type
 #else
@@ -44,10 +101,14 @@ namespace functional
     {
       using namespace errored;
       typedef typename rebind<decay_t<M0>, FR>::type result_type;
-      return have_value(std::forward<M0>(m0), std::forward<M>(m)...)
-        ? result_type(std::forward<F>(f)(deref(std::forward<M0>(m0)), deref(std::forward<M>(m))...))
-        : first_unexpected(std::forward<M0>(m0), std::forward<M>(m)...)
-        ;
+      typedef functional::detail::make_index_sequence<1 + sizeof...(M)> indexes;
+      static_assert(1 + sizeof...(M) <= 64, "map supports at most 64 arguments");
+
+      errored_detail::mask_type const mask = errored_detail::validity_mask(indexes(), m0, m...);
+      if (BOOST_LIKELY(mask == errored_detail::all_valid(1 + sizeof...(M))))
+        return result_type(std::forward<F>(f)(deref(std::forward<M0>(m0)), deref(std::forward<M>(m))...));
+      return errored_detail::first_errored<result_type, indexes, M0, M...>::table
+          [errored_detail::count_trailing_zeros(~mask)](std::forward<M0>(m0), std::forward<M>(m)...);
     }
   };
 
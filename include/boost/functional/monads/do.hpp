@@ -7,8 +7,25 @@
 #define BOOST_FUNCTIONAL_MONAD_DO_HPP
 
 #define BOOST_PP_VARIADICS 1
-#include <boost/preprocessor.hpp>
+#include <boost/preprocessor/arithmetic/dec.hpp>
+#include <boost/preprocessor/arithmetic/div.hpp>
+#include <boost/preprocessor/arithmetic/inc.hpp>
+#include <boost/preprocessor/arithmetic/mod.hpp>
+#include <boost/preprocessor/arithmetic/mul.hpp>
+#include <boost/preprocessor/arithmetic/sub.hpp>
+#include <boost/preprocessor/cat.hpp>
+#include <boost/preprocessor/comparison/equal.hpp>
+#include <boost/preprocessor/logical/bool.hpp>
+#include <boost/preprocessor/punctuation/comma_if.hpp>
+#include <boost/preprocessor/punctuation/paren.hpp>
+#include <boost/preprocessor/repetition/repeat.hpp>
+#include <boost/preprocessor/seq/elem.hpp>
+#include <boost/preprocessor/seq/for_each_i.hpp>
+#include <boost/preprocessor/seq/size.hpp>
+#include <boost/preprocessor/variadic/to_seq.hpp>
 #include <boost/functional/monads/monad.hpp>
+#include <boost/functional/monads/errored.hpp>
+#include <utility>
 
 // Macro helpers.
 
@@ -97,4 +114,94 @@ The monad expression must be evaluated to a value implementing the Monad concept
 
 #define DO(...) DO_SEQ(BOOST_PP_VARIADIC_TO_SEQ(__VA_ARGS__))
 
+// Straight-line DO: a statement standing for return DO(...), which tests
+// each monad in turn and returns its error at once, without a lambda or
+// a bind per step.
+
+namespace boost
+{
+namespace functional
+{
+namespace do_detail
+{
+  // Called when a step throws: the exception propagates, as it does out
+  // of bind. The return type is the one of the early return.
+  template <class M>
+  auto on_exception(M const& m) -> decltype(errored::get_errored(m))
+  {
+    throw;
+  }
+} // namespace do_detail
+} // namespace functional
+} // namespace boost
+
+#define DO_RETURN_NAME(k) BOOST_PP_CAT(do_return_m, k)
+
+#if defined BOOST_EXPECTED_CATCH_EXCEPTIONS
+#define DO_RETURN_TRY try {
+#define DO_RETURN_CATCH(m) } catch (...) { return ::boost::functional::do_detail::on_exception(m); }
+#else
+#define DO_RETURN_TRY {
+#define DO_RETURN_CATCH(m) }
+#endif
+
+#define DO_RETURN_STEP_I(k, decl, mexpr) \
+  auto&& DO_RETURN_NAME(k) = (mexpr); \
+  if (! ::boost::functional::valued::has_value(DO_RETURN_NAME(k))) \
+    return ::boost::functional::errored::get_errored(DO_RETURN_NAME(k)); \
+  DO_RETURN_TRY \
+  decl = std::move(::boost::functional::valued::deref(DO_RETURN_NAME(k)));
+
+#define DO_RETURN_STEP(z, k, seq) \
+  DO_RETURN_STEP_I(k, \
+    BOOST_PP_SEQ_ELEM(BOOST_PP_MUL(k, 2), seq), \
+    BOOST_PP_SEQ_ELEM(BOOST_PP_INC(BOOST_PP_MUL(k, 2)), seq))
+
+// The steps are closed innermost first.
+#define DO_RETURN_CLOSE(z, j, n) \
+  DO_RETURN_CATCH(DO_RETURN_NAME(BOOST_PP_SUB(BOOST_PP_DEC(n), j)))
+
+#define DO_RETURN_SEQ_I(n, seq) \
+  do { \
+    BOOST_PP_REPEAT(n, DO_RETURN_STEP, seq) \
+    return BOOST_PP_SEQ_ELEM(BOOST_PP_MUL(n, 2), seq); \
+    BOOST_PP_REPEAT(n, DO_RETURN_CLOSE, n) \
+  } while (false)
+
+#define DO_RETURN_SEQ(seq) \
+  DO_RETURN_SEQ_I(BOOST_PP_DIV(BOOST_PP_SEQ_SIZE(seq), 2), seq)
+
+/*
+Syntactic transformation, example:
+
+DO_RETURN(
+  int i, monad_expr_1,
+  int j, monad_expr_2,
+YIELD(i+j));
+
+===>
+
+do {
+  auto&& m0 = (monad_expr_1);
+  if (! has_value(m0)) return get_errored(m0);
+  { int i = std::move(deref(m0));
+    auto&& m1 = (monad_expr_2);
+    if (! has_value(m1)) return get_errored(m1);
+    { int j = std::move(deref(m1));
+      return i + j;
+  } }
+} while (false);
+
+-----------------
+
+With BOOST_EXPECTED_CATCH_EXCEPTIONS, the blocks are try blocks, and an
+exception thrown by a step becomes an error of the expected before it, as
+with expected::bind.
+
+The monad expressions must be evaluated to values implementing the Valued
+and Errored concepts.
+*/
+
+#define DO_RETURN(...) DO_RETURN_SEQ(BOOST_PP_VARIADIC_TO_SEQ(__VA_ARGS__))
+
 #endif // BOOST_FUNCTIONAL_MONAD_DO_HPP
@@ -6,6 +6,7 @@
 #ifndef BOOST_FUNCTIONAL_FUNCTOR_HPP
 #define BOOST_FUNCTIONAL_FUNCTOR_HPP
 
+#include <boost/config.hpp>
 #include <boost/functional/type_traits_t.hpp>
 #include <boost/functional/meta.hpp>
 #include <boost/functional/monads/rebindable.hpp>
@@ -29,7 +30,7 @@ namespace functional
   {
 
     template <class F, class M0, class ...M, class FR = decltype( std::declval<F>()(*std::declval<M0>(), *std::declval<M>()...) )>
-    static auto
+    static BOOST_CONSTEXPR auto
     map(F&& f, M0&& m0, M&& ...ms) -> typename rebindable::rebind<decay_t<M0>, FR>::type
     {
       return M0::map(std::forward<F>(f), std::forward<M0>(m0), std::forward<M>(ms)...);
@@ -49,7 +50,7 @@ namespace functor
   using namespace ::boost::functional::rebindable;
 
   template <class F, class M0, class ...M, class Traits = if_functor<decay_t<M0>> >
-  auto
+  BOOST_CONSTEXPR auto
   map(F&& f, M0&& m0, M&& ...m)
   -> decltype(Traits::map(std::forward<F>(f), std::forward<M0>(m0), std::forward<M>(m)...))
   {
@@ -57,7 +58,7 @@ namespace functor
   }
 
   template <class F, class M, class = if_functor<decay_t<M> > >
-  auto operator^(F&& f, M&& m)
+  BOOST_CONSTEXPR auto operator^(F&& f, M&& m)
   -> decltype(map(std::forward<F>(f), std::forward<M>(m)))
   {
     return map(std::forward<F>(f), std::forward<M>(m));
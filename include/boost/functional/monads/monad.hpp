@@ -6,6 +6,7 @@
 #ifndef BOOST_FUNCTIONAL_MONAD_HPP
 #define BOOST_FUNCTIONAL_MONAD_HPP
 
+#include <boost/config.hpp>
 #include <boost/functional/type_traits_t.hpp>
 #include <boost/functional/meta.hpp>
 #include <boost/functional/monads/functor.hpp>
@@ -40,20 +41,20 @@ namespace monad
 
   template <class M, class T,
       class Mo = apply<M,decay_t<T>>, class Traits = if_monad<Mo> >
-  Mo make(T&& v)
+  BOOST_CONSTEXPR Mo make(T&& v)
   {
     return Traits::template make<M>(std::forward<T>(v));
   }
 
   template <template <class ...> class M, class T,
       class Mo = M<decay_t<T>>, class Traits = if_monad<decay_t<Mo>> >
-  Mo make(T&& v)
+  BOOST_CONSTEXPR Mo make(T&& v)
   {
     return Traits::template make<lift<M>>(std::forward<T>(v));
   }
 
   template <class M, class F, class Traits = if_monad<decay_t<M>> >
-  auto
+  BOOST_CONSTEXPR auto
   bind(M&& m, F&& f) -> decltype(Traits::bind(std::forward<M>(m), std::forward<F>(f)))
   {
     return Traits::bind(std::forward<M>(m), std::forward<F>(f));
@@ -67,7 +68,7 @@ namespace monad
   }
 
   template <class M, class F, class Traits = if_monad<decay_t<M>> >
-  auto operator&(M&& m, F&& f)
+  BOOST_CONSTEXPR auto operator&(M&& m, F&& f)
   -> decltype(bind(std::forward<M>(m), std::forward<F>(f)))
   {
     return bind(std::forward<M>(m),std::forward<F>(f));
@@ -98,14 +99,14 @@ struct monad_traits<category::forward> : monad_traits<category::default_>
 {
   // make use of constructor
   template <class M, class T>
-  static apply<M, T> make(T&& v)
+  static BOOST_CONSTEXPR apply<M, T> make(T&& v)
   {
     return apply<M, T>(std::forward<T>(v));
   }
 
   // make use of member function
   template <class M, class F>
-  static auto
+  static BOOST_CONSTEXPR auto
   bind(M&& m, F&& f) -> decltype(m.bind(std::forward<F>(f)))
   {
     return m.bind(std::forward<F>(f));
@@ -15,7 +15,6 @@
 #include <boost/functional/monads/monad_error.hpp>
 #include <utility>
 #include <type_traits>
-#include <functional>
 
 namespace boost
 {
@@ -56,6 +55,29 @@ namespace functional
   template <class M> using if_monad_exception =
       typename std::enable_if<is_monad_exception<M>::value, monad_exception_traits<M> >::type;
 
+namespace detail
+{
+  // E when F has a single, non-template operator() taking an E&.
+  template <class F>
+  struct call_exception_argument {};
+  template <class R, class C, class E>
+  struct call_exception_argument<R (C::*)(E&)>
+  {
+    typedef E type;
+  };
+  template <class R, class C, class E>
+  struct call_exception_argument<R (C::*)(E&) const>
+    : call_exception_argument<R (C::*)(E&)>
+  {};
+
+  template <class F, class = void>
+  struct exception_argument {};
+  template <class F>
+  struct exception_argument<F, void_t<decltype(&F::operator())>>
+    : call_exception_argument<decltype(&F::operator())>
+  {};
+} // namespace detail
+
 namespace monad_exception
 {
   using namespace ::boost::functional::monad_error;
@@ -91,11 +113,16 @@ namespace monad_exception
   {
     return catch_exception<E>(std::forward<M>(m), f);
   }
-  template <class M, class E, class = if_monad_exception<decay_t<M>>>
-  auto operator||(M&& m, std::function<M(E&)>&& f)
-  -> decltype(catch_exception<E>(std::forward<M>(m), std::forward<std::function<M(E&)>>(f)))
+
+  // m || f for any f taking one E&, the exception caught, so that a lambda
+  // is called directly instead of through a std::function.
+  template <class M, class F,
+      class E = typename detail::exception_argument<decay_t<F>>::type,
+      class = if_monad_exception<decay_t<M>>>
+  auto operator||(M&& m, F&& f)
+  -> decltype(catch_exception<E>(std::forward<M>(m), std::forward<F>(f)))
   {
-    return catch_exception<E>(std::forward<M>(m), std::forward<std::function<M(E&)>>(f));
+    return catch_exception<E>(std::forward<M>(m), std::forward<F>(f));
   }
 }
 }
@@ -0,0 +1,99 @@
+//! \file atomic_expected.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Fork/join batches of 64 results: a table of std::promise/std::future, of
+// expected_promise/expected_future and an atomic_expected_array, each result
+// set and then collected by the joining side. The tasks run inline, so only
+// the publication cost is measured.
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/atomic_expected.hpp>
+#include <boost/expected/expected_future.hpp>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <vector>
+
+using namespace boost;
+
+std::size_t const batch = 64;
+std::size_t const batches = 20000;
+
+template <class F>
+double best_ns_per_result(F f)
+{
+  double best = 1e300;
+  for (int rep = 0; rep < 10; ++rep)
+  {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+    best = (std::min)(best, d.count() / (batch * batches));
+  }
+  return best;
+}
+
+int main()
+{
+  long volatile sink = 0;
+
+  double std_future = best_ns_per_result([&]
+  {
+    long s = 0;
+    for (std::size_t b = 0; b < batches; ++b)
+    {
+      std::vector<std::promise<int>> promises(batch);
+      std::vector<std::future<int>> futures;
+      futures.reserve(batch);
+      for (std::size_t i = 0; i < batch; ++i)
+        futures.push_back(promises[i].get_future());
+      for (std::size_t i = 0; i < batch; ++i)
+        promises[i].set_value(int(i));
+      for (std::size_t i = 0; i < batch; ++i)
+        s += futures[i].get();
+    }
+    sink = s;
+  });
+  double expected_future = best_ns_per_result([&]
+  {
+    long s = 0;
+    for (std::size_t b = 0; b < batches; ++b)
+    {
+      std::vector<expected_promise<int>> promises(batch);
+      std::vector<boost::expected_future<int>> futures;
+      futures.reserve(batch);
+      for (std::size_t i = 0; i < batch; ++i)
+        futures.push_back(promises[i].get_future());
+      for (std::size_t i = 0; i < batch; ++i)
+        promises[i].set_value(int(i));
+      for (std::size_t i = 0; i < batch; ++i)
+        s += *futures[i].get();
+    }
+    sink = s;
+  });
+  double table = best_ns_per_result([&]
+  {
+    long s = 0;
+    for (std::size_t b = 0; b < batches; ++b)
+    {
+      atomic_expected_array<int> results(batch);
+      for (std::size_t i = 0; i < batch; ++i)
+        results[i].set_value(int(i));
+      results.wait_all();
+      for (std::size_t i = 0; i < batch; ++i)
+        s += **results[i].try_get();
+    }
+    sink = s;
+  });
+
+  std::cout << "std::promise/std::future     " << std_future << " ns/result" << std::endl;
+  std::cout << "expected_promise/future      " << expected_future << " ns/result (x" << std_future / expected_future << ")" << std::endl;
+  std::cout << "atomic_expected_array        " << table << " ns/result (x" << std_future / table << ")" << std::endl;
+  return 0;
+}
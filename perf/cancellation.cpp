@@ -0,0 +1,116 @@
+//! \file cancellation.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Fan-out of 16 pipelines of 1000 steps on a work_stealing_pool, one of
+// them failing at its 10th step, joined as a whole. Each step is chained
+// with then(if_valued(step)), or with then(cancellable(step, token)) where
+// the failing branch requests cancellation. The time to join everything
+// is the tail latency of the fan-out. The cost of the token check is
+// measured apart on a pipeline that is never cancelled.
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/expected_monad.hpp>
+#include <boost/expected/cancellation.hpp>
+#include <boost/expected/work_stealing_pool.hpp>
+#include <boost/functional/monads/adaptor.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+using namespace boost;
+using namespace boost::functional;
+
+std::size_t const branches = 16;
+int const steps = 1000;
+
+// about a microsecond of work
+BOOST_NOINLINE long step(long x)
+{
+  for (int i = 0; i < 300; ++i)
+    x = x * 6364136223846793005L + 1442695040888963407L;
+  return x;
+}
+
+template <class Chain>
+expected<long> pipeline(std::size_t branch, Chain chain, cancellation_source* source)
+{
+  expected<long> r = long(branch);
+  for (int i = 0; i < steps; ++i)
+  {
+    if (branch == 0 && i == 10)
+    {
+      if (source)
+        source->request_cancellation();
+      return make_unexpected(std::make_exception_ptr(std::runtime_error("failed")));
+    }
+    r = chain(std::move(r));
+  }
+  return r;
+}
+
+template <class Chain>
+double join_ms(work_stealing_pool& pool, Chain chain, cancellation_source* source)
+{
+  auto start = std::chrono::steady_clock::now();
+  std::vector<task_handle<long>> hs;
+  for (std::size_t b = 0; b < branches; ++b)
+    hs.push_back(pool.submit([b, chain, source] { return pipeline(b, chain, source); }));
+  for (std::size_t b = 0; b < branches; ++b)
+    hs[b].get();
+  std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - start;
+  return d.count();
+}
+
+int main()
+{
+  work_stealing_pool pool;
+  double plain = 1e300;
+  double cancelled = 1e300;
+  for (int rep = 0; rep < 5; ++rep)
+  {
+    plain = (std::min)(plain, join_ms(pool, [](expected<long> r)
+    {
+      return r.then(if_valued(step));
+    }, 0));
+
+    cancellation_source source;
+    cancellation_token token = source.token();
+    cancelled = (std::min)(cancelled, join_ms(pool, [token](expected<long> r)
+    {
+      return r.then(cancellable(step, token));
+    }, &source));
+  }
+
+  // cost of the check itself, on a pipeline that is not cancelled
+  std::size_t const n = 10000000;
+  cancellation_source source;
+  cancellation_token token = source.token();
+  auto id = [](long x) { return x + 1; };
+  long volatile sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  expected<long> r(0L);
+  for (std::size_t i = 0; i < n; ++i)
+    r = r.then(if_valued(id));
+  sink = *r;
+  std::chrono::duration<double, std::nano> d_plain = std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  r = expected<long>(0L);
+  for (std::size_t i = 0; i < n; ++i)
+    r = r.then(cancellable(id, token));
+  sink = *r;
+  std::chrono::duration<double, std::nano> d_checked = std::chrono::steady_clock::now() - start;
+
+  std::cout << "join, if_valued steps    " << plain << " ms" << std::endl;
+  std::cout << "join, cancellable steps  " << cancelled << " ms (x" << plain / cancelled << ")" << std::endl;
+  std::cout << "then(if_valued(f))       " << d_plain.count() / n << " ns/step" << std::endl;
+  std::cout << "then(cancellable(f, t))  " << d_checked.count() / n << " ns/step" << std::endl;
+  return 0;
+}
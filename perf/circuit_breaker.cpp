@@ -0,0 +1,101 @@
+//! \file circuit_breaker.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Cost of a circuit_breaker around a cheap function returning an expected:
+// closed, against the plain call, and open, against calling a dependency
+// that takes about 1us to fail. Then the time per call of 4 threads going
+// through one breaker.
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/circuit_breaker.hpp>
+#include <chrono>
+#include <iostream>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using namespace boost;
+
+typedef expected<long, std::error_code> result;
+
+BOOST_NOINLINE result cheap(long i)
+{
+  return i;
+}
+
+BOOST_NOINLINE result degraded(long i)
+{
+  for (int k = 0; k < 1000; ++k)
+    i = i * 6364136223846793005L + 1442695040888963407L;
+  if (i != 0)
+    return make_unexpected(std::make_error_code(std::errc::timed_out));
+  return i;
+}
+
+template <class F>
+double best_ns(F f)
+{
+  long const n = 20000000;
+  double best = 1e300;
+  for (int rep = 0; rep < 5; ++rep)
+  {
+    long sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < n; ++i)
+    {
+      result r = f(i);
+      sink += r.valid() ? *r : 1;
+    }
+    std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+    volatile long s = sink;
+    (void)s;
+    best = (std::min)(best, d.count() / n);
+  }
+  return best;
+}
+
+int main()
+{
+  circuit_breaker<> closed;
+  circuit_breaker_options o;
+  o.minimum_calls = 1;
+  o.open_duration = std::chrono::hours(1);
+  circuit_breaker<> open(o);
+  open.call([] { return degraded(1); });
+
+  std::cout << "plain call                 " << best_ns([](long i) { return cheap(i); }) << " ns/call" << std::endl;
+  std::cout << "circuit_breaker, closed    " << best_ns([&closed](long i)
+  {
+    return closed.call([i] { return cheap(i); });
+  }) << " ns/call" << std::endl;
+  std::cout << "degraded dependency        " << best_ns([](long i) { return degraded(i); }) << " ns/call" << std::endl;
+  std::cout << "circuit_breaker, open      " << best_ns([&open](long i)
+  {
+    return open.call([i] { return degraded(i); });
+  }) << " ns/call" << std::endl;
+
+  std::size_t const threads = 4;
+  long const n = 10000000;
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> ts;
+  for (std::size_t t = 0; t < threads; ++t)
+    ts.push_back(std::thread([&closed, n]
+    {
+      long sink = 0;
+      for (long i = 0; i < n; ++i)
+        sink += *closed.call([i] { return cheap(i); });
+      volatile long s = sink;
+      (void)s;
+    }));
+  for (std::size_t t = 0; t < threads; ++t)
+    ts[t].join();
+  std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+  std::cout << "closed, " << threads << " threads          " << d.count() / (n * threads) << " ns/call" << std::endl;
+  return 0;
+}
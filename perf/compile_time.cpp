@@ -0,0 +1,125 @@
+//! \file compile_time.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Compiles each translation unit given and reports its compile time (best
+// of 3, at -O0), its preprocessed size in lines and the number of template
+// and inline functions it instantiates (the weak symbols of its object
+// file). Each unit states its budget on a line
+//
+//   // budget: lines <n> instantiations <m>
+//
+// and the program fails when one goes over it. Times depend on the machine
+// and are only reported.
+//
+//   compile_time "g++ -std=c++11 -I../include" compile_time/*.cpp
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+  struct budget
+  {
+    long lines;
+    long instantiations;
+  };
+
+  bool read_budget(std::string const& file, budget& b)
+  {
+    std::ifstream in(file.c_str());
+    std::string line;
+    while (std::getline(in, line))
+    {
+      std::string::size_type at = line.find("// budget:");
+      if (at == std::string::npos)
+        continue;
+      std::istringstream fields(line.substr(at + 10));
+      std::string lines, instantiations;
+      return (fields >> lines >> b.lines >> instantiations >> b.instantiations)
+          && lines == "lines" && instantiations == "instantiations";
+    }
+    return false;
+  }
+
+  // The first number printed by command, or -1.
+  long count(std::string const& command)
+  {
+    long n = -1;
+    if (FILE* p = popen(command.c_str(), "r"))
+    {
+      if (std::fscanf(p, "%ld", &n) != 1)
+        n = -1;
+      if (pclose(p) != 0)
+        n = -1;
+    }
+    return n;
+  }
+
+  // Seconds taken by command, or -1 when it fails.
+  double seconds(std::string const& command)
+  {
+    auto start = std::chrono::steady_clock::now();
+    if (std::system(command.c_str()) != 0)
+      return -1;
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    return d.count();
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "usage: compile_time \"<compiler and flags>\" <unit.cpp>..." << std::endl;
+    return 2;
+  }
+  std::string const cxx = argv[1];
+  std::string const object = "compile_time_unit.o";
+  int failures = 0;
+
+  for (int i = 2; i < argc; ++i)
+  {
+    std::string const unit = argv[i];
+    budget b;
+    if (! read_budget(unit, b))
+    {
+      std::cerr << unit << ": no budget line" << std::endl;
+      ++failures;
+      continue;
+    }
+
+    double best = 1e300;
+    for (int rep = 0; rep < 3 && best >= 0; ++rep)
+      best = (std::min)(best, seconds(cxx + " -O0 -c " + unit + " -o " + object));
+    if (best < 0)
+    {
+      std::cerr << unit << ": does not compile" << std::endl;
+      ++failures;
+      continue;
+    }
+    long const instantiations = count("nm " + object + " | grep -c ' W '");
+    long const lines = count(cxx + " -E " + unit + " | wc -l");
+    std::remove(object.c_str());
+
+    bool const over = lines < 0 || instantiations < 0
+        || lines > b.lines || instantiations > b.instantiations;
+    std::cout << unit << "  " << best << " s  "
+              << lines << " lines (" << b.lines << ")  "
+              << instantiations << " instantiations (" << b.instantiations << ")"
+              << (over ? "  OVER BUDGET" : "") << std::endl;
+    failures += over;
+  }
+  return failures ? 1 : 0;
+}
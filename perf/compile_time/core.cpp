@@ -0,0 +1,38 @@
+//! \file core.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// A translation unit that only wants expected<T,E>: construction,
+// observers and comparisons, for two error types.
+//
+// budget: lines 40000 instantiations 100
+
+#include <boost/expected/expected.hpp>
+#include <system_error>
+
+using namespace boost;
+
+expected<int, std::error_code> parse(int i)
+{
+  if (i < 0)
+    return make_unexpected(std::make_error_code(std::errc::invalid_argument));
+  return i;
+}
+
+expected<long> widen(int i)
+{
+  expected<int, std::error_code> r = parse(i);
+  if (! r)
+    return make_unexpected(std::make_exception_ptr(std::system_error(r.error())));
+  return *r;
+}
+
+bool same(expected<int, std::error_code> const& x, expected<int, std::error_code> const& y)
+{
+  return x == y || x == 0 || x.value_or(1) < y.value_or(2);
+}
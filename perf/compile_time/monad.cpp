@@ -0,0 +1,50 @@
+//! \file monad.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// The monad interface of expected, with a DO and a DO_RETURN block.
+//
+// budget: lines 42000 instantiations 80
+
+#include <boost/functional/monads/do.hpp>
+#include <boost/expected/expected_monad.hpp>
+#include <system_error>
+
+using namespace boost;
+
+typedef expected<int, std::error_code> result;
+
+result step(int i)
+{
+  if (i < 0)
+    return make_unexpected(std::make_error_code(std::errc::invalid_argument));
+  return i + 1;
+}
+
+result with_do(int v)
+{
+  return DO(
+    int a, step(v),
+    int b, step(a),
+    int c, step(b),
+    result(a + b + c));
+}
+
+result with_do_return(int v)
+{
+  DO_RETURN(
+    int a, step(v),
+    int b, step(a),
+    int c, step(b),
+    result(a + b + c));
+}
+
+result mapped(int v)
+{
+  return functional::functor::map([](int i) { return 2 * i; }, step(v));
+}
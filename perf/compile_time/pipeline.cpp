@@ -0,0 +1,34 @@
+//! \file pipeline.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// A fused pipeline of eight stages.
+//
+// budget: lines 40000 instantiations 110
+
+#include <boost/expected/pipeline.hpp>
+#include <system_error>
+
+using namespace boost;
+
+typedef expected<int, std::error_code> result;
+
+result step(int i)
+{
+  if (i < 0)
+    return make_unexpected(std::make_error_code(std::errc::invalid_argument));
+  return i + 1;
+}
+
+result run(result e)
+{
+  auto twice = [](int i) { return 2 * i; };
+  return std::move(e) | fmap(twice) | fbind(step) | fmap(twice) | fbind(step)
+    | fmap(twice) | fbind(step) | fmap(twice)
+    | recover([](std::error_code) { return 0; });
+}
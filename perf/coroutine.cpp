@@ -0,0 +1,155 @@
+//! \file coroutine.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// get_interval over an array of ints, 1M calls, written with early returns
+// and with co_await, once where every call succeeds and once where every
+// other call fails. Heap allocations are counted to show whether the
+// compiler elided the coroutine frame; get_interval is left inlinable as
+// the elision needs the coroutine to be inlined in its caller.
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/coroutine.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <utility>
+#include <vector>
+
+static std::atomic<std::size_t> allocations(0);
+
+void* operator new(std::size_t n)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(n))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) BOOST_NOEXCEPT
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) BOOST_NOEXCEPT
+{
+  std::free(p);
+}
+
+#if defined BOOST_EXPECTED_HAS_COROUTINES
+
+using namespace boost;
+
+typedef expected<std::pair<int, int>, int> interval;
+
+struct cursor
+{
+  int const* p;
+};
+
+BOOST_NOINLINE expected<int, int> get_num(cursor& c)
+{
+  int v = *c.p++;
+  if (v < 0)
+    return make_unexpected(v);
+  return v;
+}
+
+BOOST_NOINLINE expected<void, int> matched(cursor& c)
+{
+  if (*c.p++ != 0)
+    return make_unexpected(1);
+  return expected<void, int>(in_place2);
+}
+
+interval get_interval(cursor& c)
+{
+  auto f = get_num(c);
+  if (! f.valid()) return f.get_unexpected();
+
+  auto m = matched(c);
+  if (! m.valid()) return m.get_unexpected();
+
+  auto l = get_num(c);
+  if (! l.valid()) return l.get_unexpected();
+
+  return std::make_pair(*f, *l);
+}
+
+interval get_interval_co(cursor& c)
+{
+  auto f = co_await get_num(c);
+           co_await matched(c);
+  auto l = co_await get_num(c);
+  co_return std::make_pair(f, l);
+}
+
+template <class F>
+double best_ns_per_call(std::size_t n, F f)
+{
+  double best = 1e300;
+  for (int rep = 0; rep < 10; ++rep)
+  {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+    best = (std::min)(best, d.count() / n);
+  }
+  return best;
+}
+
+template <class F>
+void run(char const* name, std::vector<int> const& input, std::size_t n, F f)
+{
+  long volatile sink = 0;
+  std::size_t const before = allocations.load();
+  double ns = best_ns_per_call(n, [&]
+  {
+    cursor c = { input.data() };
+    long s = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      interval r = f(c);
+      s += r.valid() ? r->first + r->second : r.error();
+    }
+    sink = s;
+  });
+  std::size_t const allocs = allocations.load() - before;
+  std::cout << name << ns << " ns/call, " << double(allocs) / (10 * n) << " allocations/call" << std::endl;
+}
+
+int main()
+{
+  std::size_t const n = 1000000;
+  std::vector<int> valid, failing;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    int const x = int(i % 1000);
+    valid.insert(valid.end(), { x, 0, x + 1 });
+    // every other interval has a bad upper bound
+    failing.insert(failing.end(), { x, 0, (i & 1) ? -1 : x });
+  }
+
+  run("early return, valid      ", valid, n, get_interval);
+  run("co_await, valid          ", valid, n, get_interval_co);
+  run("early return, 50% errors ", failing, n, get_interval);
+  run("co_await, 50% errors     ", failing, n, get_interval_co);
+  return 0;
+}
+
+#else
+
+int main()
+{
+  std::cout << "coroutines are not supported by this compiler" << std::endl;
+  return 0;
+}
+
+#endif
@@ -0,0 +1,177 @@
+//! \file dataflow_graph.cpp
+
+// Derived metrics over 100000 nodes: 10000 inputs and 9 layers of 10000
+// nodes, each reading 3 nodes of the layer before, a cone of some 200
+// nodes below an input. Each node costs about 100ns. Compared, per update
+// of a random input: recomputing every node, as before, and the dirty cone
+// only, sequentially and with a pool; then an input set to an error and
+// back, and all the inputs changed at once. Best of 3.
+
+#include <boost/expected/dataflow_graph.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <system_error>
+#include <vector>
+
+using namespace boost;
+
+typedef dataflow_graph<long, std::error_code> graph;
+
+std::size_t const width = 10000;
+std::size_t const depth = 10;
+int const updates = 1000;
+
+BOOST_NOINLINE long metric(long const* x, std::size_t n)
+{
+  unsigned long h = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    h += x[i];
+  for (int i = 0; i < 30; ++i)
+    h = h * 6364136223846793005UL + 1442695040888963407UL;
+  return long(h % 1000003);
+}
+
+struct layout
+{
+  std::size_t deps[3];
+};
+
+layout dependencies(std::size_t node)
+{
+  std::size_t const l = node / width - 1, i = node % width;
+  layout d = { { l * width + i, l * width + (i + 1) % width, l * width + (i + 7) % width } };
+  return d;
+}
+
+void build(graph& g)
+{
+  for (std::size_t i = 0; i < width; ++i)
+    g.add_input(long(i));
+  for (std::size_t n = width; n < width * depth; ++n)
+  {
+    layout d = dependencies(n);
+    g.add_node(std::vector<graph::node_id>(d.deps, d.deps + 3), [](graph::arguments const& a)
+    {
+      long x[3] = { a[0], a[1], a[2] };
+      return metric(x, 3);
+    });
+  }
+}
+
+// Every node computed again, in order.
+BOOST_NOINLINE void recompute_all(std::vector<expected<long, std::error_code> >& values)
+{
+  for (std::size_t n = width; n < values.size(); ++n)
+  {
+    layout d = dependencies(n);
+    expected<long, std::error_code> r(0L);
+    long x[3];
+    for (int k = 0; k < 3 && r.valid(); ++k)
+    {
+      if (values[d.deps[k]].valid())
+        x[k] = *values[d.deps[k]];
+      else
+        r = values[d.deps[k]].get_unexpected();
+    }
+    values[n] = r.valid() ? expected<long, std::error_code>(metric(x, 3)) : r;
+  }
+}
+
+template <class F>
+void run(char const* name, int n, F f)
+{
+  double best = 1e300;
+  std::size_t computed = 0;
+  for (int rep = 0; rep < 3; ++rep)
+  {
+    auto start = std::chrono::steady_clock::now();
+    computed = f();
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    best = (std::min)(best, d.count());
+  }
+  std::cout << name << best / n * 1e6 << " us/update, " << computed / n << " nodes computed per update" << std::endl;
+}
+
+int main()
+{
+  std::vector<std::size_t> inputs(updates);
+  std::mt19937_64 gen(42);
+  for (int i = 0; i < updates; ++i)
+    inputs[i] = gen() % width;
+
+  auto start = std::chrono::steady_clock::now();
+  graph g;
+  build(g);
+  std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+  std::cout << "build                      " << d.count() * 1e3 << " ms for " << g.size() << " nodes" << std::endl;
+
+  std::vector<expected<long, std::error_code> > values;
+  for (std::size_t n = 0; n < g.size(); ++n)
+    values.push_back(g.get(n));
+  long round = 0;
+  run("recompute all             ", 20, [&]
+  {
+    for (int i = 0; i < 20; ++i)
+    {
+      values[inputs[i]] = long(++round);
+      recompute_all(values);
+    }
+    return std::size_t(20 * (width * depth - width));
+  });
+
+  run("dirty cone, sequential    ", updates, [&]
+  {
+    std::size_t computed = 0;
+    for (int i = 0; i < updates; ++i)
+    {
+      g.set(inputs[i], ++round);
+      computed += g.recompute().computed;
+    }
+    return computed;
+  });
+
+  work_stealing_pool pool(4);
+  run("dirty cone, pool          ", updates, [&]
+  {
+    std::size_t computed = 0;
+    for (int i = 0; i < updates; ++i)
+    {
+      g.set(inputs[i], ++round);
+      computed += g.recompute(pool).computed;
+    }
+    return computed;
+  });
+
+  std::error_code const failed = std::make_error_code(std::errc::timed_out);
+  run("error and back            ", updates, [&]
+  {
+    std::size_t computed = 0;
+    for (int i = 0; i < updates; i += 2)
+    {
+      g.set(inputs[i], make_unexpected(failed));
+      dataflow_stats s = g.recompute();
+      g.set(inputs[i], ++round);
+      computed += s.computed + g.recompute().computed;
+    }
+    return computed;
+  });
+
+  run("all inputs, sequential    ", 1, [&]
+  {
+    ++round;
+    for (std::size_t i = 0; i < width; ++i)
+      g.set(i, round + long(i));
+    return g.recompute().computed;
+  });
+  run("all inputs, pool          ", 1, [&]
+  {
+    ++round;
+    for (std::size_t i = 0; i < width; ++i)
+      g.set(i, round + long(i));
+    return g.recompute(pool).computed;
+  });
+  return 0;
+}
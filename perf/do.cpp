@@ -0,0 +1,106 @@
+//! \file do.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// A DO block of 8 steps, instantiated for 64 different step functions,
+// written with DO (nested binds and lambdas) and with DO_RETURN (early
+// returns), over inputs of which one in 16 fails at the first step.
+//
+// For compile times, build with -DPERF_DO_NO_DO_RETURN or -DPERF_DO_NO_DO
+// and time the compiler: only the 64 functions of the other form are then
+// instantiated.
+
+#include <boost/functional/monads/do.hpp>
+#include <boost/expected/expected_monad.hpp>
+#include <chrono>
+#include <iostream>
+#include <system_error>
+#include <vector>
+
+using namespace boost;
+
+typedef expected<long, std::error_code> result;
+
+template <int K>
+inline result step(long v)
+{
+  if (BOOST_UNLIKELY(v < 0))
+    return make_unexpected(std::make_error_code(std::errc::invalid_argument));
+  return v + K;
+}
+
+#define PERF_DO_BLOCK(M) \
+  M( \
+    long a, step<K>(v), \
+    long b, step<K + 1>(a), \
+    long c, step<K + 2>(b), \
+    long d, step<K + 3>(c), \
+    long e, step<K + 4>(d), \
+    long f, step<K + 5>(e), \
+    long g, step<K + 6>(f), \
+    long h, step<K + 7>(g), \
+    result(a + b + c + d + e + f + g + h))
+
+template <int K>
+BOOST_NOINLINE result with_do(long v)
+{
+  return PERF_DO_BLOCK(DO);
+}
+
+template <int K>
+BOOST_NOINLINE result with_do_return(long v)
+{
+  PERF_DO_BLOCK(DO_RETURN);
+}
+
+typedef result (*function)(long);
+
+#define PERF_DO_ENTRY(z, k, f) &f<k>,
+
+#if ! defined PERF_DO_NO_DO
+function const do_functions[] = { BOOST_PP_REPEAT(64, PERF_DO_ENTRY, with_do) };
+#endif
+#if ! defined PERF_DO_NO_DO_RETURN
+function const do_return_functions[] = { BOOST_PP_REPEAT(64, PERF_DO_ENTRY, with_do_return) };
+#endif
+
+double best_ns(function const* fs, std::vector<long> const& in)
+{
+  double best = 1e300;
+  for (int rep = 0; rep < 5; ++rep)
+  {
+    long sink = 0;
+    std::size_t const rounds = 2000;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t k = 0; k < rounds; ++k)
+      for (std::size_t i = 0; i < in.size(); ++i)
+      {
+        result r = fs[i % 64](in[i]);
+        sink += r.valid() ? *r : 1;
+      }
+    std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+    volatile long s = sink;
+    (void)s;
+    best = (std::min)(best, d.count() / (rounds * in.size()));
+  }
+  return best;
+}
+
+int main()
+{
+  std::vector<long> in;
+  for (long i = 0; i < 1024; ++i)
+    in.push_back(i % 16 == 0 ? -1 : i);
+#if ! defined PERF_DO_NO_DO
+  std::cout << "DO         " << best_ns(do_functions, in) << " ns" << std::endl;
+#endif
+#if ! defined PERF_DO_NO_DO_RETURN
+  std::cout << "DO_RETURN  " << best_ns(do_return_functions, in) << " ns" << std::endl;
+#endif
+  return 0;
+}
@@ -0,0 +1,174 @@
+//! \file expected_channel.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// 10M expected<int> sent from one thread to another through a mutex guarded
+// std::deque, and through spsc_expected_channel and mpmc_expected_channel
+// one by one and in batches of 64. The last message is an error closing the
+// channel.
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/expected_channel.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace boost;
+
+typedef expected<int, int> message;
+
+std::size_t const n = 10000000;
+std::size_t const capacity = 4096;
+std::size_t const batch = 64;
+
+class locked_queue
+{
+public:
+  void push(message x)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] { return queue_.size() < capacity; });
+    queue_.push_back(std::move(x));
+    not_empty_.notify_one();
+  }
+
+  message pop()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] { return ! queue_.empty(); });
+    message x = std::move(queue_.front());
+    queue_.pop_front();
+    not_full_.notify_one();
+    return x;
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+  std::deque<message> queue_;
+};
+
+// run() sends the messages and returns the sum received.
+template <class Run>
+double million_messages_per_s(Run run)
+{
+  double best = 0;
+  for (int rep = 0; rep < 3; ++rep)
+  {
+    auto start = std::chrono::steady_clock::now();
+    long const sum = run();
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    if (sum != long(n) * (n - 1) / 2)
+      std::cout << "wrong sum" << std::endl;
+    best = (std::max)(best, n / d.count() / 1e6);
+  }
+  return best;
+}
+
+template <class Channel>
+long one_by_one()
+{
+  std::unique_ptr<Channel> ch(new Channel(capacity));
+  std::thread producer([&]
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      ch->push(int(i));
+    ch->push(make_unexpected(0));
+  });
+  long sum = 0;
+  message x;
+  while (ch->pop(x) == channel_op_status::success)
+    sum += *x;
+  producer.join();
+  return sum;
+}
+
+template <class Channel>
+long in_batches()
+{
+  std::unique_ptr<Channel> ch(new Channel(capacity));
+  std::thread producer([&]
+  {
+    std::vector<int> values(batch);
+    for (std::size_t i = 0; i < n; i += batch)
+    {
+      std::size_t const m = (std::min)(batch, n - i);
+      for (std::size_t j = 0; j < m; ++j)
+        values[j] = int(i + j);
+      // wait for room when the batch did not fit
+      for (std::size_t k = ch->try_push_n(values.begin(), m); k < m; )
+      {
+        ch->push(values[k]);
+        ++k;
+        k += ch->try_push_n(values.begin() + k, m - k);
+      }
+    }
+    ch->push(make_unexpected(0));
+  });
+  long sum = 0;
+  std::vector<message> out;
+  out.reserve(batch);
+  message x;
+  for (;;)
+  {
+    out.clear();
+    if (ch->try_pop_n(std::back_inserter(out), batch) == 0)
+    {
+      if (ch->pop(x) != channel_op_status::success)
+        break;
+      sum += *x;
+      continue;
+    }
+    for (std::size_t i = 0; i < out.size(); ++i)
+      sum += *out[i];
+  }
+  producer.join();
+  return sum;
+}
+
+long locked()
+{
+  locked_queue q;
+  std::thread producer([&]
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      q.push(int(i));
+    q.push(make_unexpected(0));
+  });
+  long sum = 0;
+  for (;;)
+  {
+    message x = q.pop();
+    if (! x.valid())
+      break;
+    sum += *x;
+  }
+  producer.join();
+  return sum;
+}
+
+template <class Channel>
+void run(char const* name)
+{
+  double const single = million_messages_per_s(one_by_one<Channel>);
+  double const batched = million_messages_per_s(in_batches<Channel>);
+  std::cout << name << single << " M msg/s, batches of " << batch << ": " << batched << " M msg/s" << std::endl;
+}
+
+int main()
+{
+  std::cout << "mutex + deque          " << million_messages_per_s(locked) << " M msg/s" << std::endl;
+  run<spsc_expected_channel<int, int>>("spsc_expected_channel  ");
+  run<mpmc_expected_channel<int, int>>("mpmc_expected_channel  ");
+  return 0;
+}
@@ -0,0 +1,79 @@
+//! \file expected_future.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// 1M already known results delivered through std::promise/std::future and
+// through expected_future, ready and through an expected_promise.
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/expected_future.hpp>
+#include <chrono>
+#include <future>
+#include <iostream>
+
+using namespace boost;
+
+template <class F>
+double best_ns_per_result(std::size_t n, F f)
+{
+  double best = 1e300;
+  for (int rep = 0; rep < 10; ++rep)
+  {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+    best = (std::min)(best, d.count() / n);
+  }
+  return best;
+}
+
+int main()
+{
+  std::size_t const n = 1000000;
+  long volatile sink = 0;
+
+  double std_future = best_ns_per_result(n, [&]
+  {
+    long s = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      std::promise<int> p;
+      std::future<int> f = p.get_future();
+      p.set_value(int(i));
+      s += f.get();
+    }
+    sink = s;
+  });
+  double ready = best_ns_per_result(n, [&]
+  {
+    long s = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      expected_future<int> f = make_ready_expected_future(expected<int>(int(i)));
+      s += *f.get();
+    }
+    sink = s;
+  });
+  double promise = best_ns_per_result(n, [&]
+  {
+    long s = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      expected_promise<int> p;
+      expected_future<int> f = p.get_future();
+      p.set_value(int(i));
+      s += *f.get();
+    }
+    sink = s;
+  });
+
+  std::cout << "std::promise/std::future     " << std_future << " ns/result" << std::endl;
+  std::cout << "make_ready_expected_future   " << ready << " ns/result (x" << std_future / ready << ")" << std::endl;
+  std::cout << "expected_promise/future      " << promise << " ns/result (x" << std_future / promise << ")" << std::endl;
+  return 0;
+}
@@ -0,0 +1,115 @@
+//! \file lazy_expected.cpp
+
+// Record enrichment: each of 100000 records has 10 optional fields, each
+// costing about 1us to compute and failing one time in 16, and a consumer
+// reads 20% of them, chosen up front. Compared: computing every field
+// eagerly, lazy_expected with its function type erased, lazy_expected of
+// make_lazy_expected, and concurrent_lazy_expected. Reports the time per
+// record, best of 3, and the fields computed.
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/lazy_expected.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace boost;
+
+enum class enrich_error { unavailable };
+
+typedef expected<std::string, enrich_error> field;
+
+std::size_t const records = 100000;
+std::size_t const fields = 10;
+
+std::size_t computed = 0;
+
+BOOST_NOINLINE field enrich(std::size_t record, std::size_t f)
+{
+  ++computed;
+  unsigned long x = record * fields + f;
+  for (int i = 0; i < 300; ++i)
+    x = x * 6364136223846793005UL + 1442695040888963407UL;
+  if (x % 16 == 0)
+    return make_unexpected(enrich_error::unavailable);
+  return std::to_string(x);
+}
+
+struct enricher
+{
+  std::size_t record, f;
+  field operator()() const { return enrich(record, f); }
+};
+
+// The fields read, 2 in 10 for each record.
+std::vector<std::vector<std::size_t> > reads()
+{
+  std::mt19937_64 gen(42);
+  std::vector<std::size_t> all(fields);
+  for (std::size_t f = 0; f < fields; ++f)
+    all[f] = f;
+  std::vector<std::vector<std::size_t> > r(records);
+  for (std::size_t i = 0; i < records; ++i)
+  {
+    std::shuffle(all.begin(), all.end(), gen);
+    r[i].assign(all.begin(), all.begin() + fields / 5);
+  }
+  return r;
+}
+
+// make(record, f) builds a field and read(field) gives its length, or 0.
+template <class Make, class Read>
+void run(char const* name, std::vector<std::vector<std::size_t> > const& rs, Make make, Read read)
+{
+  typedef decltype(make(0, 0)) field_type;
+  double best = 1e300;
+  std::size_t sink = 0;
+  for (int rep = 0; rep < 3; ++rep)
+  {
+    computed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < records; ++i)
+    {
+      std::vector<field_type> record;
+      record.reserve(fields);
+      for (std::size_t f = 0; f < fields; ++f)
+        record.emplace_back(make(i, f));
+      for (std::size_t k = 0; k < rs[i].size(); ++k)
+        sink += read(record[rs[i][k]]);
+    }
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    best = (std::min)(best, d.count());
+  }
+  std::cout << name << best / records * 1e9 << " ns/record, "
+      << computed << " fields computed (" << sink % 10 << ")" << std::endl;
+}
+
+int main()
+{
+  std::vector<std::vector<std::size_t> > const rs = reads();
+  run("eager                         ", rs,
+      [](std::size_t i, std::size_t f) { return enrich(i, f); },
+      [](field const& e) { return e.valid() ? e->size() : 0; });
+  run("lazy_expected, erased         ", rs,
+      [](std::size_t i, std::size_t f) { return lazy_expected<std::string, enrich_error>(enricher{ i, f }); },
+      [](lazy_expected<std::string, enrich_error> const& e) { return e.valid() ? e->size() : 0; });
+  run("lazy_expected, typed          ", rs,
+      [](std::size_t i, std::size_t f) { return make_lazy_expected(enricher{ i, f }); },
+      [](lazy_expected<std::string, enrich_error, enricher> const& e) { return e.valid() ? e->size() : 0; });
+  run("concurrent_lazy_expected      ", rs,
+      [](std::size_t i, std::size_t f)
+      {
+        return std::unique_ptr<concurrent_lazy_expected<std::string, enrich_error, enricher> >(
+            new concurrent_lazy_expected<std::string, enrich_error, enricher>(enricher{ i, f }));
+      },
+      [](std::unique_ptr<concurrent_lazy_expected<std::string, enrich_error, enricher> > const& e)
+      {
+        return e->valid() ? (*e)->size() : 0;
+      });
+  return 0;
+}
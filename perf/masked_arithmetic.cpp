@@ -0,0 +1,135 @@
+//! \file masked_arithmetic.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Throughput of the masked kernels against raw arithmetic on plain arrays
+// and against a loop of scalar expected operations, with 0.1% of errors.
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/expected_buffer.hpp>
+#include <boost/expected/algorithms/masked_arithmetic.hpp>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace boost;
+
+enum error_code { bad_sample = 1, division_by_zero, overflow };
+
+template <class F>
+double best_ns_per_element(std::size_t n, F f)
+{
+  double best = 1e300;
+  for (int rep = 0; rep < 200; ++rep)
+  {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+    best = (std::min)(best, d.count() / n);
+  }
+  return best;
+}
+
+template <class T>
+void fill(expected_buffer<T, error_code>& b, std::vector<T>& raw, std::mt19937& gen, T low, T high)
+{
+  std::bernoulli_distribution error(0.001);
+  std::uniform_real_distribution<double> value(low, high);
+  for (std::size_t i = 0; i < raw.size(); ++i)
+  {
+    raw[i] = T(value(gen));
+    if (error(gen)) b.set_error(i, bad_sample);
+    else b.set_value(i, raw[i]);
+  }
+}
+
+void report(char const* name, double raw, double masked, double scalar)
+{
+  std::cout << name << ": raw " << raw << " ns, masked " << masked << " ns (x" << masked / raw
+            << " of raw), scalar expected " << scalar << " ns" << std::endl;
+}
+
+int main()
+{
+  std::size_t const n = 1 << 14; // stays in cache
+  std::mt19937 gen(42);
+
+  {
+    expected_buffer<float, error_code> a(n), b(n), out;
+    std::vector<float> ra(n), rb(n), ro(n);
+    fill(a, ra, gen, 0.f, 100.f);
+    fill(b, rb, gen, 0.f, 100.f);
+    std::vector<expected<float, error_code>> sa(n), sb(n), so(n);
+    for (std::size_t i = 0; i < n; ++i) { sa[i] = a[i]; sb[i] = b[i]; }
+
+    double raw = best_ns_per_element(n, [&]
+    {
+      for (std::size_t i = 0; i < n; ++i) ro[i] = ra[i] + rb[i];
+    });
+    double masked = best_ns_per_element(n, [&] { expected_alg::masked_plus(a, b, out); });
+    double scalar = best_ns_per_element(n, [&]
+    {
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        if (! sa[i]) so[i] = make_unexpected(sa[i].error());
+        else if (! sb[i]) so[i] = make_unexpected(sb[i].error());
+        else so[i] = *sa[i] + *sb[i];
+      }
+    });
+    report("float plus", raw, masked, scalar);
+
+    raw = best_ns_per_element(n, [&]
+    {
+      for (std::size_t i = 0; i < n; ++i) ro[i] = ra[i] / rb[i];
+    });
+    masked = best_ns_per_element(n, [&] { expected_alg::masked_divides(a, b, out, division_by_zero); });
+    scalar = best_ns_per_element(n, [&]
+    {
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        if (! sa[i]) so[i] = make_unexpected(sa[i].error());
+        else if (! sb[i]) so[i] = make_unexpected(sb[i].error());
+        else if (*sb[i] == 0) so[i] = make_unexpected(division_by_zero);
+        else so[i] = *sa[i] / *sb[i];
+      }
+    });
+    report("float divides", raw, masked, scalar);
+  }
+  {
+    expected_buffer<std::int32_t, error_code> a(n), b(n), out;
+    std::vector<std::int32_t> ra(n), rb(n), ro(n);
+    fill(a, ra, gen, -50000, 50000);
+    fill(b, rb, gen, -50000, 50000);
+    std::vector<expected<std::int32_t, error_code>> sa(n), sb(n), so(n);
+    for (std::size_t i = 0; i < n; ++i) { sa[i] = a[i]; sb[i] = b[i]; }
+
+    double raw = best_ns_per_element(n, [&]
+    {
+      for (std::size_t i = 0; i < n; ++i) ro[i] = std::int32_t(std::uint32_t(ra[i]) * std::uint32_t(rb[i]));
+    });
+    double masked = best_ns_per_element(n, [&]
+    {
+      expected_alg::masked_checked_multiplies(a, b, out, overflow);
+    });
+    double scalar = best_ns_per_element(n, [&]
+    {
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        if (! sa[i]) { so[i] = make_unexpected(sa[i].error()); continue; }
+        if (! sb[i]) { so[i] = make_unexpected(sb[i].error()); continue; }
+        std::int64_t r = std::int64_t(*sa[i]) * std::int64_t(*sb[i]);
+        if (r != std::int32_t(r)) so[i] = make_unexpected(overflow);
+        else so[i] = std::int32_t(r);
+      }
+    });
+    report("int32 checked multiplies", raw, masked, scalar);
+  }
+  return 0;
+}
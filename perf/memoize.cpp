@@ -0,0 +1,125 @@
+//! \file memoize.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// 32 threads look up keys drawn from a Zipf(0.99) law over 100000 keys in
+// front of an in-process backend taking about 2us per call and failing for
+// one key in 8. Compared: the backend alone, memoize caching values only,
+// and memoize caching errors too, with 1 and 64 shards. Reports the
+// lookups per second and the calls that reached the backend in the last,
+// warm, repetition.
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/memoize.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using namespace boost;
+
+typedef expected<long, std::error_code> result;
+
+std::size_t const keys = 100000;
+std::size_t const threads = 32;
+std::size_t const lookups = 20000;
+
+std::atomic<std::size_t> backend_calls(0);
+
+BOOST_NOINLINE result backend(std::size_t k)
+{
+  backend_calls.fetch_add(1, std::memory_order_relaxed);
+  long x = long(k);
+  for (int i = 0; i < 2000; ++i)
+    x = x * 6364136223846793005L + 1442695040888963407L;
+  if (k % 8 == 7)
+    return make_unexpected(std::make_error_code(std::errc::no_such_file_or_directory));
+  return x;
+}
+
+// Per thread sequences of keys, drawn up front.
+std::vector<std::vector<std::size_t> > zipf_keys()
+{
+  std::vector<double> cdf(keys);
+  double sum = 0;
+  for (std::size_t i = 0; i < keys; ++i)
+    cdf[i] = sum += 1 / std::pow(double(i + 1), 0.99);
+  std::vector<std::vector<std::size_t> > r(threads);
+  for (std::size_t t = 0; t < threads; ++t)
+  {
+    std::mt19937_64 gen(t);
+    std::uniform_real_distribution<double> u(0, sum);
+    for (std::size_t i = 0; i < lookups; ++i)
+      r[t].push_back(std::lower_bound(cdf.begin(), cdf.end(), u(gen)) - cdf.begin());
+  }
+  return r;
+}
+
+template <class F>
+void run(char const* name, std::vector<std::vector<std::size_t> > const& ks, F f)
+{
+  double best = 1e300;
+  std::size_t calls = 0;
+  for (int rep = 0; rep < 3; ++rep)
+  {
+    backend_calls = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> ts;
+    for (std::size_t t = 0; t < threads; ++t)
+      ts.push_back(std::thread([&ks, &f, t]
+      {
+        long sink = 0;
+        for (std::size_t i = 0; i < lookups; ++i)
+        {
+          result r = f(ks[t][i]);
+          sink += r.valid() ? *r : 1;
+        }
+        volatile long s = sink;
+        (void)s;
+      }));
+    for (std::size_t t = 0; t < threads; ++t)
+      ts[t].join();
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    best = (std::min)(best, d.count());
+    calls = backend_calls;
+  }
+  std::cout << name << double(threads * lookups) / best / 1e6 << " M lookups/s, "
+      << calls << " backend calls" << std::endl;
+}
+
+void run_memoize(char const* name, std::vector<std::vector<std::size_t> > const& ks,
+    std::size_t errors, std::size_t shards)
+{
+  memoize_options o;
+  o.value_capacity = 16384;
+  o.error_capacity = errors;
+  o.error_ttl = std::chrono::seconds(10);
+  o.shards = shards;
+  // kept warm across the repetitions, the counters add up over all three
+  memoize<std::size_t, result> c(backend, o);
+  run(name, ks, [&c](std::size_t k) { return c(k); });
+  memoize_stats s = c.stats();
+  std::cout << "    hits " << s.value_hits << "/" << s.error_hits
+      << ", misses " << s.value_misses << "/" << s.error_misses
+      << ", coalesced " << s.coalesced << ", evictions " << s.evictions << std::endl;
+}
+
+int main()
+{
+  std::vector<std::vector<std::size_t> > const ks = zipf_keys();
+  run("backend alone                     ", ks, backend);
+  run_memoize("memoize, values only, 64 shards   ", ks, 0, 64);
+  run_memoize("memoize, errors too, 1 shard      ", ks, 4096, 1);
+  run_memoize("memoize, errors too, 64 shards    ", ks, 4096, 64);
+  return 0;
+}
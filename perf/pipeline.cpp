@@ -0,0 +1,152 @@
+//! \file pipeline.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Pipelines of depth 4, 16 and 64, alternating a map that increments and a
+// bind that fails past a bound, over 1024 inputs of which one in 16 is an
+// error: chained e.map(f).bind(g)..., the fused e | fmap(f) | fbind(g)...,
+// and the hand-written early returns they stand for.
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/pipeline.hpp>
+#include <chrono>
+#include <iostream>
+#include <system_error>
+#include <vector>
+
+using namespace boost;
+
+typedef expected<long, std::error_code> result;
+
+struct inc
+{
+  long operator()(long v) const { return v + 1; }
+};
+
+struct check
+{
+  result operator()(long v) const
+  {
+    if (BOOST_UNLIKELY(v > 1000000000L))
+      return make_unexpected(std::make_error_code(std::errc::value_too_large));
+    return v;
+  }
+};
+
+// e.map(inc).bind(check), N / 2 times
+template <int N>
+struct chained
+{
+  static result run(result e)
+  {
+    return chained<N - 2>::run(e.map(inc()).bind(check()));
+  }
+};
+template <>
+struct chained<0>
+{
+  static result run(result e) { return e; }
+};
+
+// fmap(inc) | fbind(check), N / 2 times
+template <int N>
+struct stages
+{
+  static auto make() -> decltype(fmap(inc()) | fbind(check()) | stages<N - 2>::make())
+  {
+    return fmap(inc()) | fbind(check()) | stages<N - 2>::make();
+  }
+};
+template <>
+struct stages<0>
+{
+  static pipeline<> make() { return pipeline<>(std::tuple<>()); }
+};
+
+template <int N>
+struct hand_written
+{
+  static result run(long v)
+  {
+    v = v + 1;
+    if (BOOST_UNLIKELY(v > 1000000000L))
+      return make_unexpected(std::make_error_code(std::errc::value_too_large));
+    return hand_written<N - 2>::run(v);
+  }
+};
+template <>
+struct hand_written<0>
+{
+  static result run(long v) { return v; }
+};
+
+template <int N>
+BOOST_NOINLINE result run_chained(result const& e)
+{
+  return chained<N>::run(e);
+}
+
+template <int N>
+BOOST_NOINLINE result run_fused(result const& e)
+{
+  return e | stages<N>::make();
+}
+
+template <int N>
+BOOST_NOINLINE result run_hand_written(result const& e)
+{
+  if (! e.valid())
+    return e;
+  return hand_written<N>::run(*e);
+}
+
+template <class F>
+double best_ns(std::vector<result> const& in, F f)
+{
+  double best = 1e300;
+  for (int rep = 0; rep < 5; ++rep)
+  {
+    long sink = 0;
+    std::size_t const rounds = 2000;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t k = 0; k < rounds; ++k)
+      for (std::size_t i = 0; i < in.size(); ++i)
+      {
+        result r = f(in[i]);
+        sink += r.valid() ? *r : 1;
+      }
+    std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+    volatile long s = sink;
+    (void)s;
+    best = (std::min)(best, d.count() / (rounds * in.size()));
+  }
+  return best;
+}
+
+template <int N>
+void depth(std::vector<result> const& in)
+{
+  std::cout << "depth " << N << std::endl;
+  std::cout << "  e.map(f).bind(g)...     " << best_ns(in, run_chained<N>) << " ns" << std::endl;
+  std::cout << "  e | fmap(f) | fbind(g)  " << best_ns(in, run_fused<N>) << " ns" << std::endl;
+  std::cout << "  hand-written            " << best_ns(in, run_hand_written<N>) << " ns" << std::endl;
+}
+
+int main()
+{
+  std::vector<result> in;
+  for (long i = 0; i < 1024; ++i)
+    if (i % 16 == 0)
+      in.push_back(make_unexpected(std::make_error_code(std::errc::invalid_argument)));
+    else
+      in.push_back(i);
+  depth<4>(in);
+  depth<16>(in);
+  depth<64>(in);
+  return 0;
+}
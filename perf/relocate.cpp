@@ -0,0 +1,102 @@
+//! \file relocate.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Growth of a buffer of expected by push back: std::vector, which moves and
+// destroys the elements one by one on reallocation, against the same
+// doubling growth done with uninitialized_relocate.
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/trivially_relocatable.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace boost;
+
+// Minimal doubling buffer, only what the benchmark needs.
+template <class T>
+class growing_buffer
+{
+public:
+  growing_buffer() : data_(0), size_(0), capacity_(0) {}
+  ~growing_buffer()
+  {
+    for (std::size_t i = 0; i < size_; ++i) data_[i].~T();
+    std::free(data_);
+  }
+
+  void push_back(T&& x)
+  {
+    if (size_ == capacity_)
+    {
+      std::size_t const capacity = capacity_ ? 2 * capacity_ : 1;
+      T* data = static_cast<T*>(std::malloc(capacity * sizeof(T)));
+      if (! data) throw std::bad_alloc();
+      uninitialized_relocate(data_, data_ + size_, data);
+      std::free(data_);
+      data_ = data;
+      capacity_ = capacity;
+    }
+    ::new (static_cast<void*>(data_ + size_)) T(std::move(x));
+    ++size_;
+  }
+
+private:
+  T* data_;
+  std::size_t size_;
+  std::size_t capacity_;
+};
+
+// Times push back of n ready made elements, their creation is not timed.
+template <class E, class Buffer, class Make>
+double best_us(std::size_t n, Make make)
+{
+  double best = 1e300;
+  for (int rep = 0; rep < 200; ++rep)
+  {
+    std::vector<E> source;
+    source.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) source.push_back(make(i));
+    std::chrono::duration<double, std::micro> d;
+    {
+      auto start = std::chrono::steady_clock::now();
+      Buffer v;
+      for (std::size_t i = 0; i < n; ++i) v.push_back(std::move(source[i]));
+      d = std::chrono::steady_clock::now() - start;
+    }
+    best = (std::min)(best, d.count());
+  }
+  return best;
+}
+
+template <class E, class Make>
+void run(char const* name, std::size_t n, Make make)
+{
+  double vector = best_us<E, std::vector<E>>(n, make);
+  double relocating = best_us<E, growing_buffer<E>>(n, make);
+  std::cout << name << (is_trivially_relocatable<E>::value ? " (relocatable)" : " (not relocatable)")
+            << ": std::vector " << vector << " us, relocate " << relocating << " us (x"
+            << vector / relocating << ")" << std::endl;
+}
+
+int main()
+{
+  std::size_t const n = 1 << 12; // stays in cache, measures the moves and not the page faults
+  run<expected<std::string, std::exception_ptr>>("expected<std::string, std::exception_ptr>", n,
+      [](std::size_t i) { return expected<std::string, std::exception_ptr>(std::string(i % 32, 'x')); });
+  run<expected<std::unique_ptr<int>, std::exception_ptr>>("expected<std::unique_ptr<int>, std::exception_ptr>", n,
+      [](std::size_t i) { return expected<std::unique_ptr<int>, std::exception_ptr>(std::unique_ptr<int>(new int(int(i)))); });
+  run<expected<std::shared_ptr<int>, std::exception_ptr>>("expected<std::shared_ptr<int>, std::exception_ptr>", n,
+      [](std::size_t i) { return expected<std::shared_ptr<int>, std::exception_ptr>(std::make_shared<int>(int(i))); });
+  return 0;
+}
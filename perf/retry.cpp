@@ -0,0 +1,103 @@
+//! \file retry.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// An operation failing with a transient error_code on 3 calls out of 4,
+// retried up to 8 times with a sleeper that does not sleep: the ad-hoc
+// loop it replaces against retry(f, policy). Reports the time per attempt
+// and the allocations per call, counted by replacing operator new.
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/algorithms/retry.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <system_error>
+
+using namespace boost;
+using namespace boost::expected_alg;
+
+std::size_t allocations = 0;
+
+void* operator new(std::size_t n)
+{
+  ++allocations;
+  if (void* p = std::malloc(n))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) BOOST_NOEXCEPT
+{
+  std::free(p);
+}
+
+typedef expected<long, std::error_code> result;
+
+unsigned counter = 0;
+
+BOOST_NOINLINE result operation()
+{
+  if (++counter % 4 != 0)
+    return make_unexpected(std::make_error_code(std::errc::resource_unavailable_try_again));
+  return long(counter);
+}
+
+bool transient(std::error_code const& e)
+{
+  return e == std::errc::resource_unavailable_try_again;
+}
+
+struct no_sleep
+{
+  template <class D>
+  void operator()(D) const {}
+};
+
+result ad_hoc()
+{
+  result r = operation();
+  for (int i = 1; i < 8 && ! r.valid() && transient(r.error()); ++i)
+    r = operation();
+  return r;
+}
+
+template <class F>
+void run(char const* name, F f)
+{
+  std::size_t const n = 10000000;
+  double best = 1e300;
+  std::size_t allocs = 0;
+  for (int rep = 0; rep < 5; ++rep)
+  {
+    counter = 0;
+    long sink = 0;
+    allocations = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < n; ++i)
+      sink += *f();
+    std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+    allocs = allocations;
+    volatile long s = sink;
+    (void)s;
+    best = (std::min)(best, d.count() / counter);
+  }
+  std::cout << name << best << " ns/attempt, " << double(allocs) / n << " allocations/call" << std::endl;
+}
+
+int main()
+{
+  run("ad-hoc loop      ", ad_hoc);
+  run("retry(f, policy) ", []
+  {
+    return retry(operation, make_retry_policy<std::chrono::steady_clock>(transient, no_sleep())
+        .max_attempts(8).jitter(0.5));
+  });
+  return 0;
+}
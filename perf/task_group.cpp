@@ -0,0 +1,93 @@
+//! \file task_group.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Fan-out of 64 children of about 20us each, joined into a vector of
+// results: with std::async and a thread per child, collecting futures of
+// expected, against a task_group on a work_stealing_pool. Measured with all
+// children succeeding, and with the first child failing at once.
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/task_group.hpp>
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+using namespace boost;
+
+std::size_t const children = 64;
+
+BOOST_NOINLINE long work(std::size_t i)
+{
+  long x = long(i);
+  for (int k = 0; k < 20000; ++k)
+    x = x * 6364136223846793005L + 1442695040888963407L;
+  return x;
+}
+
+expected<long> child(std::size_t i, bool fail)
+{
+  if (fail && i == 0)
+    return make_unexpected(std::make_exception_ptr(std::runtime_error("child")));
+  return work(i);
+}
+
+expected<std::vector<long> > with_async(bool fail)
+{
+  std::vector<std::future<expected<long> > > fs;
+  for (std::size_t i = 0; i < children; ++i)
+    fs.push_back(std::async(std::launch::async, [i, fail] { return child(i, fail); }));
+  std::vector<long> values;
+  std::exception_ptr error;
+  for (std::size_t i = 0; i < children; ++i)
+  {
+    expected<long> r = fs[i].get();
+    if (r.valid())
+      values.push_back(*r);
+    else if (! error)
+      error = r.error();
+  }
+  if (error)
+    return make_unexpected(error);
+  return values;
+}
+
+bool with_task_group(work_stealing_pool& pool, bool fail)
+{
+  task_group<long> g(pool, children);
+  for (std::size_t i = 0; i < children; ++i)
+    g.spawn([i, fail] { return child(i, fail); });
+  return g.join().valid();
+}
+
+template <class F>
+double best_us(F f)
+{
+  double best = 1e300;
+  for (int rep = 0; rep < 20; ++rep)
+  {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double, std::micro> d = std::chrono::steady_clock::now() - start;
+    best = (std::min)(best, d.count());
+  }
+  return best;
+}
+
+int main()
+{
+  work_stealing_pool pool;
+  std::cout << "std::async, all succeed       " << best_us([] { with_async(false); }) << " us" << std::endl;
+  std::cout << "task_group, all succeed       " << best_us([&pool] { with_task_group(pool, false); }) << " us" << std::endl;
+  std::cout << "std::async, first fails       " << best_us([] { with_async(true); }) << " us" << std::endl;
+  std::cout << "task_group, first fails       " << best_us([&pool] { with_task_group(pool, true); }) << " us" << std::endl;
+  return 0;
+}
@@ -0,0 +1,73 @@
+//! \file work_stealing_pool.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Fork/join tree of 2^20 leaves: every node submits its left half as a
+// task, computes its right half and joins. Run serially as plain calls,
+// then on work_stealing_pool with one worker and one per hardware thread.
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/work_stealing_pool.hpp>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace boost;
+
+int const depth = 20;
+
+BOOST_NOINLINE long serial(int d)
+{
+  if (d == 0)
+    return 1;
+  return serial(d - 1) + serial(d - 1);
+}
+
+long forked(work_stealing_pool& pool, int d)
+{
+  if (d == 0)
+    return 1;
+  task_handle<long> left = pool.submit([&pool, d] { return forked(pool, d - 1); });
+  long const right = forked(pool, d - 1);
+  return *left.get() + right;
+}
+
+template <class F>
+double best_ns_per_task(F f)
+{
+  std::size_t const tasks = std::size_t(1) << depth;
+  double best = 1e300;
+  for (int rep = 0; rep < 5; ++rep)
+  {
+    auto start = std::chrono::steady_clock::now();
+    long const leaves = f();
+    std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+    if (leaves != long(tasks))
+      std::cout << "wrong count" << std::endl;
+    best = (std::min)(best, d.count() / tasks);
+  }
+  return best;
+}
+
+double on_pool(std::size_t threads)
+{
+  work_stealing_pool pool(threads);
+  return best_ns_per_task([&pool]
+  {
+    return *pool.submit([&pool] { return forked(pool, depth); }).get();
+  });
+}
+
+int main()
+{
+  std::size_t const hw = (std::max)(std::thread::hardware_concurrency(), 1u);
+  std::cout << "serial calls                 " << best_ns_per_task([] { return serial(depth); }) << " ns/task" << std::endl;
+  std::cout << "work_stealing_pool, 1 worker " << on_pool(1) << " ns/task" << std::endl;
+  std::cout << "work_stealing_pool, " << hw << " workers " << on_pool(hw) << " ns/task" << std::endl;
+  return 0;
+}
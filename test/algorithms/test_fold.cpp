@@ -0,0 +1,133 @@
+//! \file test_fold.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - Algorithm fold"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/algorithms/fold.hpp>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+using namespace boost::expected_alg;
+
+namespace
+{
+  struct thread_executor
+  {
+    template <class F>
+    void execute(F f)
+    {
+      std::thread(f).detach();
+    }
+  };
+
+  // Sums the elements, fails on a negative one.
+  struct checked_sum
+  {
+    std::atomic<int>* calls;
+
+    expected<long, std::string> operator()(long acc, long x) const
+    {
+      if (calls) ++*calls;
+      if (x < 0)
+        return make_unexpected(std::string("negative ") + std::to_string(x));
+      return acc + x;
+    }
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(Fold)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Fold_AllValid)
+{
+  std::vector<long> v;
+  for (long i = 1; i <= 10; ++i) v.push_back(i);
+
+  expected<long, std::string> r = fold(v, 0L, checked_sum{nullptr});
+
+  BOOST_REQUIRE(r.valid());
+  BOOST_CHECK_EQUAL(*r, 55);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Fold_StopsAtFirstError)
+{
+  std::vector<long> v;
+  v.push_back(1);
+  v.push_back(-2);
+  v.push_back(-3);
+  v.push_back(4);
+  std::atomic<int> calls(0);
+
+  expected<long, std::string> r = fold(v, 0L, checked_sum{&calls});
+
+  BOOST_REQUIRE(! r.valid());
+  BOOST_CHECK_EQUAL(r.error(), "negative -2");
+  BOOST_CHECK_EQUAL(calls.load(), 2);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Fold_Empty)
+{
+  std::vector<long> v;
+  expected<long, std::string> r = fold(v, 7L, checked_sum{nullptr});
+  BOOST_REQUIRE(r.valid());
+  BOOST_CHECK_EQUAL(*r, 7);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ParReduce_MatchesFold)
+{
+  std::vector<long> v;
+  for (long i = 0; i < 100000; ++i) v.push_back(i % 97);
+  thread_executor ex;
+
+  expected<long, std::string> r = par_reduce(v, 5L, checked_sum{nullptr}, ex, 4);
+
+  BOOST_REQUIRE(r.valid());
+  BOOST_CHECK_EQUAL(*r, *fold(v, 5L, checked_sum{nullptr}));
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ParReduce_ReturnsFirstError)
+{
+  std::vector<long> v(100000, 1);
+  v[70000] = -7;
+  v[90000] = -9;
+  v[20000] = -2;
+  thread_executor ex;
+
+  expected<long, std::string> r = par_reduce(v, 0L, checked_sum{nullptr}, ex, 4);
+
+  BOOST_REQUIRE(! r.valid());
+  BOOST_CHECK_EQUAL(r.error(), "negative -2");
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ParReduce_RethrowsException)
+{
+  std::vector<long> v(100000, 1);
+  v[60000] = -1;
+  thread_executor ex;
+  auto throwing = [](long acc, long x) -> expected<long, std::string>
+  {
+    if (x < 0) throw std::runtime_error("negative");
+    return acc + x;
+  };
+
+  BOOST_CHECK_THROW(par_reduce(v, 0L, throwing, ex, 4), std::runtime_error);
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,120 @@
+//! \file test_masked_arithmetic.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - Algorithm masked arithmetic"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/expected_buffer.hpp>
+#include <boost/expected/algorithms/masked_arithmetic.hpp>
+#include <cstdint>
+#include <limits>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+using namespace boost::expected_alg;
+
+namespace
+{
+  enum error_code { none, bad_input, division_by_zero, overflow };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(MaskedArithmetic)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedBuffer_RoundTrip)
+{
+  expected_buffer<int, error_code> b;
+  b.push_back(1);
+  b.push_back(make_unexpected(bad_input));
+
+  BOOST_REQUIRE_EQUAL(b.size(), 2u);
+  BOOST_CHECK(b[0].valid());
+  BOOST_CHECK_EQUAL(*b[0], 1);
+  BOOST_CHECK(! b[1].valid());
+  BOOST_CHECK_EQUAL(b[1].error(), bad_input);
+
+  b.set_error(0, overflow);
+  b.set_value(1, 3);
+  BOOST_CHECK_EQUAL(b[0].error(), overflow);
+  BOOST_CHECK_EQUAL(*b[1], 3);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(MaskedPlus_PropagatesFirstError)
+{
+  expected_buffer<float, error_code> a(3), b(3), out;
+  a.set_value(0, 1.5f);
+  b.set_value(0, 2.0f);
+  a.set_error(1, bad_input);
+  b.set_error(1, overflow);
+  a.set_value(2, 1.0f);
+  b.set_error(2, overflow);
+
+  masked_plus(a, b, out);
+
+  BOOST_REQUIRE_EQUAL(out.size(), 3u);
+  BOOST_CHECK_EQUAL(*out[0], 3.5f);
+  BOOST_CHECK_EQUAL(out[1].error(), bad_input);
+  BOOST_CHECK_EQUAL(out[2].error(), overflow);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(MaskedDivides_ZeroDivisor)
+{
+  expected_buffer<double, error_code> a(2), b(2), out;
+  a.set_value(0, 1.0);
+  b.set_value(0, 4.0);
+  a.set_value(1, 1.0);
+  b.set_value(1, 0.0);
+
+  masked_divides(a, b, out, division_by_zero);
+
+  BOOST_CHECK_EQUAL(*out[0], 0.25);
+  BOOST_CHECK_EQUAL(out[1].error(), division_by_zero);
+
+  expected_buffer<int, error_code> ia(2), ib(2), iout;
+  ia.set_value(0, (std::numeric_limits<int>::min)());
+  ib.set_value(0, -1);
+  ia.set_value(1, 7);
+  ib.set_value(1, 0);
+  masked_divides(ia, ib, iout, division_by_zero);
+  BOOST_CHECK_EQUAL(iout[0].error(), division_by_zero);
+  BOOST_CHECK_EQUAL(iout[1].error(), division_by_zero);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(MaskedCheckedMultiplies_Overflow)
+{
+  expected_buffer<std::int32_t, error_code> a(3), b(3), out;
+  a.set_value(0, 1000);
+  b.set_value(0, 1000);
+  a.set_value(1, 100000);
+  b.set_value(1, 100000);
+  a.set_error(2, bad_input);
+  b.set_value(2, 100000);
+
+  masked_checked_multiplies(a, b, out, overflow);
+
+  BOOST_CHECK_EQUAL(*out[0], 1000000);
+  BOOST_CHECK_EQUAL(out[1].error(), overflow);
+  BOOST_CHECK_EQUAL(out[2].error(), bad_input);
+
+  expected_buffer<std::int64_t, error_code> la(2), lb(2), lout;
+  la.set_value(0, std::int64_t(1) << 31);
+  lb.set_value(0, std::int64_t(1) << 31);
+  la.set_value(1, std::int64_t(1) << 32);
+  lb.set_value(1, std::int64_t(1) << 31);
+  masked_checked_multiplies(la, lb, lout, overflow);
+  BOOST_CHECK_EQUAL(*lout[0], std::int64_t(1) << 62);
+  BOOST_CHECK_EQUAL(lout[1].error(), overflow);
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
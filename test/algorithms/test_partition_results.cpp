@@ -0,0 +1,139 @@
+//! \file test_partition_results.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - Algorithm partition_results"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/algorithms/partition_results.hpp>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+using namespace boost::expected_alg;
+
+namespace
+{
+  // deterministic pattern with roughly one error out of ten
+  std::vector<expected<int, int>> make_results(std::size_t n)
+  {
+    std::vector<expected<int, int>> v;
+    v.reserve(n);
+    unsigned seed = 12345;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      seed = seed * 1103515245u + 12345u;
+      if ((seed >> 16) % 10 == 0)
+        v.push_back(make_unexpected(-int(i)));
+      else
+        v.push_back(int(i));
+    }
+    return v;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(PartitionResults)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(PartitionResults_Mixed)
+{
+  std::vector<expected<int, int>> v;
+  v.push_back(1);
+  v.push_back(make_unexpected(-1));
+  v.push_back(2);
+  v.push_back(make_unexpected(-2));
+  v.push_back(3);
+
+  std::vector<int> values, errors;
+  partition_results(v, std::back_inserter(values), std::back_inserter(errors));
+
+  BOOST_REQUIRE_EQUAL(values.size(), 3u);
+  BOOST_REQUIRE_EQUAL(errors.size(), 2u);
+  BOOST_CHECK_EQUAL(values[0], 1);
+  BOOST_CHECK_EQUAL(values[1], 2);
+  BOOST_CHECK_EQUAL(values[2], 3);
+  BOOST_CHECK_EQUAL(errors[0], -1);
+  BOOST_CHECK_EQUAL(errors[1], -2);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(PartitionResults_ReturnsOutputEnds)
+{
+  std::vector<expected<int, int>> v = make_results(100);
+  std::vector<int> values(100), errors(100);
+
+  std::pair<std::vector<int>::iterator, std::vector<int>::iterator> r =
+      partition_results(v, values.begin(), errors.begin());
+
+  BOOST_CHECK_EQUAL((r.first - values.begin()) + (r.second - errors.begin()), 100);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(PartitionResults_MovesPayloads)
+{
+  std::list<expected<std::unique_ptr<int>, std::string>> l;
+  l.push_back(std::unique_ptr<int>(new int(1)));
+  l.push_back(make_unexpected(std::string("e1")));
+  l.push_back(std::unique_ptr<int>(new int(2)));
+
+  std::vector<std::unique_ptr<int>> values;
+  std::vector<std::string> errors;
+  partition_results(l, std::back_inserter(values), std::back_inserter(errors));
+
+  BOOST_REQUIRE_EQUAL(values.size(), 2u);
+  BOOST_REQUIRE_EQUAL(errors.size(), 1u);
+  BOOST_CHECK_EQUAL(*values[0], 1);
+  BOOST_CHECK_EQUAL(*values[1], 2);
+  BOOST_CHECK_EQUAL(errors[0], "e1");
+  BOOST_CHECK(! *l.front());
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(PartitionResults_KernelMatchesReference)
+{
+  // cover uniform, mixed and partial blocks of the compaction kernel
+  std::vector<expected<int, int>> v = make_results(1000);
+  for (std::size_t i = 64; i < 128; ++i) v[i] = int(i);
+  for (std::size_t i = 128; i < 192; ++i) v[i] = make_unexpected(-int(i));
+
+  std::vector<int> ref_values, ref_errors;
+  for (std::size_t i = 0; i < v.size(); ++i)
+  {
+    if (v[i]) ref_values.push_back(*v[i]);
+    else ref_errors.push_back(v[i].error());
+  }
+
+  std::vector<int> values, errors;
+  partition_results(v, std::back_inserter(values), std::back_inserter(errors));
+
+  BOOST_CHECK(values == ref_values);
+  BOOST_CHECK(errors == ref_errors);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(PartitionResults_ParallelMatchesSequential)
+{
+  std::vector<expected<int, int>> v = make_results(100000);
+
+  std::vector<int> values, errors;
+  partition_results(v, std::back_inserter(values), std::back_inserter(errors));
+
+  std::vector<int> par_values, par_errors;
+  par_partition_results(v, std::back_inserter(par_values), std::back_inserter(par_errors), 4);
+
+  BOOST_CHECK(par_values == values);
+  BOOST_CHECK(par_errors == errors);
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,185 @@
+//! \file test_retry.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - Algorithm retry"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/algorithms/retry.hpp>
+#include <chrono>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+using namespace boost::expected_alg;
+
+namespace
+{
+  // A clock only moved by the sleeper.
+  struct fake_clock
+  {
+    typedef std::chrono::milliseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<fake_clock> time_point;
+    static const bool is_steady = true;
+
+    static time_point now() { return time_point(duration(ticks)); }
+
+    static rep ticks;
+  };
+  fake_clock::rep fake_clock::ticks = 0;
+
+  struct fake_sleeper
+  {
+    void operator()(fake_clock::duration d) const
+    {
+      waits->push_back(d.count());
+      fake_clock::ticks += d.count();
+    }
+    std::vector<long>* waits;
+  };
+
+  typedef expected<int, std::error_code> result;
+
+  bool transient(std::error_code const& e)
+  {
+    return e == std::errc::resource_unavailable_try_again;
+  }
+
+  // Fails with error until called n times.
+  struct flaky
+  {
+    result operator()()
+    {
+      if (++calls < n)
+        return make_unexpected(std::make_error_code(error));
+      return calls;
+    }
+    int n;
+    std::errc error;
+    int calls;
+  };
+
+  retry_policy<bool (*)(std::error_code const&), fake_sleeper, fake_clock>
+  policy(std::vector<long>& waits)
+  {
+    fake_sleeper s = { &waits };
+    return make_retry_policy<fake_clock>(&transient, s);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(Retry)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Retry_FirstAttempt)
+{
+  std::vector<long> waits;
+  flaky f = { 1, std::errc::resource_unavailable_try_again, 0 };
+  retry_stats stats;
+  result r = retry(f, policy(waits), stats);
+  BOOST_REQUIRE(r.valid());
+  BOOST_CHECK_EQUAL(stats.attempts, 1u);
+  BOOST_CHECK(stats.outcome == retry_outcome::succeeded);
+  BOOST_CHECK(waits.empty());
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Retry_ExponentialBackoff)
+{
+  std::vector<long> waits;
+  flaky f = { 5, std::errc::resource_unavailable_try_again, 0 };
+  retry_stats stats;
+  result r = retry(f, policy(waits).max_attempts(10).jitter(0)
+      .backoff(fake_clock::duration(10), fake_clock::duration(50)), stats);
+  BOOST_REQUIRE(r.valid());
+  BOOST_CHECK_EQUAL(*r, 5);
+  BOOST_CHECK_EQUAL(f.calls, 5);
+  BOOST_CHECK_EQUAL(stats.attempts, 5u);
+  BOOST_REQUIRE_EQUAL(waits.size(), 4u);
+  BOOST_CHECK_EQUAL(waits[0], 10);
+  BOOST_CHECK_EQUAL(waits[1], 20);
+  BOOST_CHECK_EQUAL(waits[2], 40);
+  BOOST_CHECK_EQUAL(waits[3], 50);
+  BOOST_CHECK(stats.slept == std::chrono::milliseconds(120));
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Retry_Jitter)
+{
+  std::vector<long> waits;
+  flaky f = { 100, std::errc::resource_unavailable_try_again, 0 };
+  retry(f, policy(waits).max_attempts(100).jitter(0.5)
+      .backoff(fake_clock::duration(1000), fake_clock::duration(1000)));
+  BOOST_REQUIRE_EQUAL(waits.size(), 99u);
+  bool varies = false;
+  for (std::size_t i = 0; i < waits.size(); ++i)
+  {
+    BOOST_CHECK(waits[i] >= 500 && waits[i] <= 1000);
+    varies = varies || waits[i] != waits[0];
+  }
+  BOOST_CHECK(varies);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Retry_NotRetryable)
+{
+  std::vector<long> waits;
+  flaky f = { 5, std::errc::invalid_argument, 0 };
+  retry_stats stats;
+  result r = retry(f, policy(waits).max_attempts(10), stats);
+  BOOST_CHECK(r.error() == std::errc::invalid_argument);
+  BOOST_CHECK_EQUAL(stats.attempts, 1u);
+  BOOST_CHECK(stats.outcome == retry_outcome::not_retryable);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Retry_AttemptsExhausted)
+{
+  std::vector<long> waits;
+  flaky f = { 5, std::errc::resource_unavailable_try_again, 0 };
+  retry_stats stats;
+  result r = retry(f, policy(waits).max_attempts(3), stats);
+  BOOST_CHECK(r.error() == std::errc::resource_unavailable_try_again);
+  BOOST_CHECK_EQUAL(f.calls, 3);
+  BOOST_CHECK_EQUAL(stats.attempts, 3u);
+  BOOST_CHECK(stats.outcome == retry_outcome::attempts_exhausted);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Retry_Deadline)
+{
+  std::vector<long> waits;
+  flaky f = { 100, std::errc::resource_unavailable_try_again, 0 };
+  retry_stats stats;
+  // waits 10, 20, 40: the next one, 80, would end after 100
+  result r = retry(f, policy(waits).max_attempts(100).jitter(0)
+      .backoff(fake_clock::duration(10), fake_clock::duration(1000))
+      .deadline(fake_clock::duration(100)), stats);
+  BOOST_CHECK(! r.valid());
+  BOOST_CHECK_EQUAL(stats.attempts, 4u);
+  BOOST_CHECK_EQUAL(waits.size(), 3u);
+  BOOST_CHECK(stats.outcome == retry_outcome::deadline_exceeded);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Retry_ExceptionPtr)
+{
+  int calls = 0;
+  expected<int> r = retry([&calls]() -> expected<int>
+  {
+    if (++calls < 2)
+      return make_unexpected(std::make_exception_ptr(std::runtime_error("busy")));
+    return 7;
+  }, make_retry_policy([](std::exception_ptr const&) { return true; })
+      .backoff(std::chrono::microseconds(1), std::chrono::microseconds(1)));
+  BOOST_CHECK_EQUAL(*r, 7);
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
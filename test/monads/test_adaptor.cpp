@@ -0,0 +1,131 @@
+//! \file test_adaptor.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - Adaptor"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected_monad.hpp>
+#include <boost/functional/monads/adaptor.hpp>
+#include <utility>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+using namespace boost::functional;
+
+namespace
+{
+  int copies = 0;
+
+  struct payload
+  {
+    explicit payload(int v = 0) : value(v) {}
+    payload(payload const& x) : value(x.value) { ++copies; }
+    payload(payload&& x) : value(x.value) {}
+    payload& operator=(payload const& x) { value = x.value; ++copies; return *this; }
+    payload& operator=(payload&& x) { value = x.value; return *this; }
+    int value;
+  };
+
+  struct counted_function
+  {
+    counted_function() {}
+    counted_function(counted_function const&) { ++copies; }
+    counted_function(counted_function&&) {}
+
+    payload operator()(payload p) const { ++p.value; return p; }
+  };
+
+  typedef expected<payload, int> payload_value;
+  typedef expected<int, payload> payload_error;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(Adaptor)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Adaptor_IfValuedNoCopy)
+{
+  copies = 0;
+  payload_value r = payload_value(payload(1)).then(if_valued(counted_function()));
+  BOOST_CHECK_EQUAL(r->value, 2);
+  r = std::move(r).then(if_valued(counted_function())).then(if_valued(counted_function()));
+  BOOST_CHECK_EQUAL(r->value, 4);
+  BOOST_CHECK_EQUAL(copies, 0);
+
+  // Errors are moved through.
+  payload_error e = make_unexpected(payload(7));
+  expected<int, payload> r2 = std::move(e).then(if_valued([](int i) { return i + 1; }));
+  BOOST_CHECK_EQUAL(r2.error().value, 7);
+  BOOST_CHECK_EQUAL(copies, 0);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Adaptor_IfUnexpectedNoCopy)
+{
+  copies = 0;
+  payload_error e = make_unexpected(payload(3));
+  payload_error r = std::move(e).then(if_unexpected([](payload p) { return p.value; }));
+  BOOST_CHECK_EQUAL(*r, 3);
+
+  payload_value v = payload(5);
+  payload_value r2 = std::move(v).then(if_unexpected([](int) { return payload(0); }));
+  BOOST_CHECK_EQUAL(r2->value, 5);
+  BOOST_CHECK_EQUAL(copies, 0);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Adaptor_LvalueIsCopied)
+{
+  // An lvalue given to the adaptor itself is left as it is.
+  payload_value v = payload(1);
+  auto a = if_valued(counted_function());
+  copies = 0;
+  payload_value r = a(v);
+  BOOST_CHECK_EQUAL(r->value, 2);
+  BOOST_CHECK_EQUAL(v->value, 1);
+  BOOST_CHECK_EQUAL(copies, 1);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Adaptor_Pipe)
+{
+  auto add_one = [](int i) { return i + 1; };
+  auto recover = [](payload p) { return p.value * 10; };
+
+  copies = 0;
+  expected<int, payload> ok = 1;
+  expected<int, payload> r = std::move(ok).then(if_valued(add_one) | if_unexpected(recover) | if_valued(add_one));
+  BOOST_CHECK_EQUAL(*r, 3);
+
+  expected<int, payload> ko = make_unexpected(payload(2));
+  r = std::move(ko).then(if_valued(add_one) | if_unexpected(recover) | if_valued(add_one));
+  BOOST_CHECK_EQUAL(*r, 21);
+  BOOST_CHECK_EQUAL(copies, 0);
+
+  // Same as the chained then().
+  expected<int, payload> ko2 = make_unexpected(payload(2));
+  expected<int, payload> r2 = std::move(ko2).then(if_valued(add_one)).then(if_unexpected(recover)).then(if_valued(add_one));
+  BOOST_CHECK_EQUAL(*r2, *r);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Adaptor_EmptyFunctorsTakeNoSpace)
+{
+  auto f = [](int i) { return i; };
+  auto g = [](payload) { return 0; };
+  auto six = []() { return 6; };
+  BOOST_CHECK_EQUAL(sizeof(if_valued(f)), 1u);
+  BOOST_CHECK_EQUAL(sizeof(if_valued(f) | if_unexpected(g)), 1u);
+  BOOST_CHECK_EQUAL(sizeof(ident(six)), 1u);
+
+  int k = 0;
+  auto h = [&k](int i) { return i + k; };
+  BOOST_CHECK_EQUAL(sizeof(if_valued(h)), sizeof(&k));
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
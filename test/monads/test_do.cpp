@@ -0,0 +1,167 @@
+//! \file test_do.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - DO"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/functional/monads/do.hpp>
+#include <boost/expected/expected_monad.hpp>
+#include <boost/expected/optional_monad.hpp>
+#include <memory>
+#include <stdexcept>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+
+namespace
+{
+  // Constructible from an exception, for BOOST_EXPECTED_CATCH_EXCEPTIONS.
+  struct odd
+  {
+    odd() : value(-1) {}
+    explicit odd(int v) : value(v) {}
+    odd(std::exception const&) : value(-1) {}
+    int value;
+  };
+
+  typedef expected<int, odd> result;
+
+  int calls = 0;
+
+  result half(int i)
+  {
+    ++calls;
+    if (i % 2)
+      return make_unexpected(odd(i));
+    return i / 2;
+  }
+
+  result with_do(int i)
+  {
+    return DO(
+      int a, half(i),
+      int b, half(a),
+      int c, half(b),
+      result(a + b + c));
+  }
+
+  result with_do_return(int i)
+  {
+    DO_RETURN(
+      int a, half(i),
+      int b, half(a),
+      int c, half(b),
+      result(a + b + c));
+  }
+
+  optional<int> positive(int i)
+  {
+    if (i > 0)
+      return i;
+    return none;
+  }
+
+  optional<int> sum_positive(int i, int j)
+  {
+    DO_RETURN(
+      int a, positive(i),
+      int b, positive(j),
+      a + b);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(Do)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(DoReturn_AllValued)
+{
+  result r = with_do_return(8);
+  BOOST_REQUIRE(r.valid());
+  BOOST_CHECK_EQUAL(*r, 4 + 2 + 1);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(DoReturn_FirstError)
+{
+  calls = 0;
+  result r = with_do_return(6);
+  BOOST_REQUIRE(! r.valid());
+  BOOST_CHECK_EQUAL(r.error().value, 3);
+  BOOST_CHECK_EQUAL(calls, 2);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(DoReturn_SameAsDo)
+{
+  for (int i = 0; i < 20; ++i)
+  {
+    calls = 0;
+    result a = with_do(i);
+    int const do_calls = calls;
+    calls = 0;
+    result b = with_do_return(i);
+    BOOST_CHECK_EQUAL(calls, do_calls);
+    BOOST_REQUIRE(a.valid() == b.valid());
+    if (a.valid())
+      BOOST_CHECK_EQUAL(*a, *b);
+    else
+      BOOST_CHECK_EQUAL(a.error().value, b.error().value);
+  }
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(DoReturn_MovesValue)
+{
+  typedef expected<std::unique_ptr<int>, odd> ptr;
+  struct local
+  {
+    static ptr make(int i) { return std::unique_ptr<int>(new int(i)); }
+    static expected<int, odd> f()
+    {
+      DO_RETURN(
+        std::unique_ptr<int> p, make(1),
+        std::unique_ptr<int> q, make(*p + 1),
+        *p + *q);
+    }
+  };
+  expected<int, odd> r = local::f();
+  BOOST_CHECK_EQUAL(*r, 3);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(DoReturn_Optional)
+{
+  BOOST_CHECK_EQUAL(*sum_positive(1, 2), 3);
+  BOOST_CHECK(! sum_positive(1, 0));
+  BOOST_CHECK(! sum_positive(0, 1));
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(DoReturn_Exception)
+{
+  struct local
+  {
+    static expected<int> thrower(int) { throw std::runtime_error("step"); }
+    static expected<int> f()
+    {
+      DO_RETURN(
+        int a, expected<int>(1),
+        int b, thrower(a),
+        expected<int>(a + b));
+    }
+  };
+#if defined BOOST_EXPECTED_CATCH_EXCEPTIONS
+  expected<int> r = local::f();
+  BOOST_REQUIRE(! r.valid());
+  BOOST_CHECK_THROW(std::rethrow_exception(r.error()), std::runtime_error);
+#else
+  BOOST_CHECK_THROW(local::f(), std::runtime_error);
+#endif
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
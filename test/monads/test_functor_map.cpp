@@ -0,0 +1,96 @@
+//! \file test_functor_map.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - Functor map"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected_monad.hpp>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+using namespace boost::functional;
+
+namespace
+{
+  struct sum
+  {
+    template <class ...T>
+    int operator()(T... x) const
+    {
+      int r = 0;
+      int const xs[] = { x... };
+      for (int i : xs) r += i;
+      return r;
+    }
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(FunctorMap)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(FunctorMap_AllValued)
+{
+  using namespace boost::functional::functor;
+  expected<int, std::string> e1 = 1, e2 = 2, e3 = 3;
+
+  expected<int, std::string> r = map(sum(), e1, e2, e3);
+
+  BOOST_REQUIRE(r.valid());
+  BOOST_CHECK_EQUAL(*r, 6);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(FunctorMap_FirstError)
+{
+  using namespace boost::functional::functor;
+  expected<int, std::string> e1 = 1;
+  expected<int, std::string> e2 = make_unexpected(std::string("second"));
+  expected<int, std::string> e3 = make_unexpected(std::string("third"));
+
+  expected<int, std::string> r = map(sum(), e1, e2, e3);
+
+  BOOST_REQUIRE(! r.valid());
+  BOOST_CHECK_EQUAL(r.error(), "second");
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(FunctorMap_Arity16)
+{
+  using namespace boost::functional::functor;
+  expected<int, int> e = 1;
+  expected<int, int> u = make_unexpected(15);
+
+  expected<int, int> all = map(sum(), e, e, e, e, e, e, e, e, e, e, e, e, e, e, e, e);
+  BOOST_REQUIRE(all.valid());
+  BOOST_CHECK_EQUAL(*all, 16);
+
+  expected<int, int> last = map(sum(), e, e, e, e, e, e, e, e, e, e, e, e, e, e, e, u);
+  BOOST_REQUIRE(! last.valid());
+  BOOST_CHECK_EQUAL(last.error(), 15);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(FunctorMap_Rvalues)
+{
+  using namespace boost::functional::functor;
+  expected<std::unique_ptr<int>, std::string> e1(std::unique_ptr<int>(new int(2)));
+  expected<std::unique_ptr<int>, std::string> e2(std::unique_ptr<int>(new int(3)));
+
+  expected<int, std::string> r = map([](std::unique_ptr<int> const& a, std::unique_ptr<int> const& b)
+      { return *a * *b; }, std::move(e1), std::move(e2));
+
+  BOOST_REQUIRE(r.valid());
+  BOOST_CHECK_EQUAL(*r, 6);
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,183 @@
+//! \file test_monad_exception.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - monad exception"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected_monad.hpp>
+#include <boost/expected/cancellation.hpp>
+#include <boost/functional/function_ref.hpp>
+#include <boost/functional/inplace_function.hpp>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <stdexcept>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+static std::size_t allocations = 0;
+
+void* operator new(std::size_t n)
+{
+  ++allocations;
+  if (void* p = std::malloc(n))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) BOOST_NOEXCEPT
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) BOOST_NOEXCEPT
+{
+  std::free(p);
+}
+
+using namespace boost;
+using namespace boost::functional;
+
+namespace
+{
+  struct not_divisible
+  {
+    int i, j;
+  };
+
+  struct overflow
+  {
+    int i;
+  };
+
+  expected<int> divide(int i, int j)
+  {
+    if (i % j)
+      return make_unexpected(std::make_exception_ptr(not_divisible{ i, j }));
+    return i / j;
+  }
+
+  int twice(int i) { return 2 * i; }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(MonadException)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(MonadException_RecoveryChainDoesNotAllocate)
+{
+  using namespace boost::functional::monad_exception;
+  // Captures more than std::function keeps inline.
+  int a = 1, b = 2, c = 3, d = 4, x = 0, y = 0;
+  auto on_not_divisible = [a, b, c, d, x, y](not_divisible& e) -> expected<int>
+  {
+    return e.i / e.j + a + b + c + d + x + y;
+  };
+  auto on_overflow = [&a](overflow& e) -> expected<int> { return e.i + a; };
+
+  // The counter sees what a std::function would do.
+  allocations = 0;
+  {
+    std::function<expected<int>(not_divisible&)> f = on_not_divisible;
+    BOOST_CHECK(f);
+  }
+  BOOST_CHECK(allocations > 0);
+
+  expected<int> e = divide(7, 2);
+  expected<int> ok = divide(8, 2);
+  allocations = 0;
+  expected<int> r = std::move(e) || on_overflow || on_not_divisible;
+  expected<int> r2 = std::move(ok) || on_not_divisible || on_overflow;
+  BOOST_CHECK_EQUAL(allocations, 0u);
+  BOOST_CHECK_EQUAL(*r, 3 + 10);
+  BOOST_CHECK_EQUAL(*r2, 4);
+
+  // An exception not handled goes through.
+  expected<int> u = make_unexpected(std::make_exception_ptr(std::runtime_error("other")));
+  expected<int> r3 = std::move(u) || on_not_divisible;
+  BOOST_CHECK_THROW(r3.value(), std::runtime_error);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(MonadException_FunctionRef)
+{
+  int k = 3;
+  auto add = [&k](int i) { return i + k; };
+  allocations = 0;
+  function_ref<int(int)> f = add;
+  function_ref<int(int)> g = twice;
+  function_ref<long(int)> h = f;
+  BOOST_CHECK_EQUAL(f(1), 4);
+  BOOST_CHECK_EQUAL(g(1), 2);
+  BOOST_CHECK_EQUAL(h(2), 5);
+  k = 10;
+  BOOST_CHECK_EQUAL(f(1), 11);
+  BOOST_CHECK_EQUAL(allocations, 0u);
+  BOOST_CHECK_EQUAL(sizeof(f), 2 * sizeof(void*));
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(MonadException_InplaceFunction)
+{
+  std::shared_ptr<int> counter = std::make_shared<int>(0);
+  allocations = 0;
+  {
+    inplace_function<int(int)> f = [counter](int i) { return ++*counter + i; };
+    BOOST_CHECK(f);
+    BOOST_CHECK_EQUAL(f(10), 11);
+    BOOST_CHECK_EQUAL(counter.use_count(), 2);
+
+    inplace_function<int(int)> g = std::move(f);
+    BOOST_CHECK(! f);
+    BOOST_CHECK_EQUAL(g(10), 12);
+    BOOST_CHECK_EQUAL(counter.use_count(), 2);
+
+    f = [](int i) { return i; };
+    g = std::move(f);
+    BOOST_CHECK_EQUAL(counter.use_count(), 1);
+    BOOST_CHECK_EQUAL(g(5), 5);
+
+    BOOST_CHECK_EQUAL(allocations, 0u);
+
+    // Move-only callables.
+    struct owner
+    {
+      std::unique_ptr<int> p;
+      int operator()() const { return *p; }
+    };
+    owner o = { std::unique_ptr<int>(new int(7)) };
+    inplace_function<int()> m = std::move(o);
+    inplace_function<int()> m2 = std::move(m);
+    BOOST_CHECK_EQUAL(m2(), 7);
+  }
+  BOOST_CHECK((inplace_function<void(), 16>::fits<char[16]>::value));
+  BOOST_CHECK(! (inplace_function<void(), 16>::fits<char[17]>::value));
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(MonadException_CancellationCallbackDoesNotAllocate)
+{
+  cancellation_source source;
+  cancellation_token token = source.token();
+  int called = 0, other = 0;
+  allocations = 0;
+  {
+    cancellation_callback cb(token, [&called, &other] { ++called; ++other; });
+    source.request_cancellation();
+  }
+  BOOST_CHECK_EQUAL(allocations, 0u);
+  BOOST_CHECK_EQUAL(called, 1);
+
+  // A large one is still accepted.
+  char big[64] = { 1 };
+  cancellation_callback late(token, [big, &called] { called += big[0]; });
+  BOOST_CHECK_EQUAL(called, 2);
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,167 @@
+//! \file test_atomic_expected.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - atomic_expected"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/atomic_expected.hpp>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+
+namespace
+{
+  struct throw_on_zero
+  {
+    int v;
+    throw_on_zero(int x) : v(x)
+    {
+      if (x == 0)
+        throw std::runtime_error("zero");
+    }
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(AtomicExpected)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(AtomicExpected_SetValueOnce)
+{
+  atomic_expected<int, std::string> c;
+  BOOST_CHECK(! c.is_ready());
+  BOOST_CHECK(c.try_get() == 0);
+
+  BOOST_CHECK(c.set_value(3));
+  BOOST_CHECK(! c.set_value(4));
+  BOOST_CHECK(! c.set_error("late"));
+  BOOST_REQUIRE(c.is_ready());
+  BOOST_REQUIRE(c.try_get() != 0);
+  BOOST_CHECK_EQUAL(**c.try_get(), 3);
+  BOOST_CHECK_EQUAL(*c.wait(), 3);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(AtomicExpected_SetError)
+{
+  atomic_expected<int, std::string> c;
+  BOOST_CHECK(c.set_error("failed"));
+  BOOST_CHECK(! c.set(expected<int, std::string>(1)));
+  BOOST_REQUIRE(! c.wait().valid());
+  BOOST_CHECK_EQUAL(c.wait().error(), "failed");
+
+  atomic_expected<int, std::string> d;
+  BOOST_CHECK(d.set(expected<int, std::string>(make_unexpected(std::string("e")))));
+  BOOST_CHECK_EQUAL(d.try_get()->error(), "e");
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(AtomicExpected_ThrowingSetLeavesEmpty)
+{
+  atomic_expected<throw_on_zero, int> c;
+  BOOST_CHECK_THROW(c.set_value(0), std::runtime_error);
+  BOOST_CHECK(! c.is_ready());
+  BOOST_CHECK(c.set_value(2));
+  BOOST_CHECK_EQUAL(c.wait()->v, 2);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(AtomicExpected_DestroysResult)
+{
+  std::shared_ptr<int> p(new int(1));
+  {
+    atomic_expected<std::shared_ptr<int>, int> c;
+    c.set_value(p);
+    BOOST_CHECK_EQUAL(p.use_count(), 2);
+  }
+  BOOST_CHECK_EQUAL(p.use_count(), 1);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(AtomicExpected_WaitOtherThread)
+{
+  atomic_expected<std::unique_ptr<int>, std::string> c;
+  std::thread t([&c] { c.set_value(new int(5)); });
+  expected<std::unique_ptr<int>, std::string> const& r = c.wait();
+  t.join();
+
+  BOOST_REQUIRE(r.valid());
+  BOOST_CHECK_EQUAL(**r, 5);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(AtomicExpected_ConcurrentSetters)
+{
+  atomic_expected<int, int> c;
+  std::vector<char> won(4, 0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+    threads.push_back(std::thread([&c, &won, i] { won[i] = c.set_value(i); }));
+  for (std::size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+
+  int winners = 0;
+  for (int i = 0; i < 4; ++i)
+    if (won[i])
+    {
+      ++winners;
+      BOOST_CHECK_EQUAL(*c.wait(), i);
+    }
+  BOOST_CHECK_EQUAL(winners, 1);
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(AtomicExpectedArray)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(AtomicExpectedArray_Aligned)
+{
+  atomic_expected_array<char, char> a(5);
+  BOOST_CHECK_EQUAL(a.size(), 5u);
+  BOOST_CHECK_EQUAL(a.ready_count(), 0u);
+  for (std::size_t i = 0; i < a.size(); ++i)
+    BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(&a[i]) % 64, 0u);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(AtomicExpectedArray_ForkJoin)
+{
+  std::size_t const n = 16;
+  atomic_expected_array<int, std::string> results(n);
+
+  std::vector<std::thread> tasks;
+  for (std::size_t i = 0; i < n; ++i)
+    tasks.push_back(std::thread([&results, i]
+    {
+      if (i % 5 == 4)
+        results[i].set_error("task " + std::to_string(i));
+      else
+        results[i].set_value(int(i * i));
+    }));
+  results.wait_all();
+  BOOST_CHECK_EQUAL(results.ready_count(), n);
+
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    expected<int, std::string> const* r = results[i].try_get();
+    BOOST_REQUIRE(r != 0);
+    if (i % 5 == 4)
+      BOOST_CHECK_EQUAL(r->error(), "task " + std::to_string(i));
+    else
+      BOOST_CHECK_EQUAL(**r, int(i * i));
+  }
+  for (std::size_t i = 0; i < tasks.size(); ++i)
+    tasks[i].join();
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,206 @@
+//! \file test_cancellation.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - cancellation"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/expected_monad.hpp>
+#include <boost/expected/cancellation.hpp>
+#include <boost/functional/monads/adaptor.hpp>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+using namespace boost::functional;
+
+namespace
+{
+  bool is_cancelled(std::exception_ptr const& e)
+  {
+    try
+    {
+      std::rethrow_exception(e);
+    }
+    catch (operation_cancelled const&)
+    {
+      return true;
+    }
+    catch (...)
+    {
+      return false;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(Cancellation)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Cancellation_Token)
+{
+  cancellation_token never;
+  BOOST_CHECK(! never.can_be_cancelled());
+  BOOST_CHECK(! never.is_cancellation_requested());
+
+  cancellation_source source;
+  cancellation_token token = source.token();
+  BOOST_CHECK(token.can_be_cancelled());
+  BOOST_CHECK(! token.is_cancellation_requested());
+  BOOST_CHECK(source.request_cancellation());
+  BOOST_CHECK(! source.request_cancellation());
+  BOOST_CHECK(token.is_cancellation_requested());
+  BOOST_CHECK(source.token().is_cancellation_requested());
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Cancellation_ErrorTraits)
+{
+  BOOST_CHECK(is_cancelled(make_unexpected_cancelled<std::exception_ptr>().value()));
+  BOOST_CHECK(make_unexpected_cancelled<std::error_code>().value() == std::errc::operation_canceled);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Cancellation_Callback)
+{
+  cancellation_source source;
+  int called = 0;
+  int removed = 0;
+  {
+    cancellation_callback cb(source.token(), [&called] { ++called; });
+    {
+      cancellation_callback gone(source.token(), [&removed] { ++removed; });
+    }
+    BOOST_CHECK_EQUAL(called, 0);
+    source.request_cancellation();
+    BOOST_CHECK_EQUAL(called, 1);
+    source.request_cancellation();
+    BOOST_CHECK_EQUAL(called, 1);
+  }
+  BOOST_CHECK_EQUAL(removed, 0);
+
+  // already requested: called at once
+  cancellation_callback late(source.token(), [&called] { ++called; });
+  BOOST_CHECK_EQUAL(called, 2);
+
+  // never cancelled: never called
+  cancellation_callback none(cancellation_token(), [&called] { ++called; });
+  BOOST_CHECK_EQUAL(called, 2);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Cancellation_CallbackDestroyingItself)
+{
+  cancellation_source source;
+  std::unique_ptr<cancellation_callback> cb;
+  int called = 0;
+  cb.reset(new cancellation_callback(source.token(), [&cb, &called]
+  {
+    ++called;
+    cb.reset();
+  }));
+  cancellation_callback other(source.token(), [&called] { ++called; });
+  source.request_cancellation();
+  BOOST_CHECK(! cb);
+  BOOST_CHECK_EQUAL(called, 2);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Cancellation_AbortsBlockingWait)
+{
+  cancellation_source source;
+  std::mutex m;
+  std::condition_variable cv;
+  bool woken = false;
+
+  std::thread waiter([&]
+  {
+    cancellation_token token = source.token();
+    cancellation_callback cb(token, [&]
+    {
+      std::lock_guard<std::mutex> lock(m);
+      cv.notify_all();
+    });
+    std::unique_lock<std::mutex> lock(m);
+    while (! token.is_cancellation_requested())
+      cv.wait(lock);
+    woken = true;
+  });
+  source.request_cancellation();
+  waiter.join();
+  BOOST_CHECK(woken);
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(Cancellable)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Cancellable_Map)
+{
+  cancellation_source source;
+  auto add_five = [](int i) { return i + 5; };
+
+  expected<int> e = expected<int>(1).then(cancellable(add_five, source.token()));
+  BOOST_REQUIRE(e.valid());
+  BOOST_CHECK_EQUAL(*e, 6);
+
+  source.request_cancellation();
+  e = expected<int>(1).then(cancellable(add_five, source.token())).then(if_valued(add_five));
+  BOOST_REQUIRE(! e.valid());
+  BOOST_CHECK(is_cancelled(e.error()));
+  BOOST_CHECK_THROW(e.value(), operation_cancelled);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Cancellable_PropagatesErrors)
+{
+  cancellation_source source;
+  int calls = 0;
+  auto count = [&calls](int i) { ++calls; return i; };
+
+  expected<int, std::error_code> e = make_unexpected(std::make_error_code(std::errc::invalid_argument));
+  expected<int, std::error_code> r = e.then(cancellable(count, source.token()));
+  BOOST_CHECK(r.error() == std::errc::invalid_argument);
+
+  source.request_cancellation();
+  r = expected<int, std::error_code>(1).then(cancellable(count, source.token()));
+  BOOST_CHECK(r.error() == std::errc::operation_canceled);
+  BOOST_CHECK_EQUAL(calls, 0);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Cancellable_Bind)
+{
+  cancellation_source source;
+  auto half = [](int i) -> expected<int, std::error_code>
+  {
+    if (i % 2)
+      return make_unexpected(std::make_error_code(std::errc::invalid_argument));
+    return i / 2;
+  };
+
+  expected<int, std::error_code> r = expected<int, std::error_code>(8)
+      .then(cancellable(half, source.token()))
+      .then(cancellable(half, source.token()));
+  BOOST_CHECK_EQUAL(*r, 2);
+
+  r = expected<int, std::error_code>(6)
+      .then(cancellable(half, source.token()))
+      .then(cancellable(half, source.token()));
+  BOOST_CHECK(r.error() == std::errc::invalid_argument);
+
+  int seen = 0;
+  expected<void, std::error_code> v = expected<int, std::error_code>(3)
+      .then(cancellable([&seen](int i) { seen = i; }, source.token()));
+  BOOST_CHECK(v.valid());
+  BOOST_CHECK_EQUAL(seen, 3);
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,233 @@
+//! \file test_circuit_breaker.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - circuit_breaker"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/circuit_breaker.hpp>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+
+namespace
+{
+  // A clock moved by hand.
+  struct manual_clock
+  {
+    typedef std::chrono::milliseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<manual_clock> time_point;
+    static const bool is_steady = true;
+
+    static time_point now() { return time_point(duration(ticks.load())); }
+    static void advance(std::chrono::milliseconds d) { ticks += d.count(); }
+
+    static std::atomic<rep> ticks;
+  };
+  std::atomic<manual_clock::rep> manual_clock::ticks(0);
+
+  typedef expected<int, std::error_code> result;
+  typedef circuit_breaker<manual_clock> breaker;
+
+  int calls = 0;
+
+  result ok()
+  {
+    ++calls;
+    return 1;
+  }
+
+  result fail()
+  {
+    ++calls;
+    return make_unexpected(std::make_error_code(std::errc::timed_out));
+  }
+
+  circuit_breaker_options options()
+  {
+    circuit_breaker_options o;
+    o.failure_ratio = 0.5;
+    o.minimum_calls = 10;
+    o.window = std::chrono::seconds(10);
+    o.buckets = 10;
+    o.open_duration = std::chrono::seconds(5);
+    o.probes = 2;
+    return o;
+  }
+
+  void trip(breaker& b)
+  {
+    for (int i = 0; i < 10 && b.state() == circuit_state::closed; ++i)
+      b.call(fail);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(CircuitBreaker)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(CircuitBreaker_Closed)
+{
+  breaker b(options());
+  BOOST_CHECK(b.state() == circuit_state::closed);
+  BOOST_CHECK_EQUAL(*b.call(ok), 1);
+  BOOST_CHECK(b.call(fail).error() == std::errc::timed_out);
+  circuit_counts c = b.counts();
+  BOOST_CHECK_EQUAL(c.calls, 2u);
+  BOOST_CHECK_EQUAL(c.errors, 1u);
+  BOOST_CHECK(b.state() == circuit_state::closed);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(CircuitBreaker_Opens)
+{
+  breaker b(options());
+  for (int i = 0; i < 5; ++i)
+    b.call(ok);
+  for (int i = 0; i < 4; ++i)
+    b.call(fail);
+  BOOST_CHECK(b.state() == circuit_state::closed);
+  b.call(fail);
+  BOOST_CHECK(b.state() == circuit_state::open);
+
+  calls = 0;
+  result r = b.call(ok);
+  BOOST_CHECK_EQUAL(calls, 0);
+  BOOST_CHECK(r.error() == circuit_errc::open);
+  BOOST_CHECK_EQUAL(b.rejected(), 1u);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(CircuitBreaker_MinimumCalls)
+{
+  breaker b(options());
+  for (int i = 0; i < 9; ++i)
+    b.call(fail);
+  BOOST_CHECK(b.state() == circuit_state::closed);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(CircuitBreaker_WindowSlides)
+{
+  breaker b(options());
+  for (int i = 0; i < 9; ++i)
+    b.call(fail);
+  // the 9 errors fall out of the window
+  manual_clock::advance(std::chrono::seconds(11));
+  b.call(fail);
+  BOOST_CHECK_EQUAL(b.counts().calls, 1u);
+  for (int i = 0; i < 8; ++i)
+    b.call(ok);
+  b.call(fail);
+  BOOST_CHECK(b.state() == circuit_state::closed);
+
+  // half of the window later, the first half is still counted
+  manual_clock::advance(std::chrono::seconds(5));
+  b.call(fail);
+  BOOST_CHECK_EQUAL(b.counts().calls, 11u);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(CircuitBreaker_HalfOpenCloses)
+{
+  breaker b(options());
+  trip(b);
+  BOOST_REQUIRE(b.state() == circuit_state::open);
+  manual_clock::advance(std::chrono::seconds(4));
+  BOOST_CHECK(b.call(ok).error() == circuit_errc::open);
+
+  manual_clock::advance(std::chrono::seconds(2));
+  calls = 0;
+  BOOST_CHECK(b.call(ok).valid());
+  BOOST_CHECK(b.state() == circuit_state::half_open);
+  BOOST_CHECK(b.call(ok).valid());
+  BOOST_CHECK_EQUAL(calls, 2);
+  BOOST_CHECK(b.state() == circuit_state::closed);
+  BOOST_CHECK_EQUAL(b.counts().calls, 0u);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(CircuitBreaker_HalfOpenLimitsProbes)
+{
+  circuit_breaker_options o = options();
+  o.probes = 1;
+  breaker b(o);
+  trip(b);
+  manual_clock::advance(std::chrono::seconds(6));
+
+  // the probe is in flight while the nested call is made
+  result nested;
+  b.call([&]
+  {
+    nested = b.call(ok);
+    return ok();
+  });
+  BOOST_CHECK(nested.error() == circuit_errc::open);
+  BOOST_CHECK(b.state() == circuit_state::closed);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(CircuitBreaker_HalfOpenReopens)
+{
+  breaker b(options());
+  trip(b);
+  manual_clock::advance(std::chrono::seconds(6));
+  BOOST_CHECK(b.call(fail).error() == std::errc::timed_out);
+  BOOST_CHECK(b.state() == circuit_state::open);
+  BOOST_CHECK(b.call(ok).error() == circuit_errc::open);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(CircuitBreaker_Exceptions)
+{
+  circuit_breaker_options o = options();
+  o.minimum_calls = 1;
+  circuit_breaker<manual_clock> b(o);
+  BOOST_CHECK_THROW(b.call([]() -> expected<int> { throw std::runtime_error("down"); }), std::runtime_error);
+  BOOST_CHECK(b.state() == circuit_state::open);
+
+  expected<int> r = b.call([]() -> expected<int> { return 1; });
+  BOOST_CHECK_THROW(r.value(), circuit_open);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(CircuitBreaker_Concurrent)
+{
+  circuit_breaker_options o = options();
+  o.minimum_calls = 100;
+  breaker b(o);
+  std::atomic<int> open(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+    threads.push_back(std::thread([&b, &open]
+    {
+      for (int i = 0; i < 10000; ++i)
+      {
+        result r = b.call([i]() -> result
+        {
+          if (i % 8 == 0)
+            return make_unexpected(std::make_error_code(std::errc::timed_out));
+          return i;
+        });
+        if (! r.valid() && r.error() == circuit_errc::open)
+          ++open;
+      }
+    }));
+  for (std::size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+  // one error in 8 calls: never open
+  BOOST_CHECK_EQUAL(open.load(), 0);
+  BOOST_CHECK_EQUAL(b.counts().calls, 40000u);
+  BOOST_CHECK_EQUAL(b.counts().errors, 5000u);
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,114 @@
+//! \file test_constexpr.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - constexpr"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected_monad.hpp>
+#include <boost/functional/detail/index_sequence.hpp>
+#include <cstddef>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+
+namespace
+{
+  enum class parse_error { empty, not_a_digit, too_large };
+
+  typedef expected<int, parse_error> parsed;
+
+  constexpr parsed digit(char c)
+  {
+    return c == '\0' ? parsed(make_unexpected(parse_error::empty))
+      : c < '0' || c > '9' ? parsed(make_unexpected(parse_error::not_a_digit))
+      : parsed(c - '0');
+  }
+
+  constexpr int twice(int i) { return 2 * i; }
+  constexpr parsed small(int i)
+  {
+    return i < 10 ? parsed(i) : parsed(make_unexpected(parse_error::too_large));
+  }
+  constexpr int recover(parse_error) { return -1; }
+  constexpr parsed clamp(parse_error e)
+  {
+    return e == parse_error::too_large ? parsed(9) : parsed(make_unexpected(e));
+  }
+  constexpr parsed keep(parsed e) { return e; }
+  constexpr int seven() { return 7; }
+
+  BOOST_EXPECTED_CXX14_CONSTEXPR parsed entry(char c)
+  {
+    return digit(c).map(twice).bind(small).catch_error(clamp);
+  }
+
+#if ! defined BOOST_NO_CXX14_CONSTEXPR && ! defined BOOST_EXPECTED_NO_CXX11_RVALUE_REFERENCE_FOR_THIS
+  // A parse table built by the compiler.
+  struct digit_table
+  {
+    parsed entries[128];
+  };
+
+  template <std::size_t ...I>
+  constexpr digit_table make_digit_table(functional::detail::index_sequence<I...>)
+  {
+    return digit_table{ { entry(char(I))... } };
+  }
+
+  constexpr digit_table table = make_digit_table(functional::detail::make_index_sequence<128>());
+
+  // Combinators.
+  static_assert(*parsed(3).map(twice) == 6, "");
+  static_assert(parsed(3).bind(small).value() == 3, "");
+  static_assert(parsed(30).bind(small).error() == parse_error::too_large, "");
+  static_assert(parsed(make_unexpected(parse_error::empty)).map(twice).error() == parse_error::empty, "");
+  static_assert(*parsed(make_unexpected(parse_error::empty)).catch_error(recover) == -1, "");
+  static_assert(*parsed(4).then(keep) == 4, "");
+  static_assert(parsed(make_unexpected(parse_error::empty)).value_or(9) == 9, "");
+  static_assert(expected<parsed, parse_error>(parsed(5)).unwrap() == 5, "");
+  static_assert(*expected<void, parse_error>(in_place2).map(seven) == 7, "");
+
+  // Relational operators.
+  static_assert(parsed(1) == parsed(1), "");
+  static_assert(parsed(1) < parsed(2), "");
+  static_assert(parsed(1) != make_unexpected(parse_error::empty), "");
+
+  // The monad interface.
+  static_assert(*functional::functor::map(twice, parsed(4)) == 8, "");
+  static_assert(*functional::monad::bind(parsed(4), small) == 4, "");
+
+  // The table.
+  static_assert(*table.entries['4'] == 8, "");
+  static_assert(*table.entries['7'] == 9, "");
+  static_assert(table.entries['x'].error() == parse_error::not_a_digit, "");
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(Constexpr)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Constexpr_TableMatchesRuntime)
+{
+#if ! defined BOOST_NO_CXX14_CONSTEXPR && ! defined BOOST_EXPECTED_NO_CXX11_RVALUE_REFERENCE_FOR_THIS
+  for (int c = 0; c < 128; ++c)
+  {
+    parsed r = entry(char(c));
+    BOOST_CHECK(r == table.entries[c]);
+  }
+#endif
+  BOOST_CHECK_EQUAL(*entry('4'), 8);
+  BOOST_CHECK_EQUAL(*entry('7'), 9);
+  BOOST_CHECK(entry('x').error() == parse_error::not_a_digit);
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,211 @@
+//! \file test_coroutine.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - coroutine"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/coroutine.hpp>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+
+#if defined BOOST_EXPECTED_HAS_COROUTINES
+
+namespace
+{
+  int live = 0;
+
+  struct counted
+  {
+    int value;
+    explicit counted(int v) : value(v) { ++live; }
+    counted(counted const& x) : value(x.value) { ++live; }
+    ~counted() { --live; }
+  };
+
+  int steps = 0;
+
+  expected<int, std::string> number(int v)
+  {
+    if (v < 0)
+      return make_unexpected(std::string("negative"));
+    return v;
+  }
+
+  expected<int, std::string> add(int a, int b)
+  {
+    int x = co_await number(a);
+    ++steps;
+    int y = co_await number(b);
+    ++steps;
+    co_return x + y;
+  }
+
+  expected<counted, std::string> add_counted(int a, int b)
+  {
+    counted x = co_await expected<counted, std::string>(counted(a));
+    int y = co_await number(b);
+    co_return counted(x.value + y);
+  }
+
+  expected<void, std::string> check(int v)
+  {
+    co_await number(v);
+    if (v == 0)
+      co_await make_unexpected(std::string("zero"));
+    ++steps;
+  }
+
+  expected<int, std::string> after_check(int v)
+  {
+    co_await check(v);
+    co_return v;
+  }
+
+  expected<long, long> widen(expected<int, int> x)
+  {
+    co_return co_await x;
+  }
+
+  expected<std::unique_ptr<int>, int> take(expected<std::unique_ptr<int>, int> x)
+  {
+    std::unique_ptr<int> p = co_await std::move(x);
+    co_return std::move(p);
+  }
+
+  expected<int, int> peek(expected<std::unique_ptr<int>, int>& x)
+  {
+    std::unique_ptr<int>& p = co_await x;
+    co_return *p;
+  }
+
+  expected<int, int> throws()
+  {
+    co_await expected<int, int>(1);
+    throw std::runtime_error("throws");
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(Coroutine)
+
+BOOST_AUTO_TEST_CASE(Coroutine_Value)
+{
+  steps = 0;
+  expected<int, std::string> r = add(1, 2);
+
+  BOOST_REQUIRE(r.valid());
+  BOOST_CHECK_EQUAL(*r, 3);
+  BOOST_CHECK_EQUAL(steps, 2);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Coroutine_ErrorReturnsEarly)
+{
+  steps = 0;
+  expected<int, std::string> r = add(1, -2);
+
+  BOOST_REQUIRE(! r.valid());
+  BOOST_CHECK_EQUAL(r.error(), "negative");
+  BOOST_CHECK_EQUAL(steps, 1);
+
+  steps = 0;
+  r = add(-1, 2);
+  BOOST_REQUIRE(! r.valid());
+  BOOST_CHECK_EQUAL(steps, 0);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Coroutine_ErrorDestroysLocals)
+{
+  live = 0;
+  {
+    expected<counted, std::string> e = add_counted(1, -1);
+    BOOST_CHECK(! e.valid());
+    BOOST_CHECK_EQUAL(live, 0);
+
+    expected<counted, std::string> r = add_counted(1, 2);
+    BOOST_REQUIRE(r.valid());
+    BOOST_CHECK_EQUAL(r->value, 3);
+    BOOST_CHECK_EQUAL(live, 1);
+  }
+  BOOST_CHECK_EQUAL(live, 0);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Coroutine_Void)
+{
+  steps = 0;
+  BOOST_CHECK(check(1).valid());
+  BOOST_CHECK_EQUAL(steps, 1);
+
+  expected<void, std::string> r = check(0);
+  BOOST_REQUIRE(! r.valid());
+  BOOST_CHECK_EQUAL(r.error(), "zero");
+  BOOST_CHECK_EQUAL(steps, 1);
+
+  expected<int, std::string> x = after_check(-1);
+  BOOST_REQUIRE(! x.valid());
+  BOOST_CHECK_EQUAL(x.error(), "negative");
+  BOOST_CHECK_EQUAL(*after_check(2), 2);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Coroutine_ConvertsError)
+{
+  expected<long, long> r = widen(make_unexpected(5));
+  BOOST_REQUIRE(! r.valid());
+  BOOST_CHECK_EQUAL(r.error(), 5L);
+  BOOST_CHECK_EQUAL(*widen(4), 4L);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Coroutine_RvalueAndLvalue)
+{
+  expected<std::unique_ptr<int>, int> r = take(std::unique_ptr<int>(new int(7)));
+  BOOST_REQUIRE(r.valid());
+  BOOST_CHECK_EQUAL(**r, 7);
+
+  // co_await on an lvalue does not move from it
+  BOOST_CHECK_EQUAL(*peek(r), 7);
+  BOOST_REQUIRE(*r);
+  BOOST_CHECK_EQUAL(**r, 7);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Coroutine_ExceptionPropagates)
+{
+  BOOST_CHECK_THROW(throws(), std::runtime_error);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Coroutine_EagerReturnObjectConversion)
+{
+  // What a compiler converting the return object before running the
+  // coroutine does.
+  expected_detail::coroutine_promise<int, int> p;
+  expected<int, int> r = p.get_return_object();
+  p.return_value(make_unexpected(3));
+
+  BOOST_REQUIRE(! r.valid());
+  BOOST_CHECK_EQUAL(r.error(), 3);
+  p.return_value(4);
+  BOOST_CHECK_EQUAL(*r, 4);
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#else
+
+BOOST_AUTO_TEST_CASE(Coroutine_NotSupported)
+{
+}
+
+#endif
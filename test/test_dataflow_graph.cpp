@@ -0,0 +1,204 @@
+//! \file test_dataflow_graph.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - dataflow graph"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/dataflow_graph.hpp>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+
+namespace
+{
+  typedef dataflow_graph<int, std::error_code> graph;
+  typedef graph::arguments args;
+
+  int sum(args const& a)
+  {
+    int s = 0;
+    for (std::size_t i = 0; i < a.size(); ++i)
+      s += a[i];
+    return s;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(DataflowGraph)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(DataflowGraph_RecomputesTheDirtyCone)
+{
+  graph g;
+  graph::node_id a = g.add_input(1), b = g.add_input(2), c = g.add_input(3);
+  int calls = 0;
+  graph::node_id s = g.add_node({ a, b }, [&calls](args const& x) { ++calls; return sum(x); });
+  graph::node_id t = g.add_node({ s, b }, [&calls](args const& x) { ++calls; return x[0] * x[1]; });
+  graph::node_id u = g.add_node({ c }, [&calls](args const& x) { ++calls; return x[0] + 1; });
+  BOOST_CHECK_EQUAL(*g.get(s), 3);
+  BOOST_CHECK_EQUAL(*g.get(t), 6);
+  BOOST_CHECK_EQUAL(*g.get(u), 4);
+  BOOST_CHECK_EQUAL(calls, 3);
+
+  g.set(a, 10);
+  BOOST_CHECK(g.is_dirty(s));
+  BOOST_CHECK(! g.is_dirty(u));
+  dataflow_stats st = g.recompute();
+  BOOST_CHECK_EQUAL(st.computed, 2u);
+  BOOST_CHECK_EQUAL(st.changed, 2u);
+  BOOST_CHECK_EQUAL(*g.get(t), 24);
+  BOOST_CHECK_EQUAL(calls, 5);
+  BOOST_CHECK(! g.is_dirty(s));
+
+  // t depends on b directly and through s: it is computed once.
+  g.set(b, 1);
+  st = g.recompute();
+  BOOST_CHECK_EQUAL(st.computed, 2u);
+  BOOST_CHECK_EQUAL(*g.get(t), 11);
+
+  // Nothing to do.
+  g.set(b, 1);
+  BOOST_CHECK_EQUAL(g.recompute().computed, 0u);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(DataflowGraph_ErrorsPropagate)
+{
+  graph g;
+  graph::node_id a = g.add_input(4);
+  int calls = 0;
+  graph::node_id half = g.add_node({ a }, [&calls](args const& x) -> expected<int, std::error_code>
+  {
+    ++calls;
+    if (x[0] % 2)
+      return make_unexpected(std::make_error_code(std::errc::invalid_argument));
+    return x[0] / 2;
+  });
+  graph::node_id next = g.add_node({ half }, [&calls](args const& x) { ++calls; return x[0] + 1; });
+  graph::node_id last = g.add_node({ next, a }, [&calls](args const& x) { ++calls; return sum(x); });
+  BOOST_CHECK_EQUAL(*g.get(last), 7);
+  calls = 0;
+
+  g.set(a, 5);
+  dataflow_stats st = g.recompute();
+  BOOST_CHECK_EQUAL(calls, 1);
+  BOOST_CHECK_EQUAL(st.computed, 1u);
+  BOOST_CHECK_EQUAL(st.propagated, 2u);
+  BOOST_CHECK(g.get(last).error() == std::errc::invalid_argument);
+
+  // An input in error: the nodes take its error.
+  g.set(a, make_unexpected(std::make_error_code(std::errc::timed_out)));
+  st = g.recompute();
+  BOOST_CHECK_EQUAL(calls, 1);
+  BOOST_CHECK_EQUAL(st.propagated, 3u);
+  BOOST_CHECK(g.get(next).error() == std::errc::timed_out);
+
+  g.set(a, 8);
+  g.recompute();
+  BOOST_CHECK_EQUAL(*g.get(last), 13);
+
+  // An exception becomes the error.
+  dataflow_graph<int> h;
+  dataflow_graph<int>::node_id i = h.add_input(0);
+  dataflow_graph<int>::node_id j = h.add_node({ i }, [](dataflow_graph<int>::arguments const& x) -> int
+  {
+    if (x[0] == 0)
+      throw std::domain_error("zero");
+    return 10 / x[0];
+  });
+  BOOST_CHECK_THROW(h.get(j).value(), std::domain_error);
+  h.set(i, 5);
+  h.recompute();
+  BOOST_CHECK_EQUAL(h.get(j).value(), 2);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(DataflowGraph_UnchangedOutcomeStops)
+{
+  graph g;
+  graph::node_id a = g.add_input(2);
+  int calls = 0;
+  graph::node_id parity = g.add_node({ a }, [](args const& x) { return x[0] % 2; });
+  graph::node_id d = g.add_node({ parity }, [&calls](args const& x) { ++calls; return x[0] * 100; });
+  calls = 0;
+
+  g.set(a, 4);
+  dataflow_stats st = g.recompute();
+  BOOST_CHECK_EQUAL(st.computed, 1u);
+  BOOST_CHECK_EQUAL(st.changed, 0u);
+  BOOST_CHECK_EQUAL(calls, 0);
+
+  g.set(a, 5);
+  g.recompute();
+  BOOST_CHECK_EQUAL(*g.get(d), 100);
+  BOOST_CHECK_EQUAL(calls, 1);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(DataflowGraph_AddedWhileDirty)
+{
+  graph g;
+  graph::node_id a = g.add_input(1);
+  graph::node_id b = g.add_node({ a }, [](args const& x) { return x[0] * 2; });
+  g.set(a, 5);
+  // Computed from the stale b, then again by recompute.
+  graph::node_id c = g.add_node({ b }, [](args const& x) { return x[0] + 1; });
+  BOOST_CHECK_EQUAL(*g.get(c), 3);
+  BOOST_CHECK(g.is_dirty(c));
+  g.recompute();
+  BOOST_CHECK_EQUAL(*g.get(c), 11);
+
+  BOOST_CHECK_THROW(g.add_node({ 42 }, sum), std::out_of_range);
+  BOOST_CHECK_THROW(g.set(b, 1), std::invalid_argument);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(DataflowGraph_Parallel)
+{
+  // Layers of 64 nodes, each reading 3 nodes of the layer before.
+  std::size_t const width = 64, depth = 8;
+  graph seq, par;
+  std::vector<graph::node_id> layer;
+  for (std::size_t i = 0; i < width; ++i)
+  {
+    layer.push_back(seq.add_input(int(i)));
+    par.add_input(int(i));
+  }
+  for (std::size_t l = 1; l < depth; ++l)
+  {
+    std::vector<graph::node_id> next;
+    for (std::size_t i = 0; i < width; ++i)
+    {
+      std::vector<graph::node_id> deps = { layer[i], layer[(i + 1) % width], layer[(i + 7) % width] };
+      next.push_back(seq.add_node(deps, [](args const& x) { return (sum(x) * 7 + 1) % 1009; }));
+      par.add_node(deps, [](args const& x) { return (sum(x) * 7 + 1) % 1009; });
+    }
+    layer = next;
+  }
+
+  work_stealing_pool pool(2);
+  for (int round = 0; round < 4; ++round)
+  {
+    for (std::size_t i = 0; i < width; i += 3)
+    {
+      seq.set(i, int(i) + round);
+      par.set(i, int(i) + round);
+    }
+    dataflow_stats s = seq.recompute();
+    dataflow_stats p = par.recompute(pool, 4);
+    BOOST_CHECK_EQUAL(s.computed, p.computed);
+    BOOST_CHECK_EQUAL(s.changed, p.changed);
+    for (std::size_t i = 0; i < seq.size(); ++i)
+      BOOST_CHECK_EQUAL(*seq.get(i), *par.get(i));
+  }
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
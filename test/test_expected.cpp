@@ -677,6 +677,42 @@ BOOST_AUTO_TEST_CASE(expected_swap_exception)
   BOOST_CHECK_EXCEPTION(e2.value(), std::invalid_argument, equal_to_e2);
 }
 
+struct live_counted
+{
+  static int live;
+  live_counted() { ++live; }
+  live_counted(const live_counted&) { ++live; }
+  ~live_counted() { --live; }
+};
+int live_counted::live = 0;
+
+BOOST_AUTO_TEST_CASE(expected_swap_value_and_error)
+{
+  live_counted::live = 0;
+  {
+    expected<live_counted, live_counted> e{live_counted()};
+    expected<live_counted, live_counted> e2 = make_unexpected(live_counted());
+    BOOST_CHECK_EQUAL(live_counted::live, 2);
+
+    e.swap(e2);
+    BOOST_CHECK(! e.valid());
+    BOOST_CHECK(e2.valid());
+    BOOST_CHECK_EQUAL(live_counted::live, 2);
+
+    e = e2;
+    BOOST_CHECK(e.valid());
+    BOOST_CHECK_EQUAL(live_counted::live, 2);
+
+    expected<void, live_counted> v(in_place2);
+    expected<void, live_counted> v2 = make_unexpected(live_counted());
+    v.swap(v2);
+    BOOST_CHECK(! v.valid());
+    BOOST_CHECK(v2.valid());
+    BOOST_CHECK_EQUAL(live_counted::live, 3);
+  }
+  BOOST_CHECK_EQUAL(live_counted::live, 0);
+}
+
 BOOST_AUTO_TEST_CASE(expected_swap_function_value)
 {
   // From value constructor.
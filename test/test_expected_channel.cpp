@@ -0,0 +1,295 @@
+//! \file test_expected_channel.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - channel"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/expected_channel.hpp>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+
+namespace
+{
+  template <class Channel>
+  void fifo_and_bounds()
+  {
+    typedef typename Channel::value_type E;
+    Channel ch(3);
+    BOOST_CHECK_EQUAL(ch.capacity(), 4u);
+
+    E out;
+    BOOST_CHECK(ch.try_pop(out) == channel_op_status::empty);
+    for (int i = 0; i < 4; ++i)
+      BOOST_CHECK(ch.try_push(i) == channel_op_status::success);
+    BOOST_CHECK(ch.try_push(4) == channel_op_status::full);
+
+    // a few laps of the ring
+    for (int i = 0; i < 20; ++i)
+    {
+      BOOST_REQUIRE(ch.try_pop(out) == channel_op_status::success);
+      BOOST_CHECK_EQUAL(*out, i);
+      BOOST_CHECK(ch.try_push(i + 4) == channel_op_status::success);
+    }
+  }
+
+  template <class Channel>
+  void error_closes()
+  {
+    typedef typename Channel::value_type E;
+    Channel ch(8);
+    BOOST_CHECK(ch.try_push(1) == channel_op_status::success);
+    BOOST_CHECK(ch.try_push(make_unexpected(std::string("done"))) == channel_op_status::success);
+    BOOST_CHECK(ch.try_push(2) == channel_op_status::closed);
+    BOOST_CHECK(ch.try_push(make_unexpected(std::string("again"))) == channel_op_status::closed);
+
+    E out;
+    BOOST_REQUIRE(ch.try_pop(out) == channel_op_status::success);
+    BOOST_CHECK_EQUAL(*out, 1);
+    for (int i = 0; i < 2; ++i)
+    {
+      BOOST_REQUIRE(ch.try_pop(out) == channel_op_status::closed);
+      BOOST_REQUIRE(! out.valid());
+      BOOST_CHECK_EQUAL(out.error(), "done");
+      BOOST_CHECK(ch.pop(out) == channel_op_status::closed);
+    }
+  }
+
+  template <class Channel>
+  void batches()
+  {
+    typedef typename Channel::value_type E;
+    Channel ch(8);
+    std::vector<E> in;
+    for (int i = 0; i < 6; ++i)
+      in.push_back(i);
+    in.push_back(make_unexpected(std::string("end")));
+    in.push_back(100);
+
+    BOOST_CHECK_EQUAL(ch.try_push_n(in.begin(), 4), 4u);
+    std::vector<E> out;
+    BOOST_CHECK_EQUAL(ch.try_pop_n(std::back_inserter(out), 3), 3u);
+    // stops after the error
+    BOOST_CHECK_EQUAL(ch.try_push_n(in.begin() + 4, 4), 3u);
+    BOOST_CHECK_EQUAL(ch.try_push_n(in.begin(), 1), 0u);
+
+    // stops before the error
+    BOOST_CHECK_EQUAL(ch.try_pop_n(std::back_inserter(out), 8), 3u);
+    BOOST_CHECK_EQUAL(ch.try_pop_n(std::back_inserter(out), 8), 0u);
+    BOOST_REQUIRE_EQUAL(out.size(), 6u);
+    for (int i = 0; i < 6; ++i)
+      BOOST_CHECK_EQUAL(*out[i], i);
+    E e;
+    BOOST_CHECK(ch.try_pop(e) == channel_op_status::closed);
+    BOOST_CHECK_EQUAL(e.error(), "end");
+  }
+
+  template <class Channel>
+  void destroys_elements()
+  {
+    std::shared_ptr<int> p(new int(1));
+    {
+      Channel ch(4);
+      ch.try_push(p);
+      ch.try_push(p);
+      typename Channel::value_type out;
+      ch.try_pop(out);
+      BOOST_CHECK_EQUAL(p.use_count(), 3);
+    }
+    BOOST_CHECK_EQUAL(p.use_count(), 1);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(SpscChannel)
+
+typedef spsc_expected_channel<int, std::string> spsc;
+
+BOOST_AUTO_TEST_CASE(Spsc_FifoAndBounds)
+{
+  fifo_and_bounds<spsc>();
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Spsc_ErrorCloses)
+{
+  error_closes<spsc>();
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Spsc_Batches)
+{
+  batches<spsc>();
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Spsc_DestroysElements)
+{
+  destroys_elements<spsc_expected_channel<std::shared_ptr<int>, int>>();
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Spsc_Threads)
+{
+  int const n = 100000;
+  spsc ch(64);
+  std::thread producer([&]
+  {
+    for (int i = 0; i < n; ++i)
+      ch.push(i);
+    ch.push(make_unexpected(std::string("done")));
+  });
+
+  long sum = 0;
+  int count = 0;
+  bool ordered = true;
+  spsc::value_type x;
+  while (ch.pop(x) == channel_op_status::success)
+  {
+    ordered = ordered && *x == count;
+    sum += *x;
+    ++count;
+  }
+  producer.join();
+
+  BOOST_CHECK(ordered);
+  BOOST_CHECK_EQUAL(count, n);
+  BOOST_CHECK_EQUAL(sum, long(n) * (n - 1) / 2);
+  BOOST_CHECK_EQUAL(x.error(), "done");
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(MpmcChannel)
+
+typedef mpmc_expected_channel<int, std::string> mpmc;
+
+BOOST_AUTO_TEST_CASE(Mpmc_FifoAndBounds)
+{
+  fifo_and_bounds<mpmc>();
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Mpmc_ErrorCloses)
+{
+  error_closes<mpmc>();
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Mpmc_Batches)
+{
+  batches<mpmc>();
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Mpmc_NothrowBatches)
+{
+  mpmc_expected_channel<int, int> ch(8);
+  std::vector<int> in(10, 7);
+  BOOST_CHECK_EQUAL(ch.try_push_n(in.begin(), in.size()), 8u);
+  std::vector<expected<int, int>> out;
+  BOOST_CHECK_EQUAL(ch.try_pop_n(std::back_inserter(out), 5), 5u);
+  BOOST_CHECK_EQUAL(ch.try_push_n(in.begin(), in.size()), 5u);
+  BOOST_CHECK_EQUAL(ch.try_pop_n(std::back_inserter(out), 20), 8u);
+  BOOST_CHECK_EQUAL(out.size(), 13u);
+
+  std::vector<expected<int, int>> last;
+  last.push_back(1);
+  last.push_back(make_unexpected(2));
+  last.push_back(3);
+  BOOST_CHECK_EQUAL(ch.try_push_n(last.begin(), last.size()), 2u);
+  BOOST_CHECK_EQUAL(ch.try_pop_n(std::back_inserter(out), 20), 1u);
+  expected<int, int> e;
+  BOOST_CHECK(ch.try_pop(e) == channel_op_status::closed);
+  BOOST_CHECK_EQUAL(e.error(), 2);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Mpmc_DestroysElements)
+{
+  destroys_elements<mpmc_expected_channel<std::shared_ptr<int>, int>>();
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Mpmc_Threads)
+{
+  int const producers = 3;
+  int const consumers = 3;
+  int const n = 20000;
+  mpmc ch(16);
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p)
+    threads.push_back(std::thread([&ch, p]
+    {
+      for (int i = 0; i < n; ++i)
+      {
+        if (i % 7 == 0)
+        {
+          int batch[3] = { p * n + i, p * n + i + 1, p * n + i + 2 };
+          int const m = (std::min)(3, n - i);
+          // what did not fit is pushed waiting
+          for (int k = int(ch.try_push_n(batch, m)); k < m; ++k)
+            ch.push(batch[k]);
+          i += m - 1;
+        }
+        else
+          ch.push(p * n + i);
+      }
+    }));
+
+  std::vector<long> sums(consumers, 0);
+  std::vector<int> counts(consumers, 0);
+  std::vector<std::thread> readers;
+  for (int c = 0; c < consumers; ++c)
+    readers.push_back(std::thread([&ch, &sums, &counts, c]
+    {
+      std::vector<mpmc::value_type> batch;
+      mpmc::value_type x;
+      for (;;)
+      {
+        if (c == 0)
+        {
+          batch.clear();
+          std::size_t const k = ch.try_pop_n(std::back_inserter(batch), 4);
+          for (std::size_t i = 0; i < k; ++i)
+          {
+            sums[c] += *batch[i];
+            ++counts[c];
+          }
+          if (k != 0)
+            continue;
+        }
+        if (ch.pop(x) != channel_op_status::success)
+          break;
+        sums[c] += *x;
+        ++counts[c];
+      }
+    }));
+
+  for (std::size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+  BOOST_CHECK(ch.push(make_unexpected(std::string("done"))) == channel_op_status::success);
+  for (std::size_t i = 0; i < readers.size(); ++i)
+    readers[i].join();
+
+  long sum = 0;
+  int count = 0;
+  for (int c = 0; c < consumers; ++c)
+  {
+    sum += sums[c];
+    count += counts[c];
+  }
+  long const total = long(producers) * n;
+  BOOST_CHECK_EQUAL(count, total);
+  BOOST_CHECK_EQUAL(sum, total * (total - 1) / 2);
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,113 @@
+//! \file test_expected_future.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - expected_future"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/expected_future.hpp>
+#include <boost/expected/conversions/expected_to_future.hpp>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(ExpectedFuture)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedFuture_Ready)
+{
+  expected_future<int, std::string> f = make_ready_expected_future(expected<int, std::string>(3));
+
+  BOOST_CHECK(f.valid());
+  BOOST_CHECK(f.is_ready());
+  expected<int, std::string> r = f.get();
+  BOOST_REQUIRE(r.valid());
+  BOOST_CHECK_EQUAL(*r, 3);
+  BOOST_CHECK(! f.valid());
+  BOOST_CHECK_THROW(f.get(), std::future_error);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedFuture_ReadyError)
+{
+  expected_future<int, std::string> f =
+      make_ready_expected_future(expected<int, std::string>(make_unexpected(std::string("e"))));
+  expected_future<int, std::string> g(std::move(f));
+
+  BOOST_CHECK(! f.valid());
+  expected<int, std::string> r = g.get();
+  BOOST_REQUIRE(! r.valid());
+  BOOST_CHECK_EQUAL(r.error(), "e");
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedPromise_SetFromOtherThread)
+{
+  expected_promise<std::unique_ptr<int>, std::string> p;
+  expected_future<std::unique_ptr<int>, std::string> f = p.get_future();
+  BOOST_CHECK(! f.is_ready());
+
+  std::thread t([&p] { p.set_value(new int(5)); });
+  expected<std::unique_ptr<int>, std::string> r = f.get();
+  t.join();
+
+  BOOST_REQUIRE(r.valid());
+  BOOST_CHECK_EQUAL(**r, 5);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedPromise_Errors)
+{
+  expected_promise<int, std::string> p;
+  expected_future<int, std::string> f = p.get_future();
+  BOOST_CHECK_THROW(p.get_future(), std::future_error);
+
+  p.set_error("failed");
+  BOOST_CHECK_THROW(p.set_value(1), std::future_error);
+  expected<int, std::string> r = f.get();
+  BOOST_REQUIRE(! r.valid());
+  BOOST_CHECK_EQUAL(r.error(), "failed");
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedPromise_Broken)
+{
+  expected_future<int, std::string> f;
+  {
+    expected_promise<int, std::string> p;
+    f = p.get_future();
+  }
+  BOOST_CHECK(f.is_ready());
+  BOOST_CHECK_THROW(f.get(), std::future_error);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedPromise_Void)
+{
+  expected_promise<void, std::string> p;
+  expected_future<void, std::string> f = p.get_future();
+  p.set_value();
+  BOOST_CHECK(f.get().valid());
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(MakeReadyFuture_FromExpected)
+{
+  std::future<int> f = make_ready_future(expected<int>(4));
+  BOOST_CHECK_EQUAL(f.get(), 4);
+
+  std::future<int> g = make_ready_future(expected<int>(
+      make_unexpected(std::make_exception_ptr(std::runtime_error("e")))));
+  BOOST_CHECK_THROW(g.get(), std::runtime_error);
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
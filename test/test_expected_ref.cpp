@@ -0,0 +1,197 @@
+//! \file test_expected_ref.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - expected of reference"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected_monad.hpp>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+
+namespace
+{
+  // A large entry which counts its copies.
+  struct config
+  {
+    static int copies;
+    std::string name;
+    int port;
+    char padding[256];
+
+    config(std::string n, int p) : name(n), port(p), padding() {}
+    config(config const& c) : name(c.name), port(c.port), padding() { ++copies; }
+    std::string const& get_name() const { return name; }
+  };
+  int config::copies = 0;
+
+  struct not_found {};
+  enum class lookup_error { not_found, disabled };
+
+  typedef std::map<std::string, config> table;
+
+  expected<config const&, not_found> find(table const& t, std::string const& key)
+  {
+    table::const_iterator it = t.find(key);
+    if (it == t.end())
+      return make_unexpected(not_found());
+    return it->second;
+  }
+
+  expected<config const&, lookup_error> find_enabled(table const& t, std::string const& key)
+  {
+    table::const_iterator it = t.find(key);
+    if (it == t.end())
+      return make_unexpected(lookup_error::not_found);
+    if (it->second.port == 0)
+      return make_unexpected(lookup_error::disabled);
+    return it->second;
+  }
+
+  table make_table()
+  {
+    table t;
+    t.insert(std::make_pair("db", config("database", 5432)));
+    t.insert(std::make_pair("off", config("disabled", 0)));
+    return t;
+  }
+
+  struct base { int i; };
+  struct derived : base { int j; };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(ExpectedRef)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedRef_Layout)
+{
+  // An empty error is packed into the null pointer.
+  BOOST_CHECK_EQUAL(sizeof(expected<config const&, not_found>), sizeof(config*));
+  BOOST_CHECK_EQUAL(sizeof(expected<config&, lookup_error>), sizeof(expected<config*, lookup_error>));
+  BOOST_CHECK_EQUAL(sizeof(expected<config&>), sizeof(expected<config*>));
+  BOOST_CHECK((is_trivially_relocatable<expected<config&, lookup_error>>::value));
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedRef_LookupDoesNotCopy)
+{
+  table const t = make_table();
+  config::copies = 0;
+
+  expected<config const&, not_found> db = find(t, "db");
+  BOOST_REQUIRE(db.valid());
+  BOOST_CHECK_EQUAL(&*db, &t.find("db")->second);
+  BOOST_CHECK_EQUAL(db->port, 5432);
+  BOOST_CHECK_EQUAL(&db.value(), &t.find("db")->second);
+  BOOST_CHECK(! find(t, "none").valid());
+
+  // Projections into members.
+  expected<std::string const&, not_found> name = db.map(&config::name);
+  BOOST_CHECK_EQUAL(&*name, &t.find("db")->second.name);
+  BOOST_CHECK_EQUAL(&*db.map(&config::get_name), &t.find("db")->second.name);
+  BOOST_CHECK_EQUAL(&*db.map([](config const& c) -> int const& { return c.port; }), &t.find("db")->second.port);
+  BOOST_CHECK_EQUAL(*db.map([](config const& c) { return c.port + 1; }), 5433);
+  BOOST_CHECK(! find(t, "none").map(&config::name).valid());
+
+  BOOST_CHECK_EQUAL(config::copies, 0);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedRef_BindAndErrors)
+{
+  table const t = make_table();
+  config::copies = 0;
+
+  expected<int, lookup_error> port = find_enabled(t, "db").bind(
+      [](config const& c) -> expected<int, lookup_error> { return c.port; });
+  BOOST_CHECK_EQUAL(*port, 5432);
+  BOOST_CHECK(find_enabled(t, "off").error() == lookup_error::disabled);
+  BOOST_CHECK(find_enabled(t, "off").map(&config::port).error() == lookup_error::disabled);
+
+  expected<config const&, lookup_error> off = find_enabled(t, "off");
+  expected<config const&, lookup_error> fallback = off.catch_error(
+      [&t](lookup_error) -> config const& { return t.find("db")->second; });
+  BOOST_CHECK_EQUAL(fallback->port, 5432);
+
+  BOOST_CHECK(off.then([](expected<config const&, lookup_error> e) { return e.valid(); }).value() == false);
+  BOOST_CHECK_EQUAL(config::copies, 0);
+
+  expected<config const&> missing = make_unexpected(std::make_exception_ptr(std::out_of_range("key")));
+  BOOST_CHECK_THROW(missing.value(), std::out_of_range);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedRef_ValueOr)
+{
+  table const t = make_table();
+  config const defaults("defaults", 80);
+  config::copies = 0;
+
+  // An lvalue fallback is referred to.
+  config const& c = find(t, "none").value_or(defaults);
+  BOOST_CHECK_EQUAL(&c, &defaults);
+  config const& d = find(t, "db").value_or(defaults);
+  BOOST_CHECK_EQUAL(&d, &t.find("db")->second);
+  BOOST_CHECK_EQUAL(config::copies, 0);
+
+  // A temporary is copied into the result.
+  BOOST_CHECK_EQUAL(find(t, "none").value_or(config("temporary", 1)).port, 1);
+  int i = 1;
+  expected<int&, not_found> none_ = make_unexpected(not_found());
+  BOOST_CHECK_EQUAL(none_.value_or(2L), 2);
+  BOOST_CHECK_EQUAL(&none_.value_or(i), &i);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedRef_Rebinding)
+{
+  int i = 1, j = 2;
+  expected<int&, lookup_error> e = i;
+  *e = 10;
+  BOOST_CHECK_EQUAL(i, 10);
+
+  // Assignment rebinds, it does not assign through.
+  e = expected<int&, lookup_error>(j);
+  BOOST_CHECK_EQUAL(i, 10);
+  BOOST_CHECK_EQUAL(&*e, &j);
+  e.emplace(i);
+  BOOST_CHECK_EQUAL(&*e, &i);
+
+  expected<int&, lookup_error> err = make_unexpected(lookup_error::not_found);
+  e.swap(err);
+  BOOST_CHECK(! e.valid());
+  BOOST_CHECK_EQUAL(&*err, &i);
+
+  expected<int const&, lookup_error> c = err;
+  BOOST_CHECK_EQUAL(&*c, &i);
+  BOOST_CHECK(c == err.map([](int& r) -> int const& { return r; }));
+  BOOST_CHECK(c == 10);
+  BOOST_CHECK(11 != c);
+
+  derived dv;
+  dv.i = 3;
+  expected<derived&> ed = dv;
+  expected<base const&> eb = ed;
+  BOOST_CHECK_EQUAL(eb->i, 3);
+  BOOST_CHECK_EQUAL(&*eb, static_cast<base*>(&dv));
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedRef_Monad)
+{
+  using namespace boost::functional;
+  int i = 4;
+  expected<int&, lookup_error> e = i;
+  BOOST_CHECK_EQUAL(*functor::map([](int& r) { return r * 2; }, e), 8);
+  BOOST_CHECK_EQUAL(*monad::bind(e, [](int& r) { return expected<long, lookup_error>(r + 1); }), 5);
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
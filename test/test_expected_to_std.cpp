@@ -0,0 +1,197 @@
+//! \file test_expected_to_std.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - conversions to std"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected_monad.hpp>
+#include <boost/expected/conversions/expected_to_optional.hpp>
+#include <boost/expected/conversions/expected_to_std.hpp>
+#include <boost/expected/std_optional_monad.hpp>
+#include <boost/expected/std_variant_monad.hpp>
+#include <boost/expected/std_expected_monad.hpp>
+#include <memory>
+#include <string>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+
+namespace
+{
+  // Counts the copies of its instances.
+  struct payload
+  {
+    static int copies;
+    int value;
+
+    explicit payload(int v) : value(v) {}
+    payload(payload const& p) : value(p.value) { ++copies; }
+    payload(payload&& p) BOOST_NOEXCEPT : value(p.value) {}
+    payload& operator=(payload const& p) { value = p.value; ++copies; return *this; }
+    payload& operator=(payload&& p) BOOST_NOEXCEPT { value = p.value; return *this; }
+  };
+  int payload::copies = 0;
+
+  typedef std::unique_ptr<int> owned;
+
+  int twice(int i) { return 2 * i; }
+  int deref_owned(owned p) { return *p; }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(ExpectedToStd)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedToStd_BoostOptional)
+{
+  optional<int> none_;
+  expected<int> e = make_expected(none_);
+  BOOST_REQUIRE(! e.valid());
+  BOOST_CHECK_THROW(e.value(), conversion_from_nullopt);
+
+  optional<int> one(1);
+  BOOST_CHECK_EQUAL(*make_expected(one), 1);
+  BOOST_CHECK_EQUAL(*make_optional(expected<int, int>(2)), 2);
+  BOOST_CHECK(! make_optional(expected<int, int>(make_unexpected(2))));
+
+  payload::copies = 0;
+  expected<payload> p = make_expected(optional<payload>(payload(3)));
+  optional<payload> q = make_optional(std::move(p));
+  BOOST_CHECK_EQUAL(q->value, 3);
+  BOOST_CHECK_EQUAL(payload::copies, 0);
+}
+#if defined BOOST_EXPECTED_HAS_STD_OPTIONAL
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedToStd_Optional)
+{
+  std::optional<int> none_;
+  expected<int> e = make_expected(none_);
+  BOOST_REQUIRE(! e.valid());
+  BOOST_CHECK_THROW(e.value(), conversion_from_nullopt);
+
+  std::optional<owned> o(owned(new int(4)));
+  expected<owned> eo = make_expected(std::move(o));
+  BOOST_CHECK_EQUAL(**eo, 4);
+  std::optional<owned> back = make_std_optional(std::move(eo));
+  BOOST_CHECK_EQUAL(**back, 4);
+  BOOST_CHECK(! make_std_optional(expected<int, int>(make_unexpected(1))));
+
+  payload::copies = 0;
+  std::optional<payload> p = make_std_optional(make_expected(std::optional<payload>(payload(5))));
+  BOOST_CHECK_EQUAL(p->value, 5);
+  BOOST_CHECK_EQUAL(payload::copies, 0);
+  expected<payload> lvalue = make_expected(p);
+  BOOST_CHECK_EQUAL(lvalue->value, 5);
+  BOOST_CHECK_EQUAL(payload::copies, 1);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedToStd_OptionalMonad)
+{
+  using namespace boost::functional;
+  std::optional<int> two(2), none_;
+  BOOST_CHECK_EQUAL(*functor::map(twice, two), 4);
+  BOOST_CHECK(! functor::map(twice, none_));
+  BOOST_CHECK(! functor::map([](int i, int j) { return i + j; }, two, none_));
+  BOOST_CHECK_EQUAL(*monad::bind(two, [](int i) { return std::optional<long>(i + 1); }), 3);
+  BOOST_CHECK_EQUAL(*monad::make<std_optional_monad>(7), 7);
+
+  // The value is moved out of an rvalue.
+  BOOST_CHECK_EQUAL(*functor::map(deref_owned, std::optional<owned>(owned(new int(6)))), 6);
+}
+#endif
+#if defined BOOST_EXPECTED_HAS_STD_VARIANT
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedToStd_Variant)
+{
+  std::variant<owned, std::string> v(owned(new int(8)));
+  expected<owned, std::string> e = make_expected(std::move(v));
+  BOOST_CHECK_EQUAL(**e, 8);
+  std::variant<owned, std::string> back = make_std_variant(std::move(e));
+  BOOST_CHECK_EQUAL(*std::get<0>(back), 8);
+
+  // int is built from long too: the error stays the error.
+  std::variant<long, int> err(std::in_place_index<1>, 9);
+  expected<long, int> ee = make_expected(err);
+  BOOST_REQUIRE(! ee.valid());
+  BOOST_CHECK_EQUAL(ee.error(), 9);
+  BOOST_CHECK_EQUAL(make_std_variant(ee).index(), 1u);
+
+  payload::copies = 0;
+  std::variant<payload, int> p = make_std_variant(expected<payload, int>(payload(10)));
+  expected<payload, int> ep = make_expected(std::move(p));
+  BOOST_CHECK_EQUAL(ep->value, 10);
+  BOOST_CHECK_EQUAL(payload::copies, 0);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedToStd_VariantMonad)
+{
+  using namespace boost::functional;
+  typedef std::variant<int, long> result;
+  result two(2), error(std::in_place_index<1>, 5L);
+
+  result r = functor::map(twice, two);
+  BOOST_CHECK_EQUAL(std::get<0>(r), 4);
+  result re = functor::map(twice, error);
+  BOOST_REQUIRE_EQUAL(re.index(), 1u);
+  BOOST_CHECK_EQUAL(std::get<1>(re), 5L);
+
+  std::variant<std::string, long> s = monad::bind(two, [](int i) { return std::to_string(i); });
+  BOOST_CHECK_EQUAL(std::get<0>(s), "2");
+  std::variant<std::string, long> se = monad::bind(error, [](int i) { return std::to_string(i); });
+  BOOST_CHECK_EQUAL(std::get<1>(se), 5L);
+
+  result made = monad_error::make_error<result>(3L);
+  BOOST_CHECK_EQUAL(std::get<1>(made), 3L);
+
+  BOOST_CHECK_EQUAL(std::get<0>(functor::map(deref_owned, std::variant<owned, int>(owned(new int(6))))), 6);
+}
+#endif
+#if defined BOOST_EXPECTED_HAS_STD_EXPECTED
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedToStd_Expected)
+{
+  std::expected<owned, int> s(owned(new int(11)));
+  expected<owned, int> e = make_expected(std::move(s));
+  BOOST_CHECK_EQUAL(**e, 11);
+  std::expected<owned, int> back = make_std_expected(std::move(e));
+  BOOST_CHECK_EQUAL(**back, 11);
+
+  std::expected<int, int> err(std::unexpect, 12);
+  BOOST_CHECK_EQUAL(make_expected(err).error(), 12);
+  BOOST_CHECK_EQUAL(make_std_expected(make_expected(err)).error(), 12);
+
+  std::expected<void, int> v;
+  BOOST_CHECK(make_expected(v).valid());
+  BOOST_CHECK(make_std_expected(expected<void, int>(in_place2)).has_value());
+  BOOST_CHECK_EQUAL(make_std_expected(expected<void, int>(make_unexpected(13))).error(), 13);
+
+  payload::copies = 0;
+  expected<payload, int> p = make_expected(std::expected<payload, int>(payload(14)));
+  std::expected<payload, int> sp = make_std_expected(std::move(p));
+  BOOST_CHECK_EQUAL(sp->value, 14);
+  BOOST_CHECK_EQUAL(payload::copies, 0);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(ExpectedToStd_ExpectedMonad)
+{
+  using namespace boost::functional;
+  std::expected<int, long> two(2), error(std::unexpect, 5L);
+  BOOST_CHECK_EQUAL(*functor::map(twice, two), 4);
+  BOOST_CHECK_EQUAL(functor::map(twice, error).error(), 5L);
+  BOOST_CHECK_EQUAL(*monad::bind(two, [](int i) { return std::expected<int, long>(i + 1); }), 3);
+  typedef std::expected<int, long> result;
+  BOOST_CHECK_EQUAL(monad_error::make_error<result>(6L).error(), 6L);
+  BOOST_CHECK_EQUAL(*functor::map(deref_owned, std::expected<owned, int>(owned(new int(6)))), 6);
+}
+#endif
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,161 @@
+//! \file test_lazy_expected.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - lazy expected"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/lazy_expected.hpp>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+
+namespace
+{
+  enum class fetch_error { unavailable };
+
+  typedef expected<std::string, fetch_error> field;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(LazyExpected)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(LazyExpected_RunsOnceOnFirstAccess)
+{
+  int calls = 0;
+  lazy_expected<std::string, fetch_error> l([&calls]() -> field { ++calls; return std::string("name"); });
+  BOOST_CHECK(! l.is_ready());
+  BOOST_CHECK_EQUAL(calls, 0);
+
+  BOOST_CHECK(l.valid());
+  BOOST_CHECK(l.is_ready());
+  BOOST_CHECK_EQUAL(l.value(), "name");
+  BOOST_CHECK_EQUAL(l->size(), 4u);
+  BOOST_CHECK_EQUAL(calls, 1);
+
+  lazy_expected<std::string, fetch_error> copy = l;
+  BOOST_CHECK(copy.is_ready());
+  BOOST_CHECK_EQUAL(*copy, "name");
+  BOOST_CHECK_EQUAL(calls, 1);
+
+  lazy_expected<std::string, fetch_error> known = field(std::string("known"));
+  BOOST_CHECK(known.is_ready());
+  BOOST_CHECK_EQUAL(*known, "known");
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(LazyExpected_Errors)
+{
+  int calls = 0;
+  lazy_expected<std::string, fetch_error> l([&calls]() -> field
+  {
+    ++calls;
+    return make_unexpected(fetch_error::unavailable);
+  });
+  BOOST_CHECK(l.error() == fetch_error::unavailable);
+  BOOST_CHECK(! l.valid());
+  BOOST_CHECK_EQUAL(l.value_or("none"), "none");
+  BOOST_CHECK_EQUAL(calls, 1);
+
+  // A function which throws is called again on the next access.
+  int attempts = 0;
+  auto flaky = make_lazy_expected([&attempts]() -> int
+  {
+    if (++attempts == 1)
+      throw std::runtime_error("first");
+    return 3;
+  });
+  BOOST_CHECK_THROW(flaky.valid(), std::runtime_error);
+  BOOST_CHECK(! flaky.is_ready());
+  BOOST_CHECK_EQUAL(*flaky, 3);
+  BOOST_CHECK_EQUAL(attempts, 2);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(LazyExpected_ComposesWithoutRunning)
+{
+  int calls = 0, mapped = 0, bound = 0;
+  auto l = make_lazy_expected([&calls]() -> field { ++calls; return std::string("abc"); })
+      .map([&mapped](std::string s) { ++mapped; return s.size(); })
+      .bind([&bound](std::size_t n) -> expected<int, fetch_error> { ++bound; return int(n) * 2; });
+  BOOST_CHECK((std::is_same<decltype(l)::expected_type, expected<int, fetch_error> >::value));
+  BOOST_CHECK_EQUAL(calls + mapped + bound, 0);
+
+  BOOST_CHECK_EQUAL(*l, 6);
+  BOOST_CHECK_EQUAL(l.value(), 6);
+  BOOST_CHECK_EQUAL(calls, 1);
+  BOOST_CHECK_EQUAL(mapped, 1);
+  BOOST_CHECK_EQUAL(bound, 1);
+
+  // An error goes through without calling the functions.
+  auto e = make_lazy_expected([]() -> field { return make_unexpected(fetch_error::unavailable); })
+      .map([&mapped](std::string s) { ++mapped; return s.size(); });
+  BOOST_CHECK(e.error() == fetch_error::unavailable);
+  BOOST_CHECK_EQUAL(mapped, 1);
+
+  // A lazy_expected which is never accessed never runs.
+  {
+    auto unused = make_lazy_expected([&calls]() -> field { ++calls; return std::string(); })
+        .map([](std::string s) { return s; });
+  }
+  BOOST_CHECK_EQUAL(calls, 1);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(LazyExpected_TypeErasure)
+{
+  int calls = 0;
+  std::vector<lazy_expected<std::size_t, fetch_error> > fields;
+  fields.push_back(make_lazy_expected([&calls]() -> field { ++calls; return std::string("ab"); })
+      .map([](std::string s) { return s.size(); }));
+  fields.push_back(expected<std::size_t, fetch_error>(7u));
+  fields.push_back(make_lazy_expected([&calls]() -> expected<std::size_t, fetch_error> { ++calls; return 5u; }));
+  BOOST_CHECK_EQUAL(calls, 0);
+
+  BOOST_CHECK_EQUAL(*fields[0], 2u);
+  BOOST_CHECK_EQUAL(*fields[1], 7u);
+  BOOST_CHECK_EQUAL(calls, 1);
+
+  fields[0] = fields[2];
+  BOOST_CHECK(! fields[0].is_ready());
+  BOOST_CHECK_EQUAL(*fields[0], 5u);
+  BOOST_CHECK_EQUAL(calls, 2);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(LazyExpected_Concurrent)
+{
+  std::atomic<int> calls(0);
+  concurrent_lazy_expected<long, fetch_error> l([&calls]() -> expected<long, fetch_error>
+  {
+    ++calls;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return 42L;
+  });
+  BOOST_CHECK(! l.is_ready());
+
+  std::vector<std::thread> threads;
+  std::atomic<long> sum(0);
+  for (int i = 0; i < 8; ++i)
+    threads.push_back(std::thread([&l, &sum] { sum += l.value(); }));
+  for (std::size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+
+  BOOST_CHECK_EQUAL(calls.load(), 1);
+  BOOST_CHECK_EQUAL(sum.load(), 8 * 42L);
+  BOOST_CHECK(l.is_ready());
+  BOOST_CHECK(l.valid());
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
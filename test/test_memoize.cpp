@@ -0,0 +1,235 @@
+//! \file test_memoize.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - memoize"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/memoize.hpp>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+
+namespace
+{
+  // A clock moved by hand.
+  struct manual_clock
+  {
+    typedef std::chrono::nanoseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<manual_clock> time_point;
+    static const bool is_steady = true;
+
+    static time_point now() { return time_point(duration(ticks)); }
+    static void advance(duration d) { ticks += d.count(); }
+
+    static rep ticks;
+  };
+  manual_clock::rep manual_clock::ticks = 0;
+
+  typedef expected<int, std::error_code> result;
+  typedef memoize<int, result, std::hash<int>, std::equal_to<int>, manual_clock> cache;
+
+  // Negative keys fail.
+  result lookup(int k)
+  {
+    if (k < 0)
+      return make_unexpected(std::make_error_code(std::errc::invalid_argument));
+    return k * 2;
+  }
+
+  memoize_options options(std::size_t values, std::size_t errors)
+  {
+    memoize_options o;
+    o.value_capacity = values;
+    o.error_capacity = errors;
+    o.value_ttl = std::chrono::seconds(10);
+    o.error_ttl = std::chrono::seconds(1);
+    o.shards = 1;
+    return o;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(Memoize)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Memoize_HitsAndMisses)
+{
+  int calls = 0;
+  cache c([&calls](int k) { ++calls; return lookup(k); }, options(8, 8));
+
+  BOOST_CHECK_EQUAL(*c(1), 2);
+  BOOST_CHECK_EQUAL(*c(1), 2);
+  BOOST_CHECK(c(-1).error() == std::errc::invalid_argument);
+  BOOST_CHECK(c(-1).error() == std::errc::invalid_argument);
+  BOOST_CHECK_EQUAL(calls, 2);
+
+  memoize_stats s = c.stats();
+  BOOST_CHECK_EQUAL(s.value_misses, 1u);
+  BOOST_CHECK_EQUAL(s.value_hits, 1u);
+  BOOST_CHECK_EQUAL(s.error_misses, 1u);
+  BOOST_CHECK_EQUAL(s.error_hits, 1u);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Memoize_SeparateTtls)
+{
+  int calls = 0;
+  cache c([&calls](int k) { ++calls; return lookup(k); }, options(8, 8));
+  c(1);
+  c(-1);
+  manual_clock::advance(std::chrono::seconds(2));
+  c(1);
+  c(-1);
+  BOOST_CHECK_EQUAL(calls, 3);
+  BOOST_CHECK_EQUAL(c.stats().expirations, 1u);
+
+  manual_clock::advance(std::chrono::seconds(10));
+  c(1);
+  BOOST_CHECK_EQUAL(calls, 4);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Memoize_SeparateCapacities)
+{
+  int calls = 0;
+  cache c([&calls](int k) { ++calls; return lookup(k); }, options(4, 0));
+
+  // errors are not cached, and do not evict values
+  for (int k = 0; k < 4; ++k)
+    c(k);
+  for (int k = 1; k <= 10; ++k)
+    c(-k);
+  calls = 0;
+  for (int k = 0; k < 4; ++k)
+    c(k);
+  c(-1);
+  BOOST_CHECK_EQUAL(calls, 1);
+  BOOST_CHECK_EQUAL(c.stats().evictions, 0u);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Memoize_ClockEviction)
+{
+  int calls = 0;
+  cache c([&calls](int k) { ++calls; return lookup(k); }, options(4, 4));
+  for (int k = 0; k < 4; ++k)
+    c(k);
+  // 0 and 1 are referenced again; 2 is the first without second chance
+  c(0);
+  c(1);
+  c(4);
+  BOOST_CHECK_EQUAL(c.stats().evictions, 1u);
+  calls = 0;
+  c(0);
+  c(1);
+  c(3);
+  c(4);
+  BOOST_CHECK_EQUAL(calls, 0);
+  c(2);
+  BOOST_CHECK_EQUAL(calls, 1);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Memoize_Invalidate)
+{
+  int calls = 0;
+  cache c([&calls](int k) { ++calls; return lookup(k); }, options(4, 4));
+  c(1);
+  c.invalidate(1);
+  c.invalidate(2);
+  c(1);
+  BOOST_CHECK_EQUAL(calls, 2);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Memoize_ThrowIsNotCached)
+{
+  int calls = 0;
+  memoize<int, expected<int> > c([&calls](int k) -> expected<int>
+  {
+    if (++calls == 1)
+      throw std::runtime_error("down");
+    return k;
+  });
+  BOOST_CHECK_THROW(c(1), std::runtime_error);
+  BOOST_CHECK_EQUAL(*c(1), 1);
+  BOOST_CHECK_EQUAL(*c(1), 1);
+  BOOST_CHECK_EQUAL(calls, 2);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Memoize_SingleFlight)
+{
+  std::atomic<int> calls(0);
+  std::atomic<bool> release(false);
+  memoize_options o;
+  o.error_capacity = 0;
+  memoize<int, result> c([&](int k)
+  {
+    ++calls;
+    while (! release.load())
+      std::this_thread::yield();
+    return lookup(k);
+  }, o);
+
+  // the outcome is not cached, waiters still get it from the one call
+  std::vector<std::thread> threads;
+  std::atomic<int> wrong(0);
+  for (int i = 0; i < 8; ++i)
+    threads.push_back(std::thread([&]
+    {
+      if (c(-3).error() != std::errc::invalid_argument)
+        ++wrong;
+    }));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  release = true;
+  for (std::size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+  BOOST_CHECK_EQUAL(wrong.load(), 0);
+
+  // the threads that were not scheduled in time called again
+  memoize_stats s = c.stats();
+  BOOST_CHECK_EQUAL(std::size_t(calls.load()), s.error_misses);
+  BOOST_CHECK_EQUAL(s.error_misses + s.coalesced, 8u);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Memoize_Concurrent)
+{
+  memoize_options o;
+  o.value_capacity = 64;
+  o.error_capacity = 16;
+  o.shards = 4;
+  memoize<int, result> c(lookup, o);
+  std::vector<std::thread> threads;
+  std::atomic<int> wrong(0);
+  for (int t = 0; t < 4; ++t)
+    threads.push_back(std::thread([&c, &wrong, t]
+    {
+      for (int i = 0; i < 20000; ++i)
+      {
+        int const k = (i * 7 + t) % 300 - 50;
+        result r = c(k);
+        if (k < 0 ? r.valid() : *r != k * 2)
+          ++wrong;
+      }
+    }));
+  for (std::size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+  BOOST_CHECK_EQUAL(wrong.load(), 0);
+  memoize_stats s = c.stats();
+  BOOST_CHECK_EQUAL(s.value_hits + s.error_hits + s.value_misses + s.error_misses + s.coalesced, 80000u);
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
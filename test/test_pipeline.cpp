@@ -0,0 +1,140 @@
+//! \file test_pipeline.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - pipeline"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/pipeline.hpp>
+#include <memory>
+#include <string>
+#include <system_error>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+
+namespace
+{
+  typedef expected<int, std::error_code> result;
+
+  int calls = 0;
+
+  int add_one(int i) { ++calls; return i + 1; }
+  std::string show(int i) { ++calls; return std::to_string(i); }
+
+  result positive(int i)
+  {
+    ++calls;
+    if (i <= 0)
+      return make_unexpected(std::make_error_code(std::errc::invalid_argument));
+    return i;
+  }
+
+  std::error_code invalid()
+  {
+    return std::make_error_code(std::errc::invalid_argument);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(Pipeline)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Pipeline_Map)
+{
+  result e = 1;
+  expected<std::string, std::error_code> r = e | fmap(add_one) | fmap(add_one) | fmap(show);
+  BOOST_REQUIRE(r.valid());
+  BOOST_CHECK_EQUAL(*r, "3");
+
+  result u = make_unexpected(invalid());
+  calls = 0;
+  r = u | fmap(add_one) | fmap(show);
+  BOOST_CHECK(r.error() == std::errc::invalid_argument);
+  BOOST_CHECK_EQUAL(calls, 0);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Pipeline_BindShortCircuits)
+{
+  calls = 0;
+  result r = result(-1) | fbind(positive) | fmap(add_one) | fbind(positive);
+  BOOST_CHECK(r.error() == std::errc::invalid_argument);
+  BOOST_CHECK_EQUAL(calls, 1);
+
+  r = result(1) | fbind(positive) | fmap(add_one) | fbind(positive);
+  BOOST_CHECK_EQUAL(*r, 2);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Pipeline_Recover)
+{
+  // to a value
+  result r = result(0) | fbind(positive) | fmap(add_one) | recover([](std::error_code) { return 42; })
+      | fmap(add_one);
+  BOOST_CHECK_EQUAL(*r, 43);
+
+  // to an expected
+  r = result(0) | fbind(positive) | recover([](std::error_code) -> result { return 7; });
+  BOOST_CHECK_EQUAL(*r, 7);
+  r = result(0) | fbind(positive) | recover([](std::error_code) -> result
+  {
+    return make_unexpected(std::make_error_code(std::errc::timed_out));
+  });
+  BOOST_CHECK(r.error() == std::errc::timed_out);
+
+  // to another error
+  r = result(0) | fbind(positive) | recover([](std::error_code)
+  {
+    return make_unexpected(std::make_error_code(std::errc::timed_out));
+  }) | fmap(add_one);
+  BOOST_CHECK(r.error() == std::errc::timed_out);
+
+  // values go through
+  calls = 0;
+  r = result(5) | recover([](std::error_code) { return 0; });
+  BOOST_CHECK_EQUAL(*r, 5);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Pipeline_SameAsMethods)
+{
+  for (int i = -2; i < 3; ++i)
+  {
+    result e = i;
+    result a = e.bind(positive).map(add_one).catch_error([](std::error_code) { return 0; });
+    result b = e | fbind(positive) | fmap(add_one) | recover([](std::error_code) { return 0; });
+    BOOST_CHECK(a.valid() == b.valid());
+    BOOST_CHECK_EQUAL(*a, *b);
+  }
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Pipeline_Composed)
+{
+  auto p = fbind(positive) | fmap(add_one) | fmap(show);
+  expected<std::string, std::error_code> r = p(result(9));
+  BOOST_CHECK_EQUAL(*r, "10");
+  r = result(0) | p;
+  BOOST_CHECK(! r.valid());
+  result const c = 4;
+  r = c | p;
+  BOOST_CHECK_EQUAL(*r, "5");
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Pipeline_MoveOnly)
+{
+  typedef expected<std::unique_ptr<int>, std::error_code> ptr;
+  ptr e = std::unique_ptr<int>(new int(1));
+  expected<int, std::error_code> r = std::move(e)
+      | fmap([](std::unique_ptr<int> p) { ++*p; return p; })
+      | fmap([](std::unique_ptr<int> p) { return *p; });
+  BOOST_CHECK_EQUAL(*r, 2);
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
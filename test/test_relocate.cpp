@@ -0,0 +1,95 @@
+//! \file test_relocate.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - relocation"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/trivially_relocatable.hpp>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+
+namespace
+{
+  // Keeps a pointer to itself, so it can not be relocated as bytes.
+  struct self_ref
+  {
+    self_ref* self;
+    int value;
+    self_ref() : self(this), value(0) {}
+    explicit self_ref(int v) : self(this), value(v) {}
+    self_ref(self_ref&& x) BOOST_NOEXCEPT : self(this), value(x.value) {}
+    ~self_ref() {}
+    bool ok() const { return self == this; }
+  };
+
+  template <class T>
+  struct raw_storage
+  {
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type data[4];
+    T* get() { return reinterpret_cast<T*>(data); }
+  };
+}
+
+static_assert(is_trivially_relocatable<int>::value, "");
+static_assert(is_trivially_relocatable<std::unique_ptr<int>>::value, "");
+static_assert(is_trivially_relocatable<std::exception_ptr>::value, "");
+static_assert(is_trivially_relocatable<expected<int, int>>::value, "");
+static_assert(is_trivially_relocatable<expected<std::unique_ptr<int>, std::exception_ptr>>::value, "");
+static_assert(is_trivially_relocatable<expected<void, std::exception_ptr>>::value, "");
+static_assert(! is_trivially_relocatable<self_ref>::value, "");
+static_assert(! is_trivially_relocatable<expected<self_ref, int>>::value, "");
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(Relocate)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Relocate_TriviallyRelocatable)
+{
+  typedef expected<std::unique_ptr<int>, std::exception_ptr> E;
+  raw_storage<E> from, to;
+  ::new (from.get() + 0) E(std::unique_ptr<int>(new int(1)));
+  ::new (from.get() + 1) E(make_unexpected(std::make_exception_ptr(std::runtime_error("e"))));
+
+  E* end = uninitialized_relocate(from.get(), from.get() + 2, to.get());
+
+  BOOST_CHECK(end == to.get() + 2);
+  BOOST_REQUIRE(to.get()[0].valid());
+  BOOST_CHECK_EQUAL(**to.get()[0], 1);
+  BOOST_CHECK(! to.get()[1].valid());
+  BOOST_CHECK_THROW(to.get()[1].value(), std::runtime_error);
+  to.get()[0].~E();
+  to.get()[1].~E();
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Relocate_MovesOtherTypes)
+{
+  typedef expected<self_ref, int> E;
+  raw_storage<E> from, to;
+  ::new (from.get()) E(self_ref(7));
+
+  E* r = relocate_at(from.get(), to.get());
+
+  BOOST_CHECK(r == to.get());
+  BOOST_REQUIRE(r->valid());
+  BOOST_CHECK(r->value().ok());
+  BOOST_CHECK_EQUAL(r->value().value, 7);
+  r->~E();
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,176 @@
+//! \file test_task_group.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - task_group"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/task_group.hpp>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(TaskGroup)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(TaskGroup_Values)
+{
+  work_stealing_pool pool(2);
+  task_group<int> g(pool, 100);
+  for (int i = 0; i < 100; ++i)
+    BOOST_CHECK_EQUAL(g.spawn([i] { return i * i; }), std::size_t(i));
+  expected<std::vector<int>, aggregate_error<std::exception_ptr> > r = g.join();
+  BOOST_REQUIRE(r.valid());
+  BOOST_REQUIRE_EQUAL(r->size(), 100u);
+  for (int i = 0; i < 100; ++i)
+    BOOST_CHECK_EQUAL((*r)[i], i * i);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(TaskGroup_Empty)
+{
+  work_stealing_pool pool(1);
+  task_group<int> g(pool, 0);
+  BOOST_CHECK_THROW(g.spawn([] { return 1; }), std::length_error);
+  BOOST_CHECK(g.join()->empty());
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(TaskGroup_ExpectedChildren)
+{
+  work_stealing_pool pool(2);
+  task_group<std::string, std::error_code> g(pool, 3);
+  g.spawn([]() -> expected<std::string, std::error_code> { return std::string("a"); });
+  g.spawn([]() -> expected<std::string, std::error_code>
+  {
+    return make_unexpected(std::make_error_code(std::errc::timed_out));
+  });
+  g.spawn([]() -> expected<std::string, std::error_code>
+  {
+    return make_unexpected(std::make_error_code(std::errc::invalid_argument));
+  });
+  expected<std::vector<std::string>, aggregate_error<std::error_code> > r = g.join();
+  BOOST_REQUIRE(! r.valid());
+  aggregate_error<std::error_code> const& e = r.error();
+  // the second error may have been skipped by the cancellation
+  BOOST_REQUIRE_EQUAL(e.size() + e.cancelled(), 2u);
+  BOOST_CHECK_EQUAL(e.errors()[0].index, e.size() == 2 ? 1u : e.errors()[0].index);
+  if (e.size() == 2)
+  {
+    BOOST_CHECK(e.errors()[0].error == std::errc::timed_out);
+    BOOST_CHECK(e.errors()[1].error == std::errc::invalid_argument);
+  }
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(TaskGroup_Exception)
+{
+  work_stealing_pool pool(1);
+  task_group<int> g(pool, 2);
+  g.spawn([]() -> int { throw std::runtime_error("child"); });
+  expected<std::vector<int>, aggregate_error<std::exception_ptr> > r = g.join();
+  BOOST_REQUIRE(! r.valid());
+  BOOST_REQUIRE_EQUAL(r.error().size(), 1u);
+  BOOST_CHECK_THROW(std::rethrow_exception(r.error().errors()[0].error), std::runtime_error);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(TaskGroup_FirstFailureCancels)
+{
+  work_stealing_pool pool(1);
+  task_group<int> g(pool, 101);
+  std::atomic<int> ran(0);
+  // the only worker runs the failing child first, then skips the others
+  std::atomic<bool> go(false);
+  pool.execute([&go] { while (! go) std::this_thread::yield(); });
+  g.spawn([]() -> int { throw std::runtime_error("first"); });
+  for (int i = 0; i < 100; ++i)
+    g.spawn([&ran] { return ++ran; });
+  go = true;
+  expected<std::vector<int>, aggregate_error<std::exception_ptr> > r = g.join();
+  BOOST_REQUIRE(! r.valid());
+  BOOST_CHECK_EQUAL(r.error().size(), 1u);
+  BOOST_CHECK_EQUAL(r.error().cancelled(), 100u);
+  BOOST_CHECK_EQUAL(ran.load(), 0);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(TaskGroup_RunningChildSeesToken)
+{
+  work_stealing_pool pool(2);
+  task_group<int, std::error_code> g(pool, 2);
+  g.spawn([](cancellation_token const& t) -> expected<int, std::error_code>
+  {
+    while (! t.is_cancellation_requested())
+      std::this_thread::yield();
+    return make_unexpected_cancelled<std::error_code>();
+  });
+  g.spawn([]() -> expected<int, std::error_code>
+  {
+    return make_unexpected(std::make_error_code(std::errc::timed_out));
+  });
+  expected<std::vector<int>, aggregate_error<std::error_code> > r = g.join();
+  BOOST_REQUIRE(! r.valid());
+  BOOST_REQUIRE_EQUAL(r.error().size(), 2u);
+  BOOST_CHECK(r.error().errors()[0].error == std::errc::operation_canceled);
+  BOOST_CHECK(r.error().errors()[1].error == std::errc::timed_out);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(TaskGroup_Cancel)
+{
+  work_stealing_pool pool(1);
+  std::atomic<bool> go(false);
+  pool.execute([&go] { while (! go) std::this_thread::yield(); });
+  task_group<int> g(pool, 10);
+  for (int i = 0; i < 10; ++i)
+    g.spawn([i] { return i; });
+  g.cancel();
+  go = true;
+  expected<std::vector<int>, aggregate_error<std::exception_ptr> > r = g.join();
+  BOOST_REQUIRE(! r.valid());
+  BOOST_CHECK_EQUAL(r.error().size(), 0u);
+  BOOST_CHECK_EQUAL(r.error().cancelled(), 10u);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(TaskGroup_NestedOnOneWorker)
+{
+  // a child joining its own group helps instead of blocking the worker
+  work_stealing_pool pool(1);
+  task_group<int> outer(pool, 4);
+  for (int i = 0; i < 4; ++i)
+    outer.spawn([&pool, i]
+    {
+      task_group<int> inner(pool, 4);
+      for (int j = 0; j < 4; ++j)
+        inner.spawn([i, j] { return i * 4 + j; });
+      std::vector<int> v = inner.join().value();
+      return v[0] + v[1] + v[2] + v[3];
+    });
+  std::vector<int> v = outer.join().value();
+  BOOST_CHECK_EQUAL(v[0] + v[1] + v[2] + v[3], 120);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(TaskGroup_DestroyedUnjoined)
+{
+  std::shared_ptr<int> counted = std::make_shared<int>(0);
+  {
+    work_stealing_pool pool(2);
+    task_group<std::shared_ptr<int> > g(pool, 8);
+    for (int i = 0; i < 8; ++i)
+      g.spawn([counted] { return counted; });
+  }
+  BOOST_CHECK_EQUAL(counted.use_count(), 1);
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////
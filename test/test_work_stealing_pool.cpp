@@ -0,0 +1,248 @@
+//! \file test_work_stealing_pool.cpp
+
+// Copyright Vicente J. Botet Escriba 2015.
+
+// Use, modification and distribution are subject to the
+// Boost Software License, Version 1.0.
+//(See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "Expected Test Suite - work_stealing_pool"
+#define BOOST_LIB_DIAGNOSTIC "on"// Show library file details.
+#define BOOST_RESULT_OF_USE_DECLTYPE
+
+#include <boost/expected/expected.hpp>
+#include <boost/expected/work_stealing_pool.hpp>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <boost/test/unit_test.hpp> // Enhanced for unit_test framework autolink
+#include <boost/test/included/unit_test.hpp>
+
+using namespace boost;
+
+namespace
+{
+  long tree(work_stealing_pool& pool, int depth)
+  {
+    if (depth == 0)
+      return 1;
+    task_handle<long> left = pool.submit([&pool, depth] { return tree(pool, depth - 1); });
+    long const right = tree(pool, depth - 1);
+    return *left.get() + right;
+  }
+
+  // an error type error_traits can make from an exception
+  struct failure
+  {
+    failure() {}
+    failure(char const* m) : message(m) {}
+    failure(std::exception const& e) : message(e.what()) {}
+    std::string message;
+  };
+
+  std::string what(std::exception_ptr const& e)
+  {
+    try
+    {
+      std::rethrow_exception(e);
+    }
+    catch (std::exception const& ex)
+    {
+      return ex.what();
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_SUITE(WorkStealingPool)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Pool_Submit)
+{
+  work_stealing_pool pool(2);
+  BOOST_CHECK_EQUAL(pool.size(), 2u);
+
+  task_handle<int> h = pool.submit([] { return 6 * 7; });
+  BOOST_CHECK(h.valid());
+  expected<int> r = h.get();
+  BOOST_REQUIRE(r.valid());
+  BOOST_CHECK_EQUAL(*r, 42);
+  BOOST_CHECK(! h.valid());
+  BOOST_CHECK_THROW(h.get(), std::future_error);
+
+  task_handle<void> v = pool.submit([] {});
+  BOOST_CHECK(v.get().valid());
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Pool_ExceptionsBecomeErrors)
+{
+  work_stealing_pool pool(2);
+  task_handle<int> h = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+  expected<int> r = h.get();
+  BOOST_REQUIRE(! r.valid());
+  BOOST_CHECK_EQUAL(what(r.error()), "boom");
+
+  // through error_traits<std::error_code>
+  task_handle<int, std::error_code> c = pool.submit<std::error_code>([]() -> int
+  {
+    throw std::system_error(std::make_error_code(std::errc::invalid_argument));
+  });
+  expected<int, std::error_code> rc = c.get();
+  BOOST_REQUIRE(! rc.valid());
+  BOOST_CHECK(rc.error() == std::make_error_code(std::errc::invalid_argument));
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Pool_ExpectedReturningTask)
+{
+  work_stealing_pool pool(1);
+  task_handle<int, failure> h = pool.submit([]
+  {
+    return expected<int, failure>(make_unexpected(failure("bad")));
+  });
+  BOOST_CHECK_EQUAL(h.get().error().message, "bad");
+
+  task_handle<std::unique_ptr<int>> p = pool.submit([] { return std::unique_ptr<int>(new int(3)); });
+  BOOST_CHECK_EQUAL(**p.get(), 3);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Pool_Execute)
+{
+  std::atomic<int> count(0);
+  {
+    work_stealing_pool pool(3);
+    for (int i = 0; i < 1000; ++i)
+      pool.execute([&count] { count.fetch_add(1); });
+  }
+  // the destructor runs the pending tasks
+  BOOST_CHECK_EQUAL(count.load(), 1000);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Pool_ForkJoinTree)
+{
+  work_stealing_pool pool(4);
+  task_handle<long> h = pool.submit([&pool] { return tree(pool, 14); });
+  BOOST_CHECK_EQUAL(*h.get(), 1L << 14);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Pool_Then)
+{
+  work_stealing_pool pool(2);
+  std::promise<void> go;
+  std::shared_future<void> started = go.get_future().share();
+
+  // attached before the task completes: run by the completing worker
+  task_handle<int> h = pool.submit([started] { started.wait(); return 20; });
+  std::thread::id continued_on;
+  task_handle<int> t = std::move(h).then([&continued_on](expected<int> x)
+  {
+    continued_on = std::this_thread::get_id();
+    return *x + 1;
+  });
+  BOOST_CHECK(! h.valid());
+  go.set_value();
+  BOOST_CHECK_EQUAL(*t.get(), 21);
+  BOOST_CHECK(continued_on != std::this_thread::get_id());
+
+  // attached once ready: run inline
+  task_handle<int> r = pool.submit([] { return 1; });
+  r.wait();
+  task_handle<std::string> s = r.then([](expected<int> x) { return std::to_string(*x); });
+  BOOST_CHECK(s.is_ready());
+  BOOST_CHECK_EQUAL(*s.get(), "1");
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Pool_ThenErrors)
+{
+  work_stealing_pool pool(2);
+  task_handle<int, failure> h = pool.submit([]
+  {
+    return expected<int, failure>(make_unexpected(failure("e")));
+  });
+  bool saw_error = false;
+  task_handle<void, failure> v = h.then([&saw_error](expected<int, failure> x)
+  {
+    saw_error = ! x.valid();
+  });
+  BOOST_CHECK(v.get().valid());
+  BOOST_CHECK(saw_error);
+
+  task_handle<int> t = pool.submit([] { return 1; }).then([](expected<int>) -> int
+  {
+    throw std::runtime_error("in then");
+  });
+  BOOST_CHECK_EQUAL(what(t.get().error()), "in then");
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Pool_WhenAll)
+{
+  work_stealing_pool pool(3);
+  task_handle<std::tuple<int, std::string, double>> all = when_all(
+      pool.submit([] { return 1; }),
+      pool.submit([] { return std::string("two"); }),
+      pool.submit([] { return 3.0; }));
+  expected<std::tuple<int, std::string, double>> r = all.get();
+  BOOST_REQUIRE(r.valid());
+  BOOST_CHECK_EQUAL(std::get<0>(*r), 1);
+  BOOST_CHECK_EQUAL(std::get<1>(*r), "two");
+  BOOST_CHECK_EQUAL(std::get<2>(*r), 3.0);
+
+  // the first error in argument order
+  task_handle<std::tuple<int, int, int>, failure> failed = when_all(
+      pool.submit([] { return expected<int, failure>(1); }),
+      pool.submit([] { return expected<int, failure>(make_unexpected(failure("second"))); }),
+      pool.submit([] { return expected<int, failure>(make_unexpected(failure("third"))); }));
+  BOOST_CHECK_EQUAL(failed.get().error().message, "second");
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Pool_WhenAny)
+{
+  work_stealing_pool pool(3);
+  task_handle<int, failure> any = when_any(
+      pool.submit([] { return expected<int, failure>(make_unexpected(failure("no"))); }),
+      pool.submit([] { return expected<int, failure>(7); }),
+      pool.submit([] { return expected<int, failure>(make_unexpected(failure("no"))); }));
+  expected<int, failure> r = any.get();
+  BOOST_REQUIRE(r.valid());
+  BOOST_CHECK_EQUAL(*r, 7);
+
+  task_handle<int, failure> none = when_any(
+      pool.submit([] { return expected<int, failure>(make_unexpected(failure("a"))); }),
+      pool.submit([] { return expected<int, failure>(make_unexpected(failure("a"))); }));
+  BOOST_CHECK_EQUAL(none.get().error().message, "a");
+
+  task_handle<int> one = when_any(pool.submit([] { return 5; }));
+  BOOST_CHECK_EQUAL(*one.get(), 5);
+}
+////////////////////////////////////////////////////////////////////////////////////////////////////
+BOOST_AUTO_TEST_CASE(Pool_ManyProducers)
+{
+  work_stealing_pool pool(3);
+  std::vector<std::thread> threads;
+  std::atomic<long> sum(0);
+  for (int p = 0; p < 4; ++p)
+    threads.push_back(std::thread([&pool, &sum, p]
+    {
+      std::vector<task_handle<int>> hs;
+      for (int i = 0; i < 500; ++i)
+        hs.push_back(pool.submit([p, i] { return p * 1000 + i; }));
+      for (std::size_t i = 0; i < hs.size(); ++i)
+        sum.fetch_add(*hs[i].get());
+    }));
+  for (std::size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+  long expected_sum = 0;
+  for (int p = 0; p < 4; ++p)
+    for (int i = 0; i < 500; ++i)
+      expected_sum += p * 1000 + i;
+  BOOST_CHECK_EQUAL(sum.load(), expected_sum);
+}
+BOOST_AUTO_TEST_SUITE_END()
+////////////////////////////////////////////////////////////////////////////////////////////////////